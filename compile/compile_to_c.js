@@ -17,7 +17,10 @@ function translate_whole_file (top_level_stmt) {
     (require('./variable_resolver.js'))(functions);
 
     const literals_collection = new (require('./literals.js'));
+    const escape_scanner = require('./escape_scanner.js');
     const volatile_scanner = require('./volatile_scanner.js');
+    const loop_guard_scanner = require('./loop_guard_scanner.js');
+    const generator_scanner = require('./generator_scanner.js');
     const function_writer = require('./function_writer.js');
 
     output.push(`#include "runtime.h"`);
@@ -30,10 +33,14 @@ function translate_whole_file (top_level_stmt) {
     literals_collection.write_initialization(output);
 
     for (var func of functions) {
+        escape_scanner(func);
         if (func.has_try_block)
             volatile_scanner(func);
-        if (func.generator || func.async)
+        loop_guard_scanner(func);
+        if (func.generator || func.async) {
+            generator_scanner(func);
             function_writer.convert_to_coroutine(func);
+        }
         function_writer.write_function(func, output);
     }
 
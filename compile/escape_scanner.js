@@ -0,0 +1,217 @@
+
+// ------------------------------------------------------------
+
+const utils = require('./utils');
+
+// ------------------------------------------------------------
+
+module.exports = function escape_scanner (func) {
+
+    // an object literal which is assigned to a local
+    // variable, where the variable is only ever used to
+    // get or set properties that are declared in the
+    // literal, never escapes the function.  so there is
+    // no need to allocate the object:  we replace each
+    // property with a separate local variable, and each
+    // property access with a reference to such a local.
+    //
+    //      const p = { x: 1, y: 2 };   let p_x = 1, p_y = 2;
+    //      p.x += p.y;                 p_x += p_y;
+    //
+    // any other reference to the variable, e.g. passing
+    // it to a function, calling a method on it, accessing
+    // a property not declared in the literal (which may
+    // be found in the prototype chain), delete, or a
+    // reference from a nested function or in a 'with'
+    // block, means the object escapes, or needs to be a
+    // real object, so we leave it alone.
+    //
+    // see also array_pattern () and object_pattern () in
+    // expression_writer.js, for scalar replacement in a
+    // destructuring assignment from a literal.
+    //
+    // we skip coroutines, which are restructured by
+    // convert_to_coroutine () in function_writer.js
+
+    if (func.generator || func.async)
+        return;
+
+    const candidates = new Map();
+
+    func.visit('VariableDeclaration', stmt => {
+
+        if (stmt.kind === 'var'
+        ||  stmt.parent_node?.type !== 'BlockStatement')
+            return;
+
+        for (const decl of stmt.declarations) {
+
+            if (decl.id?.type !== 'Identifier'
+            ||  decl.init?.type !== 'ObjectExpression'
+            ||  decl.is_closure)
+                continue;
+
+            const keys = get_literal_keys(decl.init);
+            if (keys)
+                candidates.set(decl, { stmt, keys, refs: [] });
+        }
+    });
+
+    if (!candidates.size)
+        return;
+
+    func.visit('Identifier', node => {
+
+        const cand = candidates.get(node.decl_node);
+        if (!cand || node === node.decl_node.id)
+            return;
+
+        const key = get_access_key(node, cand.keys);
+        if (key === undefined
+        ||  node.with_decl_node
+        ||  node.closure_index >= 0
+        ||  utils.is_descendant_of(node, node.decl_node.init))
+            candidates.delete(node.decl_node);
+        else
+            cand.refs.push([ node.parent_node, key ]);
+    });
+
+    for (const [ decl, cand ] of candidates)
+        replace_object(decl, cand);
+}
+
+// ------------------------------------------------------------
+
+function get_literal_keys (expr) {
+
+    // returns a map of property names to Property nodes,
+    // if all properties in the literal are plain values
+    // with a static name, otherwise returns undefined
+
+    const keys = new Map();
+
+    for (const prop of expr.properties) {
+
+        if (prop.type !== 'Property' || prop.kind !== 'init'
+                                     || prop.computed
+                                     || prop.method)
+            return;
+
+        let key;
+        if (prop.key.type === 'Identifier')
+            key = prop.key.name;
+        else if (prop.key.type === 'Literal'
+             &&  typeof(prop.key.value) === 'string')
+            key = prop.key.value;
+
+        // __proto__ in a literal sets the prototype
+        if (key === undefined || key === '__proto__'
+                              || keys.has(key))
+            return;
+
+        keys.set(key, prop);
+    }
+
+    return keys;
+}
+
+// ------------------------------------------------------------
+
+function get_access_key (node, keys) {
+
+    // returns the property name if the identifier is
+    // the object in a plain property access, and the
+    // property is declared in the literal
+
+    const expr = node.parent_node;
+    if (expr.type !== 'MemberExpression' || expr.object !== node
+                                         || expr.optional)
+        return;
+
+    let key;
+    if (!expr.computed)
+        key = expr.property.name;
+    else if (expr.property.type === 'Literal'
+         &&  typeof(expr.property.value) === 'string')
+        key = expr.property.value;
+
+    if (!keys.has(key))
+        return;
+
+    // a method call passes the object as 'this', and
+    // delete would have to modify the object shape
+    const parent_node = expr.parent_node;
+    if ((parent_node.type === 'CallExpression'
+    ||   parent_node.type === 'NewExpression')
+    &&  parent_node.callee === expr)
+        return;
+
+    if (parent_node.type === 'UnaryExpression'
+    &&  parent_node.operator === 'delete')
+        return;
+
+    return key;
+}
+
+// ------------------------------------------------------------
+
+function replace_object (decl, cand) {
+
+    // create a new declarator for each property, in the
+    // same order as in the literal, so side effects occur
+    // in the same order.  note that we keep the original
+    // parent of each value node, which may be required
+    // to name an anonymous function after the property
+
+    const { stmt, keys, refs } = cand;
+    const fields = new Map();
+
+    for (const [ key, prop ] of keys) {
+
+        const unique_id = utils.get_unique_id();
+        const field = {
+            type: 'VariableDeclarator',
+            id: { type: 'Identifier',
+                  name: decl.id.name + '_' + key, unique_id },
+            init: prop.value,
+            parent_node: stmt,
+            kind: 'let',
+            scope: decl.scope,
+            unique_id,
+            loc: prop.loc,
+        };
+        field.id.parent_node = field;
+
+        // the block writes a void reference for each
+        // variable in scope, see block_statement ()
+        decl.scope?.set(decl.id.name + '.' + key, field);
+        fields.set(key, field);
+    }
+
+    // the original variable is never declared in C
+    decl.skip_void_reference = true;
+
+    // a property may be assigned even if the variable
+    // is const, so the declaration can't be const in C,
+    // and may need 'volatile', see volatile_scanner.js
+    // and variable_declaration_simple_decl ()
+    stmt.inhibit_const = true;
+
+    stmt.declarations.splice(
+            stmt.declarations.indexOf(decl), 1, ...fields.values());
+
+    // convert each property access into an identifier
+    // which references the new declaration
+
+    for (const [ expr, key ] of refs) {
+
+        const field = fields.get(key);
+        for (const k of Object.keys(expr)) {
+            if (k !== 'parent_node' && k !== 'loc')
+                delete expr[k];
+        }
+        expr.type = 'Identifier';
+        expr.name = field.id.name;
+        expr.decl_node = field;
+    }
+}
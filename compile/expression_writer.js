@@ -99,13 +99,13 @@ function identifier_expression (expr) {
         return 'this_val';
 
     // a reference to a closure variable that is declared in
-    // an enclosing function.  the 'closures' array contains
-    // pointers to such variables
+    // an enclosing function.  the closure array contains
+    // pointers to the records which hold such variables
 
     if (expr.is_closure) {
 
         const f = expression_writers['ClosureExpression'];
-        return '(*' + f(expr.closure_index, expr) + ')';
+        return '(*' + f(expr) + ')';
     }
 
     // resolve_local_reference () in function_splitter.js
@@ -117,6 +117,7 @@ function identifier_expression (expr) {
         // to the declaring node, where a 'c_name' property
         // specifies the translated variable name in C
 
+        const ref_node = expr;
         expr = expr.decl_node;
 
         if (expr.is_func_node)
@@ -124,6 +125,27 @@ function identifier_expression (expr) {
 
         if (expr.is_closure)
             return '*' + expr.c_name;
+
+        // an 'arguments' object which is created on
+        // first reference, see statement_writer.js.
+        // ask the enclosing statement to create it once,
+        // before the statement, so that a statement with
+        // several references does not repeat the creation
+        // in its expression.  if there is no enclosing
+        // statement, then create it inline.
+        if (expr.lazy_arguments) {
+            const text = `js_lazyargs(${expr.c_name},`
+                                 + `${expr.lazy_arguments})`;
+            for (let node = ref_node.parent_node;
+                     node && !node.is_func_node;
+                     node = node.parent_node) {
+                if (typeof(node.lazy_arguments_text) === 'string') {
+                    node.lazy_arguments_text = text;
+                    return expr.c_name;
+                }
+            }
+            return text;
+        }
     }
 
     // local variables and property names should have 'c_name'
@@ -267,6 +289,17 @@ function assignment_expression (expr) {
 
     function array_pattern (left, right) {
 
+        if (right.type === 'ArrayExpression' && is_void_result()) {
+            const text = array_pattern_literal(left, right);
+            if (text)
+                return text;
+        }
+
+        return array_pattern_iter(left, right);
+    }
+
+    function array_pattern_iter (left, right) {
+
         const iter = 'iter_' + utils.get_unique_id();
         utils_c.insert_init_text(right, `js_val ${iter}[3];`);
         let text = `(js_newiter(env,${iter},'O',`
@@ -306,6 +339,62 @@ function assignment_expression (expr) {
         })(text, left.elements) + ')';
     }
 
+    //
+    // destructuring an array literal, e.g. [a, b] = [b, a],
+    // if the result of the assignment is not used, and the
+    // pattern is simple, then we don't need to allocate an
+    // array and an iterator:  all elements are evaluated
+    // into temp vars, then assigned in order.  an element
+    // without a target is evaluated for its side effects.
+    // this is only possible while the array iterator is
+    // not modified, see js_arr_iter_unmodified () in iter.c,
+    // so we also write the full destructuring, as fallback.
+    // if the pattern is not simple, returns undefined
+    //
+
+    function array_pattern_literal (left, right) {
+
+        const elements = right.elements;
+        if (elements.some(elem => !elem
+                              ||  elem.type === 'SpreadElement')
+        ||  left.elements.some(elem => elem
+                              &&  elem.type !== 'Identifier'
+                              &&  elem.type !== 'MemberExpression'
+                              &&  elem.type !== 'ArrayPattern'
+                              &&  elem.type !== 'ObjectPattern'))
+            return;
+
+        const temps = elements.map((elem, elem_ix) =>
+                        left.elements[elem_ix]
+                        ? utils_c.alloc_temp_value(expr) : undefined);
+
+        let text = elements.map((elem, elem_ix) =>
+                    temps[elem_ix]
+                    ? `${temps[elem_ix]}=` + expression_writer(elem)
+                    : `(void)(${expression_writer(elem)})`).join(',');
+
+        left.elements.forEach((elem, elem_ix) => {
+            if (elem === null) // skip element
+                return;
+            let temp = {
+                type: 'AssignmentExpression', operator: '=',
+                left: elem,
+                right: { type: 'Literal',
+                         c_name: temps[elem_ix] ?? 'js_undefined',
+                         parent_node: expr },
+                parent_node: expr,
+            };
+            if (text.length)
+                text += ',';
+            text += assignment_expression(temp);
+        });
+
+        // array_pattern_iter () also calls
+        // add_c_name_for_void_reference ()
+        return `(js_arr_iter_unmodified(env)?(void)(${text || 0}):`
+             + `(void)${array_pattern_iter(left, right)})`;
+    }
+
     //
     // destructuring using an object pattern
     //
@@ -316,6 +405,12 @@ function assignment_expression (expr) {
         if (!properties.length)
             return '';
 
+        if (right.type === 'ObjectExpression' && is_void_result()) {
+            const text = object_pattern_literal(left, right);
+            if (text)
+                return text;
+        }
+
         let from = utils_c.alloc_temp_value(right);
         let text = `(${from}=`
                  + expression_writer(right, false);
@@ -401,6 +496,94 @@ function assignment_expression (expr) {
         return text + ')';
     }
 
+    //
+    // destructuring an object literal, e.g. the options bag in
+    // const { a, b = 2 } = { a: x, b: y }, where the result is
+    // not used.  if all properties in the literal are plain
+    // values, and the pattern only names properties from the
+    // literal, then the values are evaluated into temp vars,
+    // and assigned without allocating an object.  otherwise,
+    // returns undefined.  see also escape_scanner.js
+    //
+
+    function object_pattern_literal (left, right) {
+
+        const keys = new Map();
+        for (const prop of right.properties) {
+            const key = static_key(prop);
+            if (key === undefined || prop.kind !== 'init'
+                                  || prop.method
+                                  || key === '__proto__'
+                                  || keys.has(key))
+                return;
+            keys.set(key, prop);
+        }
+
+        const used_keys = new Set();
+        for (const prop of left.properties) {
+            if (!keys.has(static_key(prop)))
+                return;
+            used_keys.add(static_key(prop));
+        }
+
+        // a property without a target is evaluated
+        // only for its side effects
+        const temps = new Map();
+        let text = '(';
+        for (const [ key, prop ] of keys) {
+            if (!used_keys.has(key)) {
+                text += `(void)(${expression_writer(prop.value)}),`;
+                continue;
+            }
+            const tmp = utils_c.alloc_temp_value(right);
+            temps.set(key, tmp);
+            text += `${tmp}=${expression_writer(prop.value)},`;
+        }
+
+        for (const prop of left.properties) {
+
+            let value = temps.get(static_key(prop));
+            let left2 = prop.value;
+            if (left2.type === 'AssignmentPattern') {
+                value = `(js_is_undefined(${value})?`
+                      + expression_writer(left2.right, true)
+                      + `:${value})`;
+                left2 = left2.left;
+            }
+
+            let temp = {
+                type: 'AssignmentExpression', operator: '=',
+                left: left2,
+                right: { type: 'Literal', c_name: value },
+                parent_node: expr,
+            };
+            text += assignment_expression(temp) + ',';
+            add_c_name_for_void_reference(left, left2);
+        }
+
+        return text.slice(0, -1) + ')';
+
+        function static_key (prop) {
+            if (prop.type !== 'Property' || prop.computed)
+                return;
+            if (prop.key.type === 'Identifier')
+                return prop.key.name;
+            if (prop.key.type === 'Literal'
+            &&  typeof(prop.key.value) === 'string')
+                return prop.key.value;
+        }
+    }
+
+    //
+    // returns true if the result of the assignment is
+    // discarded, see also variable_declaration_pattern ()
+    //
+
+    function is_void_result () {
+
+        return expr.void_result || expr.parent_node?.void_result;
+    }
+
     //
 
     function add_c_name_for_void_reference (decl_node, var_node) {
@@ -443,9 +626,18 @@ function write_call_arguments (expr) {
 
         if (arg_expr.type === 'SpreadElement') {
 
+            // the spread pushes any number of values, so tell
+            // js_spreadargs () how many more stack links the
+            // arguments which follow it may need, like the
+            // count in write_function () in function_writer.js
+            const rest_args = expr.arguments.slice(
+                            expr.arguments.indexOf(arg_expr) + 1);
+            const room = rest_args.length + 4 + Math.max(0,
+                ...rest_args.map(function_writer.count_max_args));
+
             let spread_text =
                 expression_writer(arg_expr.argument);
-            text += `js_spreadargs(env,${spread_text}),`;
+            text += `js_spreadargs(env,${spread_text},${room}),`;
             continue;
         }
 
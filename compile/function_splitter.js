@@ -20,6 +20,9 @@
 // strict_mode - to compile function in javascript strict mode
 // decl_node   - links to the node which initially contained
 //               the function before it was split off.
+// legacy_arguments - set on non-strict functions, if the
+//               program may read 'arguments' or 'caller'
+//               from a function object, see below.
 //
 // and a utility function:  func_node.visit(filter, callback),
 // with a filter that is a type string or an array of such,
@@ -303,10 +306,61 @@ function visit_helper (filter, callback) {
 
 // ------------------------------------------------------------
 
+function observes_function_arguments (node) {
+
+    // check if the program can observe the legacy properties
+    // 'arguments' and 'caller' on a function object.  if it
+    // cannot, then non-strict functions can skip updating
+    // these properties on every call and every return, see
+    // js_arguments () in stack.c.  we look for any static
+    // property name, or string literal, which is one of the
+    // two names, and treat a 'with' statement as observing.
+    // a property key computed at run time is not detected.
+
+    const is_legacy_name = (name) =>
+                    name === 'arguments' || name === 'caller';
+
+    switch (node.type) {
+
+        case 'WithStatement':
+            return true;
+
+        case 'Literal':
+            return is_legacy_name(node.value);
+
+        case 'MemberExpression':
+            if (!node.computed
+            &&  is_legacy_name(node.property.name))
+                return true;
+            break;
+
+        case 'Property':
+            if (!node.computed && node.key.type === 'Identifier'
+            &&  is_legacy_name(node.key.name))
+                return true;
+            break;
+    }
+
+    return utils.get_child_nodes(node)
+                .some(observes_function_arguments);
+}
+
+// ------------------------------------------------------------
+
 module.exports = function split_into_functions (top_func_node) {
 
+    const legacy_arguments =
+                observes_function_arguments(top_func_node);
+
     const list_of_all_functions = [];
     process_function_tree(top_func_node, list_of_all_functions);
 
+    if (legacy_arguments) {
+        for (const func of list_of_all_functions) {
+            if (!func.strict_mode)
+                func.legacy_arguments = true;
+        }
+    }
+
     return list_of_all_functions;
 }
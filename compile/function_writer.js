@@ -2,6 +2,7 @@
 const write_statements = require('./statement_writer');
 const write_expression = require('./expression_writer');
 const shape_cache = require('./shape_cache');
+const generator_scanner = require('./generator_scanner');
 const utils = require('./utils');
 const utils_c = require('./utils_c');
 
@@ -52,20 +53,35 @@ exports.write_function = function (func, output) {
                     'js_yield(env,js_make_number(0.));');
     }
 
+    // initialize the stack base pointer
+    const max_args_in_calls = count_max_args_in_call_stmt(func);
+    let stk_decl;
+    if (max_args_in_calls >= 0) {
+        // number of stack links needed, plus some spare room
+        const n = max_args_in_calls + 4;
+        stk_decl = `js_ensure_stack_at_least(${n});`
+    }
+
+    // if generator compiled as a state machine, then jump
+    // to the resume point, past the initialization below,
+    // but the stack check is needed on every call
+    const state_machine = func.state_machine;
+    if (state_machine) {
+        if (stk_decl)
+            output.splice(++insert_index, 0, stk_decl);
+        stk_decl = undefined;
+        output.splice(++insert_index, 0,
+            generator_scanner.write_entry_dispatch(state_machine));
+    }
+
     // initialize local references to arguments passed
     if (param_locals.length) {
         while (param_locals.length)
             output.splice(++insert_index, 0, param_locals.shift());
     }
 
-    // initialize the stack base pointer
-    const max_args_in_calls = count_max_args_in_call_stmt(func);
-    if (max_args_in_calls >= 0) {
-        // number of stack links needed, plus some spare room
-        const n = max_args_in_calls + 4;
-        const stk_decl = `js_ensure_stack_at_least(${n});`
+    if (stk_decl)
         output.splice(++insert_index, 0, stk_decl);
-    }
 
     if (!func.strict_mode) {
         // in a non-strict function, a primitive 'this' gets
@@ -74,6 +90,14 @@ exports.write_function = function (func, output) {
                         'this_val=js_boxthis(env,this_val);');
     }
 
+    // if state machine, return to js_generator_init ()
+    // in coroutine.c, with the parameters saved
+    if (state_machine) {
+        output.splice(++insert_index, 0,
+            ...generator_scanner.write_resume_point(
+                            state_machine.entry_point));
+    }
+
     output.pop();   // discard last } in block
 
     // if last statement in function is not 'return',
@@ -116,14 +140,27 @@ function write_param_locals (func_stmt) {
     let stk_ptr = 'stk_' + utils.get_unique_id();
     let c_names = [];
     let output = [];
+
+    // parameters used in closure references share a single
+    // closure record, which is allocated before any of the
+    // parameters, as an initializer may create a closure
+    const closure_record = func_stmt.params.closure_record;
+    if (closure_record) {
+        for (const node of closure_record.vars) {
+            const clean_name = utils_c.clean_name(node);
+            node.c_name = `arg_${clean_name}_${node.unique_id}`;
+        }
+        utils_c.declare_closure_record(closure_record, output);
+    }
+
     for (let node of func_stmt.params) {
 
         // if the parameter is used in a closure reference,
         // or is part of a binding/destructuring assignment,
         // then we collect the argument into a temp local,
         // rather than the actual local for the parameter.
-        // we then allocate a closure variable, and assign
-        // the value from the temp local to the closure var.
+        // we then assign the value from the temp local to
+        // the closure variable, in the record from above.
         let c_name, c_name_var, is_rest_elem, initializer,
             is_identifier, is_identifier_closure;
         if (node.type === 'RestElement') {
@@ -171,10 +208,8 @@ function write_param_locals (func_stmt) {
         }
 
         if (is_identifier_closure) {
-            // allocate a closure variable,
-            // and assign the actual argument value
-            output.push(`js_val *${node.c_name}=`
-                      + `js_newclosure(func_val,&${c_name});`);
+            // assign the actual argument value
+            output.push(`*${node.c_name}=${c_name};`);
         } else if (!is_identifier) {
 
             if (!process_pattern(node, c_name, c_names, output))
@@ -314,6 +349,7 @@ function write_var_locals (func_stmt, block_stmt_list) {
                 init: utils_c.init_expr_undefined,
                 // special case for variable_declaration ()
                 is_closure_var_init: node.is_closure,
+                closure_record: node.closure_record,
             });
         }
     }
@@ -335,6 +371,7 @@ function write_var_locals (func_stmt, block_stmt_list) {
                     id: node.id, unique_id: node.unique_id,
                     init: utils_c.init_expr_undefined,
                     is_closure: node.is_closure,
+                    closure_record: node.closure_record,
                 });
             }
         });
@@ -350,6 +387,8 @@ function write_var_locals (func_stmt, block_stmt_list) {
 
 // ------------------------------------------------------------
 
+exports.count_max_args = count_max_args_in_call_stmt;
+
 function count_max_args_in_call_stmt (func) {
 
     let max_args = -1;
@@ -422,7 +461,7 @@ exports.function_expression = function (expr) {
     if (params_length > 0 && 'RestElement' ===
             decl_node.params[params_length - 1].type)
         params_length--;
-    if (params_length >= 0x40000000) {
+    if (params_length >= 0x20000000) {
         // number of parameters must not interfere with
         // any flag bits that share the 'arity' parameter
         throw [ expr, 'too many parameters' ];
@@ -431,6 +470,11 @@ exports.function_expression = function (expr) {
     let arity = '' + params_length;
     if (decl_node.strict_mode)
         arity = 'js_strict_mode|' + arity;
+    else if (decl_node.legacy_arguments) {
+        // see observes_function_arguments () in
+        // function_splitter.js, and js_arguments2 ()
+        arity = 'js_legacy_arguments|' + arity;
+    }
     if (decl_node.not_constructor) {
         // method/arrow/generator/async functions
         arity = 'js_not_constructor|' + arity;
@@ -442,9 +486,9 @@ exports.function_expression = function (expr) {
         throw [ expr, 'too many shape cache slots' ];
 
     const shapes = `(${(decl_node.shape_cache_count || 0)}<<16)|`;
-    // number of closure slots, and pointers to local variables
+    // number of closure records, and pointers to their values
     const func_node = utils.get_parent_func_node(expr);
-    const closure = do_closures(decl_node.closures, expr, func_node);
+    const closure = do_closures(decl_node.closure_records, expr, func_node);
 
     // use js_newfunc to build the new function object
     let text = `js_newfunc(env,${func_name},${func_descr},${func_where},`
@@ -459,47 +503,45 @@ exports.function_expression = function (expr) {
 
     return text;
 
-    function do_closures (closures, expr_node, func_node) {
-        if (!closures)
+    function do_closures (closure_records, expr_node, func_node) {
+        if (!closure_records)
             return '0';
         const results = [];
-        for (let [decl_node, ref_node] of closures) {
-            results.push((ref_node.closure_func === func_node)
-                ? local_declared_in_this_func(decl_node, expr_node)
-                : import_local_from_outer_func(decl_node, expr_node, func_node));
+        for (const record of closure_records.keys()) {
+            results.push((record.func === func_node)
+                ? local_declared_in_this_func(record)
+                : import_local_from_outer_func(record, expr_node, func_node));
         }
         if (results.length >= 0xFFFF)
             throw [ expr_node, 'too many closure slots' ];
         return '' + results.length + ',' + results.join(',');
     }
 
-    function local_declared_in_this_func (decl_node, expr_node) {
-        // nested function refers to a local declared in this
-        // function;  which would already be a pointer, thanks
-        // to variable_declaration () in statement_writer.js.
-        if (!decl_node.is_func_node)
-            return utils_c.get_variable_c_name(decl_node);
+    function local_declared_in_this_func (record) {
+        // nested function refers to locals declared in this
+        // function, which are in a record allocated by the
+        // block where they are declared, see also
+        // variable_declaration () in statement_writer.js
+        if (!record.is_self)
+            return utils_c.declare_closure_record(record);
         // a special exception when the nested function refers
         // to the internal function name, i.e. the name to the
         // right of the 'function' keyword in this expression:
         //      let var_in_parent_scope = function internal_name ()
-        // in this case, we allocate a closure variable to hold
+        // in this case, we allocate a closure record to hold
         // func_val, because func_val is probably on the stack.
-        return `js_newclosure(func_val,&func_val)`;
+        return `js_newclosure(func_val,1,&func_val)`;
     }
 
-    function import_local_from_outer_func (decl_node, expr_node, func_node) {
+    function import_local_from_outer_func (record, expr_node, func_node) {
         // nested function refers to a variable that is declared
         // in the parent scope.  this would already be taken care
         // of by add_closure_function () in variable_resolver.js,
-        // so we just need to forward the closure references.
-        const passthrough = func_node.closures.get(decl_node);
-        if (passthrough) {
-            // note the special flag to indicate an uninitialized
-            // closure variable is allowed here, see also below,
-            // closure_expression () and js_closureval () in func.c
-            return exports.closure_expression(
-                passthrough.closure_index, expr_node, true);
+        // so we just need to forward the closure record.
+        const passthrough = func_node.closure_records?.get(record);
+        if (passthrough !== undefined) {
+            return '((js_func*)js_get_pointer(func_val))'
+                 + `->closure_array[${passthrough}]`;
         } else
             throw [ expr_node, 'invalid closure reference' ];
     }
@@ -507,33 +549,39 @@ exports.function_expression = function (expr) {
 
 // ------------------------------------------------------------
 
-exports.closure_expression = function (closure_index, node,
-                                       passthrough_mode) {
+exports.closure_expression = function (node) {
 
+    // returns a pointer to a closure variable, which is in one
+    // of the closure records passed to js_newfunc () above, see
+    // assign_closure_records () in variable_resolver.js.
+    //
     // it is possible for a closure variable to be referenced
     // before it was initialized to any value: for example:
     //      (() => { (() => v)(); let v; })()
-    // to support this, func->closure_array has two sets of
-    // closure pointers;  see js_newfunc () in func.c.  also
-    // from func.c, js_closureval () copies a closure pointer
-    // from the second set of pointers to the primary set,
-    // thus "activating" the pointer, if its initial value is
-    // set.  the final part in this process is to allocate
-    // closure variables with a special value that can detect
-    // they have not yet been initialized.  this is done by
-    // by js_newclosure (), see also variable_declaration ()
-    // in statement_writer.js
-
-    let idx = closure_index;
-    let pfx = passthrough_mode ? '~' : '';
+    // js_newclosure () in func.c allocates closure variables
+    // with a special value that can detect this case, which
+    // calls js_closureval () to throw an error.  the check is
+    // skipped if is_initialized_closure () could prove that
+    // the variable is always initialized at this point.
+
+    const decl_node = node.decl_node || node.with_decl_node;
+    const func_node = node.closure_ref_func;
+    const record = decl_node.closure_record;
+    const idx = func_node.closure_records.get(record);
+    if (idx === undefined)
+        throw [ node, 'invalid closure reference' ];
 
     const tmp = `ptr_val_${utils.get_unique_id()}`;
     const fnc = '((js_func*)js_get_pointer(func_val))';
     utils_c.insert_init_text(node, `js_val *${tmp};`);
     node.closure_temp_ptr = tmp;
-    return `(${tmp}=`
-         + `(likely((${tmp}=${fnc}->closure_array[${idx}])!=NULL)`
-         +  `?${tmp}:js_closureval(env,func_val,${pfx}${idx})))`;
+
+    const ptr = `${fnc}->closure_array[${idx}]`
+              + (decl_node.closure_slot ? `+${decl_node.closure_slot}` : '');
+    if (func_node.initialized_closures.has(decl_node))
+        return `(${tmp}=${ptr})`;
+    return `(likely((${tmp}=${ptr})->raw!=js_uninitialized.raw)`
+         + `?${tmp}:js_closureval(env,${tmp}))`;
 }
 
 // ------------------------------------------------------------
@@ -568,7 +616,6 @@ exports.meta_property_expression = function (expr) {
 exports.convert_to_coroutine = function (func) {
 
     func.not_constructor = true;
-    func.inject_call_to_yield = true;
 
     let kind = 0;
     if (func.async)
@@ -576,6 +623,12 @@ exports.convert_to_coroutine = function (func) {
     if (func.generator)
         kind += 2;
 
+    // see generator_scanner.js
+    if (func.state_machine)
+        kind += 4;
+    else
+        func.inject_call_to_yield = true;
+
     utils_c.text_callback(func,
 
         (call_node, decl_node, text) =>
@@ -0,0 +1,306 @@
+
+// ------------------------------------------------------------
+
+const utils = require('./utils');
+const utils_c = require('./utils_c');
+
+// ------------------------------------------------------------
+
+module.exports = function generator_scanner (func) {
+
+    // a generator normally executes in a coroutine, with
+    // a separate stack, see coroutine.c.  but if every
+    // 'yield' is a statement of its own, then we can make
+    // the generator function return at each yield, and
+    // jump back to that point when it is called again.
+    // this works if the yield is not nested in anything
+    // that keeps state in C, so we only permit nesting in
+    // blocks, 'if' statements and simple loops:
+    //
+    //      yield x;
+    //      v = yield x;
+    //      let v = yield x;
+    //
+    // local variables are saved in a frame allocated by
+    // js_genenter () in coroutine.c before each return,
+    // and restored after the jump back.  so we also need
+    // all local variables to be plain C variables, i.e.
+    // not closure variables, nor destructuring patterns.
+    //
+    // try blocks are not permitted anywhere in the
+    // generator, which lets js_generator_resume () handle
+    // return () and throw () without calling into the
+    // generator, as there would be no handler anyway.
+    //
+    // if the conditions are met, we set func.state_machine,
+    // which is checked by convert_to_coroutine () and
+    // write_function () in function_writer.js, and mark
+    // each yield statement with a resume point, which is
+    // handled by statement_writer () in statement_writer.js
+
+    if (!func.generator || func.async)
+        return;
+
+    let eligible = true;
+    func.visit(undefined, node => {
+
+        if (node !== func && !check_node(node))
+            eligible = false;
+    });
+
+    if (!eligible || !check_params(func))
+        return;
+
+    const state_machine = func.state_machine = {
+        frame_var: 'gen_' + utils.get_unique_id(),
+        slots: new Map(),
+        num_points: 1,
+    };
+
+    // the initial resume point, where the generator
+    // returns after processing its parameters
+    const func_vars = func.params.map(node =>
+        (node.type === 'Identifier') ? node
+      : (node.type === 'AssignmentPattern') ? node.left
+      : node.argument);
+
+    if (!func.strict_mode) {
+        // non-strict 'this' is boxed once, see
+        // also write_function () in function_writer.js
+        func_vars.push({ c_name: 'this_val' });
+    }
+
+    state_machine.entry_point =
+            new_resume_point(state_machine, func_vars);
+
+    // variables declared with 'var' are declared at the
+    // top of the function body, by write_var_locals ()
+    for (const [ name, node ] of func.scope) {
+        if (node.kind === 'var' && !node.is_arguments_object)
+            func_vars.push(node);
+    }
+
+    collect_resume_points(func.body, state_machine,
+                          [ ...func_vars ]);
+}
+
+// ------------------------------------------------------------
+
+const nesting_types = [ 'BlockStatement', 'IfStatement',
+                        'WhileStatement', 'DoWhileStatement',
+                        'ForStatement', 'LabeledStatement' ];
+
+// ------------------------------------------------------------
+
+function check_node (node) {
+
+    switch (node.type) {
+
+        case 'TryStatement':
+        case 'WithStatement':
+        case 'FunctionDeclaration':
+        case 'ClassDeclaration':
+            return false;
+
+        case 'VariableDeclarator':
+            if (node.is_arguments_object)
+                return !node.is_arguments_object_ref;
+            if (node.is_meta_property)
+                return !node.is_meta_property_ref;
+            return node.id.type === 'Identifier'
+                && !node.is_closure;
+
+        case 'YieldExpression':
+            return !!get_yield_statement(node);
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------
+
+function check_params (func) {
+
+    for (let node of func.params) {
+
+        if (node.type === 'AssignmentPattern')
+            node = node.left;
+        else if (node.type === 'RestElement')
+            node = node.argument;
+        if (node.type !== 'Identifier' || node.is_closure)
+            return false;
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------
+
+function get_yield_statement (expr) {
+
+    // returns the statement containing the yield, if
+    // it has one of the forms described above
+
+    if (expr.delegate || (expr.argument
+                      &&  contains_yield(expr.argument)))
+        return;
+
+    let stmt = expr.parent_node;
+
+    if (stmt.type === 'AssignmentExpression'
+    &&  stmt.operator === '=' && stmt.right === expr
+    &&  stmt.left.type === 'Identifier') {
+
+        stmt = stmt.parent_node;
+        if (stmt.type !== 'ExpressionStatement')
+            return;
+
+    } else if (stmt.type === 'VariableDeclarator') {
+
+        if (stmt.init !== expr || stmt.id.type !== 'Identifier')
+            return;
+        stmt = stmt.parent_node;
+        if (stmt.declarations.length !== 1
+        ||  stmt.parent_node.type !== 'BlockStatement')
+            return;
+
+    } else if (stmt.type !== 'ExpressionStatement')
+        return;
+
+    for (let node = stmt.parent_node; !node.is_func_node;
+                                      node = node.parent_node) {
+        if (!nesting_types.includes(node.type))
+            return;
+    }
+
+    return stmt;
+}
+
+// ------------------------------------------------------------
+
+function contains_yield (node) {
+
+    return node.type === 'YieldExpression'
+        || utils.get_child_nodes(node).some(contains_yield);
+}
+
+// ------------------------------------------------------------
+
+function collect_resume_points (node, state_machine, vars) {
+
+    // walk the statements that may contain a yield, while
+    // tracking the let/const variables which are in scope
+    // in C, and which must therefore be saved and restored
+
+    if (node.type === 'YieldExpression') {
+
+        const stmt = get_yield_statement(node);
+        stmt.resume_point = new_resume_point(state_machine, vars);
+        stmt.resume_point.yield_node = node;
+        return;
+    }
+
+    if (!contains_yield(node))
+        return;
+
+    if (node.type === 'BlockStatement') {
+
+        const num_vars = vars.length;
+        for (const stmt of node.body) {
+
+            collect_resume_points(stmt, state_machine, vars);
+            if (stmt.type === 'VariableDeclaration'
+            &&  stmt.kind !== 'var')
+                add_block_vars(stmt, vars);
+        }
+        vars.length = num_vars;
+
+    } else if (node.type === 'ForStatement') {
+
+        const num_vars = vars.length;
+        if (node.init?.type === 'VariableDeclaration'
+        &&  node.init.kind !== 'var')
+            add_block_vars(node.init, vars);
+        collect_resume_points(node.body, state_machine, vars);
+        vars.length = num_vars;
+
+    } else {
+
+        for (const node2 of utils.get_child_nodes(node))
+            collect_resume_points(node2, state_machine, vars);
+    }
+}
+
+// ------------------------------------------------------------
+
+function add_block_vars (stmt, vars) {
+
+    if (stmt.is_arguments_object || stmt.is_meta_property)
+        return;
+
+    // a const variable is assigned when restored
+    stmt.inhibit_const = true;
+
+    vars.push(...stmt.declarations);
+}
+
+// ------------------------------------------------------------
+
+function new_resume_point (state_machine, vars) {
+
+    const slots = state_machine.slots;
+    for (const node of vars) {
+        if (!slots.has(node))
+            slots.set(node, slots.size);
+    }
+
+    return { state_machine, vars: [ ...vars ],
+             index: state_machine.num_points++ };
+}
+
+// ------------------------------------------------------------
+
+module.exports.write_resume_point = function (
+                                    resume_point, value_text) {
+
+    // returns the text to save variables in the frame,
+    // and return, and the text to restore variables when
+    // resumed, see also js_generator_resume ()
+
+    const { state_machine, vars, index } = resume_point;
+    const frame = state_machine.frame_var;
+    const label = `${frame}_${index}`;
+
+    let save_text = '';
+    let restore_text = '';
+    for (const node of vars) {
+
+        const slot = `${frame}->vars[${state_machine.slots.get(node)}]`;
+        const c_name = utils_c.get_variable_c_name(node);
+        save_text += `${slot}=${c_name};`;
+        restore_text += `${c_name}=${slot};`;
+    }
+
+    if (value_text)
+        save_text = `${frame}->value=${value_text};` + save_text;
+
+    return [ save_text + `${frame}->state=${index};`
+                       + 'js_return(js_uninitialized);',
+             `${label}:;` + restore_text ];
+}
+
+// ------------------------------------------------------------
+
+module.exports.write_entry_dispatch = function (state_machine) {
+
+    // returns the text to get the frame on entry, and
+    // jump to the resume point, see js_genenter ()
+
+    const frame = state_machine.frame_var;
+    let text = `js_genframe *${frame}=`
+             + `js_genenter(env,${state_machine.slots.size});`
+             + `switch(${frame}->state){`;
+    for (let index = 1; index < state_machine.num_points; index++)
+        text += `case ${index}:goto ${frame}_${index};`;
+    return text + '}';
+}
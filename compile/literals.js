@@ -25,6 +25,18 @@ function get_value_or_c_name (node) {
 
 // ------------------------------------------------------------
 
+function is_index_key (node) {
+
+    // an integer index key is never kept in the shape of
+    // an object, see js_ownprop () in obj.c, and elem.c
+    return node.type === 'Literal'
+        && typeof(node.value) === 'string'
+        && /^(0|[1-9][0-9]*)$/.test(node.value)
+        && +node.value <= 0xFFFFFFF9;
+}
+
+// ------------------------------------------------------------
+
 function global_to_object_lookup (node, func_node) {
 
     // convert any Identifier nodes, flagged as lookups
@@ -179,7 +191,7 @@ process_object_shape (node) {
         }
         if (prop.type !== 'Property')
             utils.throw_unexpected_property(node);
-        if (!prop.key.c_name) {
+        if (!prop.key.c_name || is_index_key(prop.key)) {
             if (prop.is_proto_property)
                 continue;
             else
@@ -208,7 +220,8 @@ process_constructor_shape (func_node) {
 
         if (node.object.type === 'ThisExpression'
         &&  node.property.c_name
-        &&  !node.property.is_proto_property) {
+        &&  !node.property.is_proto_property
+        &&  !is_index_key(node.property)) {
 
             if (!props.includes(node.property.c_name)) {
                 // duplicate properties are allowed,
@@ -369,9 +382,10 @@ write_string (c_name, str_text, outfunc_output, infunc_output) {
     const intern_flag = !!this.indexers.has(c_name);
 
     const c_init = `${c_name}_init`;
+    const hash = '0x' + string_hash(str_text).toString(16) + 'U';
     outfunc_output.push(
         `static const wchar_t *${c_init}=(const wchar_t[]){`
-    +   `js_newstr_prefix(${num_chars},${+intern_flag}),`
+    +   `js_newstr_prefix(${num_chars},${+intern_flag},${hash}),`
     +   chars_text + '};' );
 
     infunc_output.push(
@@ -448,6 +462,66 @@ write_shape (shape, output) {
 
 // ------------------------------------------------------------
 
+function string_hash (str_text) {
+
+    // calculates the same hash as objset_hash () in objset.c,
+    // over the utf-16 code units of the string, because the
+    // runtime can't cache the hash in a const string literal
+
+    const prime1 = 0x9E3779B1, prime2 = 0x85EBCA77,
+          prime3 = 0xC2B2AE3D, prime4 = 0x27D4EB2F,
+          prime5 = 0x165667B1;
+
+    const rotl = (x, r) => (x << r) | (x >>> (32 - r));
+    const word = (i) => str_text.charCodeAt(i)
+                     | (str_text.charCodeAt(i + 1) << 16);
+
+    const num_chars = str_text.length;
+    let i = 0, hash;
+
+    if (num_chars >= 8) {
+
+        const acc = [ (prime1 + prime2) | 0, prime2, 0, -prime1 | 0 ];
+        do {
+            for (let j = 0; j < 4; j++) {
+                acc[j] = Math.imul(rotl(
+                    (acc[j] + Math.imul(word(i + j * 2), prime2)) | 0,
+                                        13), prime1);
+            }
+            i += 8;
+        } while (num_chars - i >= 8);
+
+        hash = (rotl(acc[0], 1)  + rotl(acc[1], 7)
+             +  rotl(acc[2], 12) + rotl(acc[3], 18)) | 0;
+
+    } else
+        hash = prime5;
+
+    hash = (hash + num_chars * 2) | 0;
+
+    for (; num_chars - i >= 2; i += 2) {
+        hash = Math.imul(rotl(
+            (hash + Math.imul(word(i), prime3)) | 0, 17), prime4);
+    }
+
+    if (i < num_chars) {
+        const ch = str_text.charCodeAt(i);
+        hash = Math.imul(rotl(
+            (hash + Math.imul(ch & 0xFF, prime5)) | 0, 11), prime1);
+        hash = Math.imul(rotl(
+            (hash + Math.imul(ch >>> 8, prime5)) | 0, 11), prime1);
+    }
+
+    hash = Math.imul(hash ^ (hash >>> 15), prime2);
+    hash = Math.imul(hash ^ (hash >>> 13), prime3);
+    hash = (hash ^ (hash >>> 16)) >>> 0;
+
+    // zero means not calculated, see objset_id_hash ()
+    return hash || 1;
+}
+
+// ------------------------------------------------------------
+
 const well_known_strings = [    // see also runtime.h
     'arguments',
     'bigint', 'boolean',
@@ -0,0 +1,188 @@
+
+// ------------------------------------------------------------
+
+const utils = require('./utils');
+const utils_c = require('./utils_c');
+
+// ------------------------------------------------------------
+
+module.exports = function loop_guard_scanner (func) {
+
+    // a property access on an object which is held in
+    // a local variable has to check on every access that
+    // the variable is an object, that its shape matches
+    // the shape cache, and for an array, also that the
+    // array permits fast-path indexing.  but inside a
+    // loop which never assigns the variable, these checks
+    // give the same result on every iteration, unless
+    // some property is deleted or redefined, or some
+    // array fast-path is disabled, see also the macro
+    // js_shape_epoch_bump () in runtime.c
+    //
+    // so for each such property access, we mark the node
+    // with the loop node.  member_expression_object () and
+    // member_expression_array () in property_writer.js
+    // then generate two versions of the access:  a fast
+    // version which only compares a local epoch variable
+    // against env->shape_epoch; and the normal version,
+    // which also records the epoch, if the normal checks
+    // succeed.  the local variables are declared by
+    // write_loop_guard_vars () in statement_writer.js
+    //
+    // we only consider innermost loops without labels,
+    // and without nested functions or try/with/switch,
+    // and we skip coroutines, which are restructured by
+    // convert_to_coroutine () in function_writer.js
+
+    if (!func.generator && !func.async)
+        look_for_loops(func.body);
+}
+
+// ------------------------------------------------------------
+
+const loop_types = [ 'ForStatement', 'ForInStatement',
+                     'ForOfStatement', 'WhileStatement',
+                     'DoWhileStatement' ];
+
+const barrier_types = [ 'TryStatement', 'WithStatement',
+                        'SwitchStatement', 'YieldExpression',
+                        'FunctionDeclaration',
+                        'FunctionExpression',
+                        'ArrowFunctionExpression' ];
+
+// ------------------------------------------------------------
+
+function look_for_loops (node) {
+
+    // returns true if 'node' is, or contains, a loop
+
+    let has_loop = false;
+    for (const node2 of utils.get_child_nodes(node)) {
+
+        if (look_for_loops(node2))
+            has_loop = true;
+    }
+
+    if (!loop_types.includes(node.type))
+        return has_loop;
+
+    if (!has_loop
+    &&  node.parent_node?.type !== 'LabeledStatement') {
+
+        const accesses = [];
+        const assigned = new Set();
+
+        if (scan_loop(node, accesses, assigned, false))
+            mark_accesses(node, accesses, assigned);
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------
+
+function scan_loop (node, accesses, assigned, in_update) {
+
+    // collect candidate property accesses, and any local
+    // variables which are assigned within the loop.
+    // returns false if the loop is not a candidate.
+
+    if (barrier_types.includes(node.type))
+        return false;
+
+    if (node.type === 'AssignmentExpression') {
+
+        return scan_loop(node.left, accesses, assigned, true)
+            && scan_loop(node.right, accesses, assigned, in_update);
+
+    } else if (node.type === 'UpdateExpression') {
+
+        return scan_loop(node.argument, accesses, assigned, true);
+
+    } else if (node.type === 'VariableDeclarator') {
+
+        // a variable declared inside the loop is always
+        // excluded, see mark_accesses (), so skip 'id'
+        return !node.init
+            || scan_loop(node.init, accesses, assigned, in_update);
+
+    } else if (node.type === 'Identifier') {
+
+        if (in_update && node.decl_node)
+            assigned.add(node.decl_node);
+        return true;
+
+    } else if (node.type === 'MemberExpression') {
+
+        accesses.push(node);
+
+        // the object in obj.prop = x is not itself assigned
+        return scan_loop(node.object, accesses, assigned, false)
+            && scan_loop(node.property, accesses, assigned, false);
+    }
+
+    // the loop variable of a for-in or for-of is assigned
+    let left_node;
+    if (node.type === 'ForInStatement'
+    ||  node.type === 'ForOfStatement') {
+
+        left_node = node.left;
+        if (!scan_loop(left_node, accesses, assigned, true))
+            return false;
+    }
+
+    for (const node2 of utils.get_child_nodes(node)) {
+
+        if (node2 !== left_node
+        &&  !scan_loop(node2, accesses, assigned, in_update))
+            return false;
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------
+
+function mark_accesses (loop_node, accesses, assigned) {
+
+    for (const expr of accesses) {
+
+        const obj = expr.object;
+        if (obj.type !== 'Identifier' || expr.optional)
+            continue;
+
+        // the variable must be a plain local variable or
+        // parameter, which is declared outside the loop,
+        // and which is not updated anywhere in the loop
+        const decl_node = obj.decl_node;
+        if (!decl_node || decl_node.is_closure
+                       || decl_node.is_arguments_object
+                       || obj.closure_index >= 0
+                       || obj.with_decl_node
+                       || decl_node === utils_c.env_global_decl_node
+                       || assigned.has(decl_node)
+                       || utils.is_descendant_of(decl_node, loop_node))
+            continue;
+
+        // skip method calls, the function is typically found
+        // in a prototype, so it would not be cached anyway,
+        // and call_expression () replaces the 'this' object
+        const parent_node = expr.parent_node;
+        if ((parent_node.type === 'CallExpression'
+        ||   parent_node.type === 'NewExpression')
+        &&  parent_node.callee === expr)
+            continue;
+
+        // skip the length property, which is written by
+        // member_expression_array_length () instead
+        const prop = expr.computed
+                   ? utils_c.literal_property_name(expr)
+                   : expr.property.name;
+        if (prop === 'length')
+            continue;
+
+        expr.loop_guard = loop_node;
+        loop_node.loop_guard_vars = [];
+        loop_node.loop_slot_vars = [];
+    }
+}
@@ -233,9 +233,72 @@ function member_expression_object (expr, set_expr) {
         obj = `js_make_object(js_get_pointer(${obj}))`;
     }
 
-    return `(${init_obj}${array_txt}(likely(${check_txt})?${access_txt}`
-         + `:${func}(env,${obj},${prop}${value2},&${shape})))`
-         + optional_suffix;
+    const text = `(likely(${check_txt})?${access_txt}`
+               + `:${func}(env,${obj},${prop}${value2},&${shape}))`;
+
+    if (expr.loop_guard && !array_txt && !global_lookup
+                                      && !optional_suffix) {
+
+        // inside a loop, see loop_guard_scanner.js.  if the
+        // object was already checked in an earlier iteration,
+        // and the epoch did not change since, then the cached
+        // slot is a plain data property, and the guard is the
+        // only check, except for the value in a 'set'
+        const [ guard, slot ] = alloc_loop_guard(expr, true);
+
+        let fast_check = `${guard}==env->shape_epoch`;
+        if (set_expr) {
+            fast_check += `&&(${set_expr}.raw!=js_deleted.raw)`
+                       +  `&&(!js_is_object_or_primitive(${set_expr}))`;
+        }
+
+        const recheck = `js_is_object(${obj})&&`
+                      + `${obj_ptr}->shape_id==((uint64_t)${shape})>>32`
+                      + `&&!(${shape}&0xC0000000U)`;
+
+        return `(${init_obj}`
+             + loop_guard_access(expr, guard, fast_check,
+                    `${obj_ptr}->values[${slot}]${value1}`, text,
+                    recheck, `${slot}=(uint32_t)${shape},`)
+             + ')';
+    }
+
+    return `(${init_obj}${array_txt}${text})${optional_suffix}`;
+}
+
+// ------------------------------------------------------------
+
+function alloc_loop_guard (expr, need_slot) {
+
+    // allocate the local variables for a property access
+    // inside a loop, see also write_loop_guard_vars ()
+    // in statement_writer.js
+    const loop_node = expr.loop_guard;
+    const id = utils.get_unique_id();
+    const guard = `guard_${id}`;
+    loop_node.loop_guard_vars.push(guard);
+    if (!need_slot)
+        return [ guard ];
+    const slot = `slot_${id}`;
+    loop_node.loop_slot_vars.push(slot);
+    return [ guard, slot ];
+}
+
+// ------------------------------------------------------------
+
+function loop_guard_access (expr, guard, fast_check, fast_txt,
+                            slow_txt, recheck, save_txt) {
+
+    // select the fast access if the guard is still valid,
+    // otherwise do the normal access, and then update the
+    // guard for the next iteration.  note that the recheck
+    // is done after the access, which may have updated
+    // the shape cache, or converted an array
+    const tmp = utils_c.alloc_temp_value(expr);
+    return `(likely(${fast_check})?${fast_txt}`
+         + `:(${tmp}=${slow_txt},`
+         + `${guard}=(${recheck})?env->shape_epoch:0,`
+         + `${save_txt}${tmp}))`;
 }
 
 // ------------------------------------------------------------
@@ -279,6 +342,17 @@ function member_expression_array (expr, set_expr) {
     let check_text = `js_is_number(${prop})&&${check_array}`
        + `&&js_make_number(${prop_u}).raw==${prop}.raw&&`;
 
+    // inside a loop, see loop_guard_scanner.js, the checks
+    // on the array are replaced by the guard, if the array
+    // was already checked in an earlier iteration
+    let guard, fast_text;
+    if (expr.loop_guard && !expr.optional) {
+        [ guard ] = alloc_loop_guard(expr);
+        fast_text = `js_is_number(${prop})&&`
+           + `${guard}==env->shape_epoch`
+           + `&&js_make_number(${prop_u}).raw==${prop}.raw&&`;
+    }
+
     if (set_expr) {
 
         //
@@ -299,18 +373,36 @@ function member_expression_array (expr, set_expr) {
         }
 
         // add a check to avoid propagating js_deleted
-        check_text += `(${value}.raw!=js_deleted.raw)&&`;
+        let value_check = `(${value}.raw!=js_deleted.raw)&&`;
 
         // if value type is object/string/symbol/bigint,
         // must call js_setprop () to notify gc
-        check_text += `(!js_is_object_or_primitive(${value}))&&`;
+        value_check += `(!js_is_object_or_primitive(${value}))&&`;
 
-        return `(${init_text}(likely(${check_text}`
-             + `${prop_u}<${arr_obj}->capacity)`
-             + `?((${arr_obj}->length_descr[0].num=`
+        const access_text =
+               `((${arr_obj}->length_descr[0].num=`
              + `(${arr_obj}->length=(${arr_obj}->length>${prop_u}`
                                  + `?${arr_obj}->length:${prop_u}+1U)))`
-             + `,${arr_obj}->values[${prop_u}]=${value})`
+             + `,${arr_obj}->values[${prop_u}]=${value})`;
+
+        if (guard) {
+            return `(${init_text}`
+                 + loop_guard_access(expr, guard,
+                        `${fast_text}${value_check}`
+                        + `${prop_u}<${arr_obj}->capacity`,
+                        access_text,
+                        `(likely(${check_text}${value_check}`
+                        + `${prop_u}<${arr_obj}->capacity)`
+                        + `?${access_text}`
+                        + `:js_setprop(env,${obj},${prop},${value},`
+                        + '&env->dummy_shape_cache))',
+                        check_array, '')
+                 + ')';
+        }
+
+        return `(${init_text}(likely(${check_text}${value_check}`
+             + `${prop_u}<${arr_obj}->capacity)`
+             + `?${access_text}`
              + `:js_setprop(env,${obj},${prop},${value},${suffix_text}`;
 
     } else {
@@ -322,6 +414,21 @@ function member_expression_array (expr, set_expr) {
         // otherwise call the slower get-index function
         //
 
+        if (guard) {
+            return `(${init_text}`
+                 + loop_guard_access(expr, guard,
+                        `${fast_text}`
+                        + `${prop_u}<(int64_t)${arr_obj}->capacity`,
+                        `${arr_obj}->values[${prop_u}]`,
+                        `(likely(${check_text}`
+                        + `${prop_u}<(int64_t)${arr_obj}->capacity)`
+                        + `?${arr_obj}->values[${prop_u}]`
+                        + `:js_getprop(env,${obj},${prop},`
+                        + '&env->dummy_shape_cache))',
+                        check_array, '')
+                 + ')';
+        }
+
         return `(${init_text}(likely(${check_text}`
              + `${prop_u}<(int64_t)${arr_obj}->capacity)`
              + `?${arr_obj}->values[${prop_u}]`
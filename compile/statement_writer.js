@@ -3,6 +3,7 @@
 
 const write_expression = require('./expression_writer');
 const compare_writer = require('./compare_writer');
+const generator_scanner = require('./generator_scanner');
 const utils = require('./utils');
 const utils_c = require('./utils_c');
 
@@ -45,10 +46,6 @@ const statement_writers = {
     'SwitchStatement': switch_statement,
 };
 
-// ------------------------------------------------------------
-
-const new_closure_var_prefix = 'js_val *';
-const new_closure_var_suffix = '=js_newclosure(func_val,NULL);'
 
 // ------------------------------------------------------------
 
@@ -242,27 +239,44 @@ function variable_declaration_special_node (decl) {
     //
 
     if (decl.is_arguments_object) {
-        let func_val = 'js_undefined';
-        let text = '';
-        if (!utils.get_parent_func_node(decl).strict_mode) {
-            // note that if the function is not strict mode,
-            // then 'arguments' property in its function object
-            // must be updated, so we call js_arguments () even
-            // if the 'arguments' pseudo-var is not referenced.
-            // we pass a reference to the current function in
-            // the 'callee' argument, in this non-strict case.
-            func_val = 'func_val'
-            // inject a suffix to prevent the potential
-            // warning about an unused local variable
-            text = `);((void)${decl.c_name}`;
+        const func = utils.get_parent_func_node(decl);
+        // in non-strict mode, we pass a reference to the
+        // current function in the 'callee' argument
+        const func_val = func.strict_mode ? 'js_undefined'
+                                          : 'func_val';
+        const args_text = `js_arguments(env,${func_val},`
+                        + 'stk_args,js_stk_top)';
+        let text;
+        if (func.legacy_arguments) {
+            // if the program may observe the 'arguments'
+            // property in a non-strict function object,
+            // see function_splitter.js, then js_arguments ()
+            // must update it, even if the 'arguments'
+            // pseudo-var is not referenced.  inject a suffix
+            // to prevent the potential warning about an
+            // unused local variable
+            text = `${args_text});((void)${decl.c_name}`;
         } else if (!decl.is_arguments_object_ref) {
-            // if strict mode, and 'arguments' is not
-            // explicitly referenced, then don't create it
+            // if 'arguments' is not explicitly
+            // referenced, then don't create it
             decl.skip_void_reference = true;
             return false;
+        } else if (decl.is_closure || func.generator
+               ||  func.async || func.has_try_block) {
+            // create it on entry, if it may be referenced
+            // after this stack frame is gone, or may have
+            // to survive a longjmp () in a try block
+            text = args_text;
+        } else {
+            // otherwise create it on first reference,
+            // see identifier_expression () and js_lazyargs ()
+            // in runtime.h, and also statement_writer ().
+            // we record the stack top pointer on entry,
+            // which marks the end of the arguments.
+            const stk_end = decl.c_name + '_end';
+            decl.lazy_arguments = `${func_val},${stk_end}`;
+            text = `js_deleted);js_link *${stk_end}=(js_stk_top`;
         }
-        text = `js_arguments(env,${func_val},stk_args)`
-             + text;
         decl.init = { type: 'Literal', c_name: text };
     }
 
@@ -278,18 +292,14 @@ function variable_declaration_simple_decl (stmt, decl, output) {
 
     if (decl.is_closure) {
 
-        // if this is a 'var' declaration, then we insert
-        // init at the function scope, else block scope
-        const block_node = (stmt.kind !== 'var') ? stmt
-            : utils.get_parent_func_node(stmt).body;
-
         // push a source line to the top of the containing
-        // block, to allocate memory for the local variable.
-        // its initial value will be set to js_uninitialized.
-        // see js_newclosure () & js_closureval () in func.c,
-        // and closure_expression () in expression_writer.js.
-        utils_c.insert_init_text(block_node,
-            new_closure_var_prefix + c_name + new_closure_var_suffix);
+        // block, to allocate the record for the variables
+        // of the scope, at the function scope for a 'var'
+        // declaration, else block scope.  initial values are
+        // set to js_uninitialized.  see js_newclosure () and
+        // js_closureval () in func.c, and closure_expression ()
+        // in function_writer.js.
+        utils_c.declare_closure_record(decl.closure_record);
 
         if (!decl.init) {
             // the closure variable should become accessible
@@ -317,6 +327,10 @@ function variable_declaration_simple_decl (stmt, decl, output) {
                 if (!stmt.inhibit_const) {
                     // see variable_declaration_pattern ()
                     text += 'const ';
+                } else if (decl.is_volatile_var) {
+                    // a property of a replaced object, see
+                    // replace_object () in escape_scanner.js
+                    text += 'volatile ';
                 }
             } else if (stmt.kind === 'let') {
                 // variable marked by volatile_scanner ()
@@ -328,11 +342,12 @@ function variable_declaration_simple_decl (stmt, decl, output) {
 
             if (decl.is_closure_var_init) {
                 // special case for a 'var' (not let/const)
-                // which is a closure variable.  memory was
-                // allocated for it by the block above, but
-                // the initial value of js_uninitialized
+                // which is a closure variable.  memory is
+                // allocated for it in the function record,
+                // and the initial value of js_uninitialized
                 // must now be replaced with js_undefined.
                 // see also write_var_locals ()
+                utils_c.declare_closure_record(decl.closure_record);
                 text = '*';
 
             } else if (stmt.parent_node.type === 'SwitchCase') {
@@ -422,6 +437,7 @@ function variable_declaration_pattern (
         left: decl.id, // ArrayPattern or ObjectPattern
         right: decl.init,
         parent_node: stmt.parent_node,
+        void_result: true,
     };
     output.push(write_expression(temp, false) + ';');
 
@@ -459,8 +475,7 @@ function function_declaration (stmt, output) {
         // so it must be declared as a closure variable,
         // i.e. a pointer to a value, in the same way that
         // variable_declaration () handles a closure var.
-        utils_c.insert_init_text(func_stmt.body,
-            new_closure_var_prefix + var_name + new_closure_var_suffix);
+        utils_c.declare_closure_record(stmt.closure_record);
         js_val_prefix = '*';
     }
 
@@ -485,6 +500,9 @@ function if_statement (stmt, output) {
 
 function while_statement (stmt, output) {
 
+    if (stmt.loop_guard_vars && !stmt.loop_guard_block)
+        return write_loop_guard_vars(stmt, output, while_statement);
+
     if (stmt.type === 'DoWhileStatement') {
 
         output.push('do');
@@ -512,6 +530,9 @@ function while_statement (stmt, output) {
 
 function for_statement (stmt, output) {
 
+    if (stmt.loop_guard_vars && !stmt.loop_guard_block)
+        return write_loop_guard_vars(stmt, output, for_statement);
+
     // we want to make sure the entire 'for' statement
     // is enclosed in a C block, which we do by altering
     // the statement type to 'BlockStatement' and making
@@ -546,10 +567,9 @@ function for_statement (stmt, output) {
     if (stmt_init.type === 'VariableDeclaration') {
         for (const decl of stmt_init.declarations)
             decl.skip_void_reference = true;
-        if (!stmt_init.is_pattern_decl) {
+        if (!stmt_init.is_pattern_decl)
             variable_declaration(stmt_init, output);
-            update_text = collect_closure_vars(stmt);
-        }
+        update_text = collect_closure_vars(stmt);
     } else
         output.push(write_expression(stmt_init, false) + ';');
 
@@ -595,42 +615,31 @@ function for_statement (stmt, output) {
 
     //
     // if any variables declared in the loop 'init' clause
-    // are closure variables, then variable_declaration ()
-    // added init text for them into the top of the block,
-    // which is actually the current node, because the
-    // 'ForStatement' was changed to a 'BlockStatement'.
+    // are closure variables, then their record is allocated
+    // at the top of the block, which is actually the current
+    // node, because the 'ForStatement' was changed to a
+    // 'BlockStatement'.  see also variable_declaration ().
     //
-    // we want to allocate closure memory for each such
-    // variable on every iteration, not just once at the
-    // top of the loop.  so find each line of init text:
-    //      js_val *local_var_nnnn=js_newclosure ()...
-    // as generated by variable_declaration, and copy
-    // this text into the update clause of the for-loop.
+    // we want to allocate a copy of the record on every
+    // iteration, not just once at the top of the loop, so
+    // the update clause of the for-loop copies the record,
+    // and updates the pointers to the closure variables:
+    //      clo_nnnn=js_newclosure(func_val,n,clo_nnnn),
+    //      local_var_nnnn=clo_nnnn+0,...
     //
 
     function collect_closure_vars (stmt) {
 
-        let init_text = stmt.init_text;
-        let update_text = '';
-
-        for (let i = 0; i < init_text.length; i++) {
-            const line = init_text[i];
-            let j = line.indexOf(new_closure_var_prefix);
-            let k = line.indexOf(new_closure_var_suffix, j);
-            if (j !== -1 && k !== -1) {
-
-                // the update clause allocates a new copy of
-                // the loop control variable, with same value
-                j += new_closure_var_prefix.length;
-                update_text +=
-                    // closure_var =
-                    //      new_closure_var(closure_var),
-                    line.substring(j, k)
-                +   '=js_newclosure(func_val,'
-                +   line.substring(j, k)
-                +   '),';
-            }
-        }
+        const record = stmt.closure_record;
+        if (!record)
+            return '';
+
+        const clo = utils_c.declare_closure_record(record);
+        let update_text = `${clo}=js_newclosure(func_val,`
+                        + `${record.vars.length},${clo}),`;
+        record.vars.forEach((decl_node, slot) => update_text +=
+                `${utils_c.get_variable_c_name(decl_node)}`
+              + `=${clo}+${slot},`);
 
         return update_text;
     }
@@ -665,13 +674,24 @@ function for_statement (stmt, output) {
         // which gets reset to zero when iteration is done;
         // array[1] references the iterator 'this' object;
         // and array[2] gets the next result value.
-        // see also js_newiter () and js_nextiter ()
+        // see also js_newiter () and js_nextiter (), which
+        // steps a plain array in place, see runtime.h
+        //
+        // for-of with an array pattern passes 'P' instead of
+        // 'O', so a map iterator can reuse the entry array,
+        // which is only destructured, see js_map_iter_reuse ()
         //
+        let kind = stmt.save_type[3]; // 'O' or 'I'
+        if (kind === 'O' && node.type === 'VariableDeclaration'
+                         && node.declarations.length === 1
+                         && node.declarations[0].id?.type
+                                            === 'ArrayPattern')
+            kind = 'P';
+
         const iter = 'iter_' + utils.get_unique_id();
         utils_c.insert_init_text(stmt,
             `!js_val ${iter}[3];js_newiter(env,${iter},`
-            + `'${stmt.save_type[3]}',` // 'O' or 'I'
-            + write_expression(stmt.right) + ');');
+            + `'${kind}',` + write_expression(stmt.right) + ');');
 
         let decl_0;
         if (node.type === 'Identifier') {
@@ -691,7 +711,7 @@ function for_statement (stmt, output) {
                  || decl_0_id_type === 'ObjectPattern') {
 
                 stmt.test = `likely(${iter}[0].raw!=0)`;
-                stmt.update = `js_nextiter1(env,${iter})`;
+                stmt.update = `js_nextiter(env,${iter})`;
                 node.is_pattern_decl = true;
                 decl_0.init = { type: 'Literal',
                                 c_name: `${iter}[2]`,
@@ -711,7 +731,7 @@ function for_statement (stmt, output) {
             + `?(${deref}${c_name}=${iter}[2],true):false`;
 
         stmt.update = `(void)${c_name},`
-                    + `js_nextiter1(env,${iter})`;
+                    + `js_nextiter(env,${iter})`;
 
         return node;
     }
@@ -719,8 +739,44 @@ function for_statement (stmt, output) {
 
 // ------------------------------------------------------------
 
+function write_loop_guard_vars (stmt, output, writer) {
+
+    // a loop marked by loop_guard_scanner.js may allocate
+    // local variables via alloc_loop_guard () in file
+    // property_writer.js.  they must be reset every time
+    // the loop is entered, so we enclose the loop in an
+    // extra C block, and declare the variables at its top
+
+    stmt.loop_guard_block = true;
+    output.push('{');
+    const index = output.length;
+
+    writer(stmt, output);
+
+    const decls = [];
+    if (stmt.loop_guard_vars.length) {
+        decls.push('uint64_t ' + stmt.loop_guard_vars.map(
+                        guard => guard + '=0').join(',') + ';');
+    }
+    if (stmt.loop_slot_vars.length) {
+        decls.push('uint32_t ' + stmt.loop_slot_vars.map(
+                        slot => slot + '=0').join(',') + ';');
+    }
+    output.splice(index, 0, ...decls);
+
+    output.push('}');
+    stmt.loop_guard_block = false;
+}
+
+// ------------------------------------------------------------
+
 function break_continue_statement (stmt, output) {
 
+    // if jumping out of the body of one or more try blocks,
+    // then discard the handlers that were established by
+    // try_statement (), as js_leavetry () is skipped
+    leave_try_blocks(stmt, output);
+
     if (stmt.label !== null) {
 
         let label = stmt;
@@ -755,6 +811,38 @@ function break_continue_statement (stmt, output) {
 
 // ------------------------------------------------------------
 
+function leave_try_blocks (stmt, output) {
+
+    for (let node = stmt;;) {
+
+        const child_node = node;
+        node = node.parent_node;
+        if (!node || node.is_func_node)
+            break;
+
+        if (stmt.label !== null) {
+            if (node.type === 'LabeledStatement'
+            &&  node.label.name === stmt.label.name)
+                break;
+
+        } else if (node.type === 'ForStatement'
+               ||  node.type === 'ForInStatement'
+               ||  node.type === 'ForOfStatement'
+               ||  node.type === 'WhileStatement'
+               ||  node.type === 'DoWhileStatement'
+               || (node.type === 'SwitchStatement'
+                    && stmt.type === 'BreakStatement'))
+            break;
+
+        // the handler and finalizer run after js_leavetry ()
+        if (node.type === 'TryStatement'
+        &&  node.block === child_node)
+            output.push('js_leavetry(env);');
+    }
+}
+
+// ------------------------------------------------------------
+
 function throw_statement (stmt, output) {
 
     const expr_text = stmt.argument
@@ -772,13 +860,15 @@ function return_statement (stmt, output) {
         return;
 
     if (stmt.parent_node
-    && !utils.get_parent_func_node(stmt).strict_mode) {
+    &&  utils.get_parent_func_node(stmt).legacy_arguments) {
         // if not strict mode function, then js_arguments ()
         // called by variable_declaration_special_node (),
         // to set 'arguments' and 'caller' in the function
         // object, which we now have to reset to null.
         // see also js_throw () in stack.c, which resets
         // the 'arguments' property in case of exception.
+        // this is skipped if the program never reads these
+        // properties, see function_splitter.js
         output.push(
             'js_arguments2(env,func_val,js_null,NULL);');
     }
@@ -862,7 +952,14 @@ function with_statement (stmt, output) {
 
 function try_statement (stmt, output) {
 
-    output.push('if(setjmp(*js_entertry(env))==0){');
+    // the js_try record is a local variable, rather than
+    // allocated on every entry, see js_entertry () in
+    // except.c.  it is declared at the top of the block,
+    // so it remains in scope until js_leavetry (), below
+    const try_var = 'try_' + utils.get_unique_id();
+    utils_c.insert_init_text(stmt, `js_try ${try_var};`);
+
+    output.push(`if(js_setjmp(*js_entertry(env,&${try_var}))==0){`);
     statement_writer(stmt.block, output, false);
     output.push('}');
 
@@ -1025,6 +1122,35 @@ function switch_statement (stmt, output) {
 //
 // ------------------------------------------------------------
 
+function resume_point (stmt, output) {
+
+    // a yield statement in a generator compiled as a state
+    // machine, see generator_scanner.js.  write the code
+    // to return the yielded value, and the code to resume
+    // at this point, then replace the yield expression
+    // with the value that was sent to the generator, and
+    // write the rest of the statement, if any
+
+    const yield_node = stmt.resume_point.yield_node;
+    const frame = stmt.resume_point.state_machine.frame_var;
+
+    const value_text = yield_node.argument
+                     ? write_expression(yield_node.argument)
+                     : 'js_undefined';
+    output.push(...generator_scanner.write_resume_point(
+                            stmt.resume_point, value_text));
+
+    const parent_node = yield_node.parent_node;
+    const value_node = { type: 'Literal', c_name: `${frame}->value`,
+                         parent_node };
+    for (const key of [ 'expression', 'right', 'init' ]) {
+        if (parent_node[key] === yield_node)
+            parent_node[key] = value_node;
+    }
+}
+
+// ------------------------------------------------------------
+
 function statement_writer (stmt_or_list, output, extra_braces) {
 
     if (Array.isArray(stmt_or_list)) {
@@ -1047,8 +1173,24 @@ function statement_writer (stmt_or_list, output, extra_braces) {
                     extra_braces = false;
             }
 
+            if (stmt.resume_point)
+                resume_point(stmt, output);
+
+            // identifier_expression () in expression_writer.js
+            // may ask us to create a lazy 'arguments' object
+            // once, before the statement, so the expressions
+            // in the statement can reference the plain local
+            const lazy_args_index = output.length;
+            stmt.lazy_arguments_text = '';
+
             f(stmt, output);
 
+            if (stmt.lazy_arguments_text) {
+                output.splice(lazy_args_index, 0,
+                    '(void)' + stmt.lazy_arguments_text + ';');
+            }
+            stmt.lazy_arguments_text = undefined;
+
             if (extra_braces)
                 output.push('}');
 
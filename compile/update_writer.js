@@ -284,7 +284,8 @@ function update_expression_array_length (lhs_obj_node, lhs_prop,
     text += `?(${lhs_len_text1}${lhs_val_arr}):(${lhs_len_text2}`;
 
     if (shape) {
-        text += `(${arr_obj}->super.shape_id==((uint64_t)${shape})>>32`
+        text += `(js_is_object(${lhs_obj})`
+             +  `&&${arr_obj}->super.shape_id==((uint64_t)${shape})>>32`
              +  `&&!(${shape}&0x80000000U)?${lhs_val_obj}:`;
     }
     text += `js_getprop(env,${lhs_obj},${lhs_prop},&`;
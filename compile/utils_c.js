@@ -72,6 +72,39 @@ exports.insert_init_text = function (node, text) {
 
 // ------------------------------------------------------------
 
+exports.declare_closure_record = function (record, output) {
+
+    // allocate a closure record, see assign_closure_records ()
+    // in variable_resolver.js and js_newclosure () in func.c,
+    // and declare a pointer to each variable in the record.
+    // the record is allocated once at the top of the block
+    // where its variables are declared, or written to the
+    // output for the record which holds the parameters, see
+    // write_param_locals () in function_writer.js
+
+    if (!record.c_name)
+        record.c_name = 'clo_' + utils.get_unique_id();
+
+    let text = `js_val *${record.c_name}=js_newclosure(`
+             + `func_val,${record.vars.length},NULL)`;
+    record.vars.forEach((decl_node, slot) => text +=
+            `,*${exports.get_variable_c_name(decl_node)}`
+          + `=${record.c_name}+${slot}`);
+    text += ';';
+
+    if (output)
+        output.push(text);
+    else if (!record.is_params) {
+        const init_text = record.scope_node.init_text;
+        if (!init_text.includes(text))
+            init_text.push(text);
+    }
+
+    return record.c_name;
+}
+
+// ------------------------------------------------------------
+
 exports.is_global_lookup = function (node) {
 
     return node.type === 'MemberExpression'
@@ -151,7 +184,7 @@ exports.get_with_local2 = function (expr, prop) {
     else if (expr.closure_index >= 0) {
         const closure_expression =
             require('./function_writer').closure_expression;
-        var2 = closure_expression(expr.closure_index, expr);
+        var2 = closure_expression(expr);
 
     } else if (with_node.type === 'VariableDeclarator') {
 
@@ -871,7 +871,10 @@ function add_closure_variable (node) {
     node.is_closure = true;
     decl_node.is_closure = true;
 
-    let func_node = utils.get_parent_func_node(node);
+    // the function which references the variable, noted
+    // for closure_expression () in function_writer.js
+    let func_node = node.closure_ref_func =
+                            utils.get_parent_func_node(node);
     if (!func_node.closures)
         func_node.closures = new Map();
 
@@ -977,6 +980,165 @@ function process_function (func_stmt) {
 
 // ------------------------------------------------------------
 
+function assign_closure_records (functions) {
+
+    // closure variables that are declared in the same scope
+    // are allocated together, as a single closure record,
+    // see js_newclosure () in func.c.  a nested function
+    // references records rather than individual variables:
+    // 'closure_records' maps each record to its index in the
+    // closure array of the nested function, and each closure
+    // variable has a 'closure_slot' in its record.  see also
+    // function_expression () in function_writer.js
+
+    const records = new Map();
+
+    for (const func of functions) {
+
+        if (!func.closures)
+            continue;
+        func.closure_records = new Map();
+        func.initialized_closures = new Set();
+
+        for (const decl_node of func.closures.keys()) {
+
+            let record = decl_node.closure_record;
+            if (!record) {
+                const scope_node = get_closure_scope(decl_node);
+                record = records.get(scope_node);
+                if (!record) {
+                    record = {
+                        scope_node, vars: [],
+                        func: decl_node.is_func_node ? decl_node
+                            : utils.get_parent_func_node(decl_node),
+                        is_self: decl_node.is_func_node,
+                        is_params: Array.isArray(scope_node),
+                    };
+                    records.set(scope_node, record);
+                    scope_node.closure_record = record;
+                }
+                decl_node.closure_record = record;
+                decl_node.closure_slot = record.vars.length;
+                record.vars.push(decl_node);
+            }
+
+            if (!func.closure_records.has(record)) {
+                func.closure_records.set(
+                            record, func.closure_records.size);
+            }
+
+            if (is_initialized_closure(decl_node, record, func))
+                func.initialized_closures.add(decl_node);
+        }
+    }
+}
+
+// ------------------------------------------------------------
+
+function get_closure_scope (decl_node) {
+
+    // returns the node where the record is allocated, which
+    // must match the block where statement_writer.js writes
+    // the declaration.  the record for the function name is
+    // allocated on every reference by js_newfunc ()
+
+    if (decl_node.is_func_node)
+        return decl_node;
+
+    // the parameters of a function share one record,
+    // see write_param_locals () in function_writer.js
+    const func_node = utils.get_parent_func_node(decl_node);
+    if (decl_node.is_parameter)
+        return func_node.params;
+
+    // 'var' and function declarations are allocated at
+    // the function scope, see function_declaration ()
+    // and variable_declaration () in statement_writer.js
+    if (decl_node.kind === 'var'
+    ||  decl_node.type === 'FunctionDeclaration')
+        return func_node.body;
+
+    // otherwise at the block scope, where the loop is itself
+    // a block, for the variables in its 'init' clause, see
+    // for_statement () in statement_writer.js
+    let node = decl_node.parent_node;
+    while (node.type !== 'BlockStatement'
+       &&  node.type !== 'ForStatement'
+       &&  node.type !== 'ForInStatement'
+       &&  node.type !== 'ForOfStatement')
+        node = node.parent_node;
+    return node;
+}
+
+// ------------------------------------------------------------
+
+function is_initialized_closure (decl_node, record, func) {
+
+    // returns true if the closure variable is known to be
+    // initialized whenever the nested function 'func' can
+    // access it, so closure_expression () in file
+    // function_writer.js can skip the check for a reference
+    // before initialization.  this is the case for var and
+    // function declarations, and for internal variables,
+    // which are initialized on entry to the function.
+
+    if (record.is_self || decl_node.kind === 'var'
+    ||  decl_node.type === 'FunctionDeclaration'
+    ||  decl_node.is_arguments_object
+    ||  decl_node.is_meta_property)
+        return true;
+
+    // otherwise, find the node which creates the function
+    // object in the declaring function, which is either
+    // 'func' itself, or the function which encloses it
+    let child_func = func;
+    while (child_func.parent_func !== record.func) {
+        child_func = child_func.parent_func;
+        if (!child_func)
+            return false;
+    }
+    const create_node = child_func.decl_node;
+    if (!create_node?.loc)
+        return false;
+
+    // a parameter is initialized before the function body
+    if (record.is_params)
+        return utils.is_descendant_of(create_node, record.func.body);
+
+    // a let/const variable is initialized when the program
+    // reaches its declaration.  the function object must be
+    // created later in the same scope, but note that function
+    // declarations are hoisted, see function_splitter.js
+    const var_decl = decl_node.parent_node;
+    if (decl_node.type !== 'VariableDeclarator'
+    ||  var_decl?.type !== 'VariableDeclaration'
+    ||  create_node.type === 'FunctionDeclaration')
+        return false;
+
+    const scope_node = var_decl.parent_node;
+    if (scope_node.type === 'CatchClause'
+    ||  scope_node.type === 'ForInStatement'
+    ||  scope_node.type === 'ForOfStatement') {
+        // the variable is assigned before the body runs
+        return utils.is_descendant_of(create_node, scope_node.body);
+    }
+
+    // a jump can never skip a declaration that is directly
+    // in a block, except by also leaving the block.  but in
+    // a 'switch' statement, a jump can skip to a later case
+    if ((   scope_node.type !== 'BlockStatement'
+         && scope_node.type !== 'ForStatement') || !var_decl.loc)
+        return false;
+
+    const decl_end = var_decl.loc.end;
+    const create_start = create_node.loc.start;
+    return create_start.line > decl_end.line
+        || (    create_start.line === decl_end.line
+             && create_start.column >= decl_end.column);
+}
+
+// ------------------------------------------------------------
+
 module.exports = function resolve_all_variables (functions) {
 
     // work the hierarchy of functions in a top-down manner
@@ -987,6 +1149,8 @@ module.exports = function resolve_all_variables (functions) {
         if (func.is_func_node && !func.parent_func)
             process_function(func);
     }
+
+    assign_closure_records(functions);
 }
 
 // ------------------------------------------------------------
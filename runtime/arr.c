@@ -1,52 +1,99 @@
 
+// ------------------------------------------------------------
+//
+// js_arr_iter_run
+//
+// if 'iter' steps a plain array in place, see js_newiter (),
+// returns the number of elements which follow the current
+// value in iter[2], and which can be copied directly from
+// the array, i.e. up to the end of the array, or up to the
+// first hole, and sets *src to point to the first of them.
+// the caller should then advance iter[0] by that number.
+//
+// ------------------------------------------------------------
+
+static uint32_t js_arr_iter_run (const js_val *iter,
+                                 const js_val **src) {
+
+    if (!js_is_number(iter[0]) || iter[0].num <= 0
+    ||  !js_is_object(iter[1]))
+        return 0;
+
+    const js_arr *arr = js_get_pointer(iter[1]);
+    if (!js_obj_is_exotic(arr, js_obj_is_array)
+    ||  arr->length == -1U)
+        return 0;
+
+    const uint32_t index = (uint32_t)iter[0].num - 1;
+    const uint32_t end = (arr->length < arr->capacity)
+                       ? arr->length : arr->capacity;
+    const js_val *values = arr->values;
+    uint32_t count = 0;
+    while (index + count < end
+            && values[index + count].raw != js_deleted.raw)
+        count++;
+
+    *src = &values[index];
+    return count;
+}
+
 // ------------------------------------------------------------
 //
 // js_newarr_spread
 //
+// appends the values of an iterable to an array which is
+// being created by js_newarr (), and which is not yet seen
+// by the gc.  'num_after' is the number of elements which
+// follow the spread, and which must still fit in the array.
+//
 // ------------------------------------------------------------
 
 static js_val *js_newarr_spread (js_environ *env,
                                  js_arr *arr,
                                  js_val *val_ptr,
-                                 js_val iterator_val) {
+                                 js_val iterator_val,
+                                 uint32_t num_after) {
 
     js_val iter[3];
     js_newiter(env, iter, 'O', iterator_val);
 
     while (iter[0].raw) {
 
-        *val_ptr++ = iter[2];
-        uint32_t length = val_ptr - arr->values;
-        if (likely(length < arr->capacity)) {
-
-            js_nextiter1(env, iter);
-            continue;
+        // the elements of a plain array are copied in one
+        // batch, up to the first hole
+        const js_val *src;
+        const uint32_t count = 1 + js_arr_iter_run(iter, &src);
+
+        const uint32_t length = val_ptr - arr->values;
+        const uint64_t needed =
+                    (uint64_t)length + count + num_after;
+        if (needed > arr->capacity) {
+
+            uint64_t new_capacity = arr->capacity
+                                  + (arr->capacity >> 1) + 4;
+            if (new_capacity < needed)
+                new_capacity = needed;
+            if (new_capacity > js_max_index)
+                js_callthrow("RangeError_array_length");
+
+            // re-allocate the values, and copy old elements
+            js_val *new_values =
+                js_malloc(new_capacity * sizeof(js_val));
+            memcpy(new_values, arr->values,
+                        length * sizeof(js_val));
+            js_free(arr->values);
+
+            arr->values = new_values;
+            arr->capacity = new_capacity;
+            val_ptr = new_values + length;
         }
 
-        // current capacity, divided by 16, and clamped
-        // between 4 and 256, determines the increment
-        uint32_t increment = arr->capacity >> 4;
-        if (increment < 4)
-            increment = 4;
-        else if (increment > 256)
-            increment = 256;
-
-        // calculate new capacity
-        uint32_t new_capacity =
-                    arr->capacity + increment;
-        if (new_capacity > js_max_index)
-            js_callthrow("RangeError_array_length");
-
-        // re-allocate the values, and copy old elements
-        js_val *new_values =
-            js_malloc(new_capacity * sizeof(js_val));
-        memcpy(new_values, arr->values,
-                    length * sizeof(js_val));
-
-        arr->values = new_values;
-        arr->capacity = new_capacity;
-
-        val_ptr = new_values + length;
+        *val_ptr++ = iter[2];
+        if (count > 1) {
+            memcpy(val_ptr, src, (count - 1) * sizeof(js_val));
+            val_ptr += count - 1;
+            iter[0].num += count - 1;
+        }
         js_nextiter1(env, iter);
     }
 
@@ -84,7 +131,7 @@ js_val js_newarr (js_environ *env, int num_values, ...) {
 
             next_val = va_arg(args, js_val);
             val_ptr = js_newarr_spread(
-                        env, arr, val_ptr, next_val);
+                        env, arr, val_ptr, next_val, num_values);
         }
 
         va_end(args);
@@ -122,11 +169,26 @@ js_val js_newarr (js_environ *env, int num_values, ...) {
 
 js_val js_restarr_stk (js_environ *env, js_link *stk_ptr) {
 
+    return js_restarr_range(env, stk_ptr, js_stk_top);
+}
+
+// ------------------------------------------------------------
+//
+// js_restarr_range
+//
+// collect the values from stk_ptr up to, but not including,
+// stk_end, into a new array.  see also js_arguments ()
+//
+// ------------------------------------------------------------
+
+static js_val js_restarr_range (js_environ *env,
+                        js_link *stk_ptr, js_link *stk_end) {
+
     js_link *arg_ptr;
 
     int count = 0;
     for (arg_ptr = stk_ptr;
-            arg_ptr != js_stk_top;
+            arg_ptr != stk_end;
                 arg_ptr = arg_ptr->next)
         count++;
 
@@ -137,7 +199,7 @@ js_val js_restarr_stk (js_environ *env, js_link *stk_ptr) {
 
         int index = 0;
         for (arg_ptr = stk_ptr;
-                arg_ptr != js_stk_top;
+                arg_ptr != stk_end;
                     arg_ptr = arg_ptr->next)
             values[index++] = arg_ptr->value;
 
@@ -162,6 +224,30 @@ js_val js_restarr_iter (js_environ *env, js_val *iterator) {
 
     js_val arr_val = js_newarr(env, 0);
     uint32_t prop_idx = 0;
+
+    // the rest of a plain array is copied in one batch,
+    // up to the first hole, as in js_restarr_stk () above
+    const js_val *src;
+    uint32_t count;
+    if (iterator[0].raw
+    &&  (count = 1 + js_arr_iter_run(iterator, &src)) > 1) {
+
+        js_val *values = js_malloc(count * sizeof(js_val));
+        values[0] = iterator[2];
+        memcpy(values + 1, src, (count - 1) * sizeof(js_val));
+
+        js_arr *arr = (js_arr *)js_get_pointer(arr_val);
+        arr->values = values;
+        arr->length = count;
+        js_compare_and_swap_32( // see js_arr_set ()
+                    &arr->capacity, 0U, count);
+        arr->length_descr[0].num = count;
+
+        prop_idx = count;
+        iterator[0].num += count - 1;
+        js_nextiter1(env, iterator);
+    }
+
     while (iterator[0].raw) {
         js_arr_set(env, arr_val, ++prop_idx, iterator[2]);
         js_nextiter1(env, iterator);
@@ -94,7 +94,7 @@ static js_val js_big_from_str (js_environ *env, js_val input) {
     // 0o, 0b, parse as hex, octal or binary, resepctively.
     // otherwise may start with a minus sign.
 
-    const objset_id *id = js_get_pointer(input);
+    const objset_id *id = js_get_pointer(js_str_flat(env, input));
     int len = id->len >> 1; // byte length to char count
 
     // skip leading whitespace
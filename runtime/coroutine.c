@@ -6,6 +6,12 @@
 // and a js try/catch chain.  this coroutine mechanism is
 // used to implement javascript generators in function.js.
 //
+// a generator which meets the conditions checked by
+// generator_scanner.js is instead compiled as a state
+// machine, which returns on each yield, and is called
+// again to resume.  such a generator does not need a
+// separate stack, see js_generator_init () below.
+//
 // ------------------------------------------------------------
 
 typedef struct js_coroutine_context {
@@ -26,9 +32,40 @@ typedef struct js_coroutine_context {
     js_environ *env;
     void *internal2;
     struct js_coroutine_context *next;
+    struct js_coroutine_stack *stack;
 
 } js_coroutine_context;
 
+// ------------------------------------------------------------
+//
+// pool of coroutine stacks.  the stack of a coroutine which
+// ran to completion is kept for reuse by the next coroutine,
+// up to a limit, see js_coroutine_init2 () and kill2 () in
+// platform.c.  the counters are reported by the 'Q' command
+// in js_coroutine () below, and the sizes are set by 'C'.
+//
+// ------------------------------------------------------------
+
+typedef struct js_coroutine_pool {
+
+    struct js_coroutine_stack *free_list;
+    void *mutex;
+    int stack_size;
+    int max_free;
+
+    int num_free;
+    int num_created;
+    int num_reused;
+    int num_active;
+    int max_active;
+    int max_stack_used;
+
+} js_coroutine_pool;
+
+#define js_coroutine_default_stack_size (256 * 1024)
+#define js_coroutine_min_stack_size     (64 * 1024)
+#define js_coroutine_default_max_free   16
+
 // ------------------------------------------------------------
 //
 // functions from platform.c or for use by it
@@ -45,8 +82,15 @@ typedef struct js_coroutine_context {
                                 js_coroutine_context *ctx,
                                 int *state, js_val *val);
 
+/* extern */ void js_coroutine_config2 (
+                                js_coroutine_pool *pool,
+                                int stack_size, int max_free);
+
 /* public */ void js_coroutine_init3 (void *_ctx);
 
+/* public */ js_coroutine_pool *js_coroutine_get_pool (
+                                js_environ *env);
+
 // ------------------------------------------------------------
 
 // stop here if being included from platform.c
@@ -60,6 +104,25 @@ typedef struct js_coroutine_context {
 static void js_coroutine_gc_callback (
                 js_gc_env *gc, js_priv *obj, int why);
 
+// ------------------------------------------------------------
+
+typedef struct js_generator {
+
+    js_genframe frame;  // must be first, see js_genenter ()
+    js_val func_val;
+    js_val this_val;
+    int num_vars;
+    bool running;
+    bool done;
+
+} js_generator;
+
+#define js_generator_priv_type \
+    ((js_val){ .raw = 0x47454E31 /* GEN1 */ })
+
+static void js_generator_gc_callback (
+                js_gc_env *gc, js_priv *obj, int why);
+
 // ------------------------------------------------------------
 //
 // js_newcoroutine
@@ -243,7 +306,8 @@ void js_coroutine_init3 (void *_ctx) {
 
     env->new_target = js_undefined;
     env->try_handler = NULL;
-    if (setjmp(*js_entertry(env)) == 0) {
+    js_try try;
+    if (js_setjmp(*js_entertry(env, &try)) == 0) {
         ctx->try_handler = env->try_handler;
 
         const js_val func_val = ctx->value;
@@ -282,8 +346,31 @@ void js_coroutine_init3 (void *_ctx) {
         ctx->state = 1; // set state to 'return'
     }
 
-    // last switch out of terminating coroutine
-    js_coroutine_switch2(ctx, &ctx->state, &ctx->value);
+    // the caller in platform.c makes the last switch out
+    // of the terminating coroutine, and may later reuse
+    // the stack for another coroutine, so we just return
+}
+
+// ------------------------------------------------------------
+//
+// js_coroutine_get_pool
+//
+// ------------------------------------------------------------
+
+js_coroutine_pool *js_coroutine_get_pool (js_environ *env) {
+
+    js_coroutine_pool *pool = env->coroutine_pool;
+    if (unlikely(!pool)) {
+
+        // the pool is shared with the gc thread, which
+        // may kill a coroutine, see js_coroutine_gc_callback
+        pool = js_calloc(1, sizeof(js_coroutine_pool));
+        pool->mutex = js_mutex_new();
+        pool->stack_size = js_coroutine_default_stack_size;
+        pool->max_free = js_coroutine_default_max_free;
+        env->coroutine_pool = pool;
+    }
+    return pool;
 }
 
 // ------------------------------------------------------------
@@ -391,6 +478,203 @@ static js_val js_coroutine_resume (
                 env->shape_value_done, val, done);
 }
 
+// ------------------------------------------------------------
+//
+// js_genenter
+//
+// called on entry to a generator which was compiled as a
+// state machine, see write_function () in function_writer.js.
+// returns the frame of the generator instance being created
+// or resumed.  the frame is passed via the environment,
+// because the function arguments have their normal meaning
+// on the first call, see js_generator_init () below.
+//
+// ------------------------------------------------------------
+
+js_genframe *js_genenter (js_environ *env, int num_vars) {
+
+    js_generator *gen = (js_generator *)env->genframe;
+
+    if (unlikely(!gen->frame.vars)) {
+
+        // room to save local variables, allocated
+        // on the first call, i.e. generator creation
+        if (!num_vars)
+            num_vars = 1;
+        js_val *vars = js_malloc(num_vars * sizeof(js_val));
+        for (int i = 0; i < num_vars; i++)
+            vars[i] = js_undefined;
+        gen->frame.vars = vars;
+        gen->num_vars = num_vars;
+    }
+
+    return &gen->frame;
+}
+
+// ------------------------------------------------------------
+//
+// js_generator_call
+//
+// ------------------------------------------------------------
+
+static js_val js_generator_call (
+                js_environ *env, js_generator *gen) {
+
+    // call the generator function to resume from the
+    // point where it last returned.  the function does
+    // not look at the arguments passed on the stack,
+    // see also js_callfunc1 () in func.c
+
+    js_ensure_stack_at_least(2);
+    env->new_target = js_undefined;
+    env->genframe = &gen->frame;
+
+    js_link *stk_args = js_stk_top;
+    js_stk_top = js_stk_top->next;
+
+    return (((js_func *)js_get_pointer(gen->func_val))->c_func)
+                (env, gen->func_val, gen->this_val, stk_args);
+}
+
+// ------------------------------------------------------------
+//
+// js_generator_init
+//
+// ------------------------------------------------------------
+
+static js_val js_generator_init (
+                        js_environ *env, js_val func_val,
+                        js_val this_val, js_link *stk_last) {
+
+    js_throw_if_notfunc(env, func_val);
+    js_generator *gen = js_malloc(sizeof(js_generator));
+    gen->frame.vars = NULL;
+    gen->frame.value = js_undefined;
+    gen->frame.state = 0;
+    gen->func_val = func_val;
+    gen->this_val = this_val;
+    gen->num_vars = 0;
+    gen->running = true;
+    gen->done = false;
+
+    js_priv *priv = js_newprivobj(
+                        env, js_generator_priv_type);
+    priv->val_or_ptr.ptr = gen;
+    priv->gc_callback = js_generator_gc_callback;
+    js_val gen_obj = js_gc_manage(env, js_make_object(priv));
+
+    // as in js_coroutine_init1 (), we know that we are
+    // called by function wrapper () in CoroutineFunction ()
+    // and that the stack frame of wrapper () holds the
+    // arguments for the generator function.  but rather
+    // than copy the stack, we call the generator function
+    // on the stack frame of wrapper (), and that function
+    // saves its arguments in the generator frame, before
+    // it returns, without executing any statements.
+
+    js_link *stk_first = js_walkstack(stk_last);
+    const js_val save_first = stk_first->value;
+    js_link *save_top = js_stk_top;
+
+    js_stk_top = stk_last;
+    env->new_target = js_undefined;
+    env->genframe = &gen->frame;
+
+    ((js_func *)js_get_pointer(func_val))->c_func(
+                        env, func_val, this_val, stk_first);
+
+    stk_first->value = save_first;
+    js_stk_top = save_top;
+    gen->running = false;
+
+    return gen_obj;
+}
+
+// ------------------------------------------------------------
+//
+// js_generator_resume
+//
+// ------------------------------------------------------------
+
+static js_val js_generator_resume (
+                js_environ *env, js_generator *gen,
+                js_val cmd, js_val val) {
+
+    if (cmd.num != /* 0x4E */ (double)'N'
+    &&  cmd.num != /* 0x52 */ (double)'R'
+    &&  cmd.num != /* 0x54 */ (double)'T'
+    &&  cmd.num != /* 0x4B */ (double)'K') {
+
+        // unknown command, so the following should
+        // cause coroutine () to throw an exception
+        return js_uninitialized;
+    }
+
+    if (gen->running) {
+        // see also js_coroutine_resume ()
+        js_callthrow("TypeError_coroutine_already_resumed");
+    }
+
+    if (cmd.num != /* 0x4E */ (double)'N' || gen->done) {
+
+        // generator_scanner.js does not accept a function
+        // with try blocks, so there is no handler that can
+        // intercept return () or throw (), and we can just
+        // mark the generator as completed without calling
+        // it.  note that 'done' also tells the gc callback
+        // to stop marking the saved variables.
+        gen->done = true;
+
+        if (cmd.num == /* 0x4B */ (double)'K')
+            return js_true;
+        if (cmd.num == /* 0x54 */ (double)'T')
+            js_throw(env, val);
+        if (cmd.num == /* 0x4E */ (double)'N')
+            val = js_undefined;
+
+        return js_newobj(env,
+                    env->shape_value_done, val, js_true);
+    }
+
+    gen->frame.value = val;
+    gen->running = true;
+
+    js_val ret = js_undefined;
+    js_try try;
+    if (js_setjmp(*js_entertry(env, &try)) == 0)
+        ret = js_generator_call(env, gen);
+
+    js_val exception = js_leavetry(env);
+    gen->running = false;
+
+    if (exception.raw != js_uninitialized.raw) {
+        // an exception completes the generator
+        gen->done = true;
+        js_throw(env, exception);
+    }
+
+    // the generator returns js_uninitialized, which is
+    // not a valid javascript value, to indicate a yield,
+    // and has then stored the yielded value in the frame
+    if (ret.raw != js_uninitialized.raw) {
+        gen->done = true;
+        return js_newobj(env,
+                    env->shape_value_done, ret, js_true);
+    }
+
+    // the gc may have already scanned the frame, so
+    // notify it about values that were saved in the
+    // frame, as js_setprop () does for property values
+    for (int i = 0; i < gen->num_vars; i++) {
+        const js_val var = gen->frame.vars[i];
+        if (js_is_object_or_primitive(var))
+            js_gc_notify(env, var);
+    }
+
+    return js_newobj(env, env->shape_value_done,
+                     gen->frame.value, js_false);
+}
+
 // ------------------------------------------------------------
 //
 // js_coroutine
@@ -423,6 +707,51 @@ static js_val js_coroutine (js_c_func_args) {
         ret = js_coroutine_init1(
                     env, arg1, arg2, stk_args);
 
+    // command is 'S' for initialize State machine
+    } else if (cmd.num == /* 0x53 */ (double)'S') {
+        // arguments as for the 'I' command, but the
+        // function was compiled as a state machine
+        ret = js_generator_init(
+                    env, arg1, arg2, stk_args);
+
+    // command is 'Q' for Query stack pool
+    } else if (cmd.num == /* 0x51 */ (double)'Q') {
+        js_coroutine_pool *pool = js_coroutine_get_pool(env);
+        ret = js_newarr(env, 8,
+            js_make_number((double)pool->stack_size),
+            js_make_number((double)pool->max_free),
+            js_make_number((double)pool->num_free),
+            js_make_number((double)pool->num_created),
+            js_make_number((double)pool->num_reused),
+            js_make_number((double)pool->num_active),
+            js_make_number((double)pool->max_active),
+            js_make_number((double)pool->max_stack_used));
+
+    // command is 'C' for Configure stack pool
+    } else if (cmd.num == /* 0x43 */ (double)'C') {
+        // argument 1 is the stack size for new coroutines,
+        // argument 2 is the number of stacks kept for reuse.
+        // either may be undefined to keep the current value
+        js_coroutine_pool *pool = js_coroutine_get_pool(env);
+        int stack_size = pool->stack_size;
+        int max_free = pool->max_free;
+        if (js_is_number(arg1) && arg1.num >= 0) {
+            stack_size = arg1.num < js_coroutine_min_stack_size
+                       ? js_coroutine_min_stack_size
+                       : arg1.num > 0x40000000
+                       ? 0x40000000 : (int)arg1.num;
+            stack_size = (stack_size + 0xFFFF) & ~0xFFFF;
+        }
+        if (js_is_number(arg2) && arg2.num >= 0)
+            max_free = arg2.num > 0x10000 ? 0x10000 : (int)arg2.num;
+        js_coroutine_config2(pool, stack_size, max_free);
+
+    } else if (js_isprivobj(arg1, js_generator_priv_type)) {
+
+        js_priv *priv = js_get_pointer(arg1);
+        ret = js_generator_resume(
+                    env, priv->val_or_ptr.ptr, cmd, arg2);
+
     } else {
 
         js_priv *priv = js_isprivobj(
@@ -463,6 +792,34 @@ static void js_coroutine_gc_callback (
     }
 }
 
+// ------------------------------------------------------------
+//
+// js_generator_gc_callback
+//
+// ------------------------------------------------------------
+
+static void js_generator_gc_callback (
+                js_gc_env *gc, js_priv *obj, int why) {
+
+    js_generator *gen = obj->val_or_ptr.ptr;
+
+    if (why == 0) {
+        // if notified about collection, free frame
+        js_free(gen->frame.vars);
+        js_free(gen);
+        return;
+    }
+
+    js_gc_mark_val(gc, gen->func_val);
+    js_gc_mark_val(gc, gen->this_val);
+
+    if (!gen->done) {
+        js_gc_mark_val(gc, gen->frame.value);
+        for (int i = 0; i < gen->num_vars; i++)
+            js_gc_mark_val(gc, gen->frame.vars[i]);
+    }
+}
+
 // ------------------------------------------------------------
 
 #endif // included_from_platform
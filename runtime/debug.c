@@ -22,7 +22,7 @@ static void js_object_print (js_environ *env, const js_obj *obj) {
                              (uint64_t *)&prop_key,
                              (uint64_t *)&idx_or_ptr))
             break;
-        if (idx_or_ptr >= 0)
+        if (idx_or_ptr >= 0 || prop_key == env->elems_key)
             continue;
         js_val value = obj->values[~idx_or_ptr];
         if (value.raw == js_deleted.raw)
@@ -118,7 +118,7 @@ static void js_print (js_environ *env, js_val val) {
         if (js_get_primitive_type(val) == js_prim_is_bigint)
             val = js_big_tostring(env, val, 10);
         if (js_get_primitive_type(val) == js_prim_is_string) {
-            const objset_id *id = js_get_pointer(val);
+            const objset_id *id = js_get_pointer(js_str_flat(env, val));
             const wchar_t *txt = (const wchar_t *)id->data;
             int len = id->len >> 1;
             printf("%*.*ls", len, len, txt);
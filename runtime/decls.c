@@ -53,6 +53,12 @@ static js_val js_obj_to_primitive_string (
 static void *js_newexobj (js_environ *env, js_obj *proto,
                           const js_shape *shape);
 
+static js_priv *js_newprivobj (
+                    js_environ *env, js_val priv_type);
+
+static js_priv *js_isprivobj (
+                    js_val obj_val, js_val priv_type);
+
 static js_val *js_ownprop (
     js_environ *env, js_val obj, js_val prop, bool can_add);
 
@@ -70,6 +76,32 @@ static void js_arr_set (js_environ *env, js_val obj,
 static uint32_t js_arr_check_length (
                         js_environ *env, js_val value);
 
+static js_val js_restarr_range (js_environ *env,
+                        js_link *stk_ptr, js_link *stk_end);
+
+// ------------------------------------------------------------
+//
+// elem.c
+//
+// ------------------------------------------------------------
+
+typedef struct js_elems js_elems;
+
+static js_elems *js_elems_of (
+                js_environ *env, const js_obj *obj_ptr);
+
+static js_val *js_elems_slot (
+                const js_elems *elems, uint32_t prop_idx);
+
+static js_val js_elems_get (
+        js_environ *env, const js_obj *obj_ptr, uint32_t prop_idx);
+
+static js_val *js_elems_add (js_environ *env,
+                    js_val obj, uint32_t prop_idx);
+
+static uint32_t js_elems_indexes (js_environ *env,
+                const js_obj *obj_ptr, uint32_t **out);
+
 // ------------------------------------------------------------
 //
 // func.c
@@ -136,6 +168,13 @@ static void js_gc_free (js_environ *env, void *ptr);
 
 static void js_gc_mark_val (js_gc_env *gc, js_val val);
 
+static void js_gc_mark_seq (js_gc_env *gc,
+                            js_val *vals, int num);
+
+static void js_gc_weak_register (js_gc_env *gc, js_priv *priv);
+
+static bool js_gc_weak_alive (js_environ *env, js_val obj);
+
 // ------------------------------------------------------------
 //
 // platform
@@ -170,6 +209,7 @@ uint32_t js_compare_and_swap_32 (
 
 //void js_platform_init ();
 uint64_t js_current_time ();
+bool js_stdout_init ();
 //uint64_t js_elapsed_time ();
 
 // ------------------------------------------------------------
@@ -146,6 +146,7 @@ static bool js_defineProperty_object (
             ||  js_is_descriptor(old_val)) {
 
                 *ptr_shape_id = ++env->next_unique_id;
+                js_shape_epoch_bump(env);
             }
         }
     }
@@ -213,8 +214,10 @@ static bool js_defineProperty_array (
         js_arr_set(env, obj_val, prop_idx, new_val);
 
         // disable fast-path on this array
-        if (js_is_descriptor(new_val))
+        if (js_is_descriptor(new_val)) {
             arr->length = -1U;
+            js_shape_epoch_bump(env);
+        }
     }
 
     return true;
@@ -288,6 +291,7 @@ static bool js_defineProperty_array_length (
 
         // disable fast-path on this array
         arr->length = -1U;
+        js_shape_epoch_bump(env);
     }
 
     return success;
@@ -0,0 +1,357 @@
+
+// ------------------------------------------------------------
+//
+// integer-keyed elements on ordinary objects
+//
+// an integer index key, such as o[5] or o['5'], on an object
+// which is not an array, is not kept in the object shape, as
+// that would require converting the number to a string, and
+// interning the string, on every access, and would create a
+// new shape for every distinct index.
+//
+// instead, the object holds a hidden property, keyed by
+// env->elems_key, which is neither a string nor a symbol,
+// so it is never enumerated.  the value of this property
+// is a private object that points to a js_elems structure,
+// which holds the element values in a flat array.
+//
+// while indexes are added in roughly ascending order, the
+// array is dense:  the slot number equals the index, and
+// holes hold js_deleted.  once an index is added too far
+// beyond the end, the array switches to sparse mode, and
+// an intmap maps each index to its slot in the array.
+//
+// ------------------------------------------------------------
+
+struct js_elems {
+
+    js_val *values;
+    uint32_t capacity;
+    uint32_t count;
+    intmap *slots;  // NULL while dense
+
+};
+
+#define js_elems_kind ((js_val){ .raw = 0x456C6D00 /* Elm0 */ })
+
+// largest gap of holes allowed in dense mode
+#define js_elems_max_gap 16
+
+static void js_elems_gc_callback (
+                js_gc_env *gc, js_priv *obj, int why);
+
+// ------------------------------------------------------------
+//
+// js_elems_of
+//
+// returns the element store of an object, or NULL
+//
+// ------------------------------------------------------------
+
+static js_elems *js_elems_of (
+                js_environ *env, const js_obj *obj_ptr) {
+
+    int64_t idx_or_ptr;
+    if (js_shape_value(obj_ptr->shape,
+                       env->elems_key, &idx_or_ptr)
+                                    && idx_or_ptr < 0) {
+
+        js_val priv_val = obj_ptr->values[~idx_or_ptr];
+        if (js_is_object(priv_val)) {
+            return ((js_priv *)js_get_pointer(priv_val))
+                                        ->val_or_ptr.ptr;
+        }
+    }
+
+    return NULL;
+}
+
+// ------------------------------------------------------------
+//
+// js_elems_slot
+//
+// returns a pointer to the slot for the element at index
+// (prop_idx - 1), or NULL if no slot was ever allocated
+//
+// ------------------------------------------------------------
+
+static js_val *js_elems_slot (
+                const js_elems *elems, uint32_t prop_idx) {
+
+    // prop_idx is one beyond requested index number
+    const uint32_t index = prop_idx - 1;
+
+    if (!elems->slots) {
+
+        if (index < elems->count)
+            return &elems->values[index];
+
+    } else {
+
+        uint64_t slot;
+        if (intmap_get(elems->slots, index, &slot))
+            return &elems->values[slot];
+    }
+
+    return NULL;
+}
+
+// ------------------------------------------------------------
+//
+// js_elems_get
+//
+// returns the element at index (prop_idx - 1), which may be
+// a descriptor, or js_deleted if there is no such element
+//
+// ------------------------------------------------------------
+
+static js_val js_elems_get (
+        js_environ *env, const js_obj *obj_ptr, uint32_t prop_idx) {
+
+    const js_elems *elems = js_elems_of(env, obj_ptr);
+    if (elems) {
+        const js_val *slot = js_elems_slot(elems, prop_idx);
+        if (slot)
+            return *slot;
+    }
+    return js_deleted;
+}
+
+// ------------------------------------------------------------
+//
+// js_elems_grow
+//
+// ------------------------------------------------------------
+
+static void js_elems_grow (js_environ *env, js_elems *elems,
+                           uint32_t min_capacity) {
+
+    const uint32_t old_capacity = elems->capacity;
+    uint64_t new_capacity =
+            old_capacity + (old_capacity >> 1) + 4;
+    if (new_capacity < min_capacity)
+        new_capacity = min_capacity;
+    if (new_capacity > js_max_index + 1ULL)
+        js_callthrow("RangeError_property_count");
+
+    js_val *old_values = elems->values;
+    js_val *new_values =
+                js_malloc(new_capacity * sizeof(js_val));
+    if (old_capacity) {
+        memcpy(new_values, old_values,
+               old_capacity * sizeof(js_val));
+    }
+    for (uint32_t i = old_capacity; i < new_capacity; i++)
+        new_values[i] = js_deleted;
+
+    // barrier to make sure the concurrent gc thread
+    // can never see a combination of newer capacity
+    // and older values, see also js_arr_set ()
+    elems->values = new_values;
+    js_compare_and_swap_32(
+                &elems->capacity, 0U, new_capacity);
+
+    if (old_values)
+        js_gc_free(env, old_values);
+}
+
+// ------------------------------------------------------------
+//
+// js_elems_sparse
+//
+// switch the element store from dense to sparse mode
+//
+// ------------------------------------------------------------
+
+static void js_elems_sparse (js_elems *elems) {
+
+    intmap *slots = js_check_alloc(intmap_create());
+
+    for (uint32_t index = 0; index < elems->count; index++) {
+
+        if (elems->values[index].raw != js_deleted.raw) {
+
+            if (!intmap_set(&slots, index, index))
+                js_check_alloc(NULL); // out of memory
+        }
+    }
+
+    elems->slots = slots;
+}
+
+// ------------------------------------------------------------
+//
+// js_elems_add
+//
+// returns a pointer to the slot for the element at index
+// (prop_idx - 1), allocating the element store, and the
+// slot, if necessary.  a new slot is set to js_deleted.
+// the caller must check that the object is extensible.
+//
+// ------------------------------------------------------------
+
+static js_val *js_elems_add (js_environ *env,
+                    js_val obj, uint32_t prop_idx) {
+
+    js_obj *obj_ptr = js_get_pointer(obj);
+    js_elems *elems = js_elems_of(env, obj_ptr);
+
+    if (!elems) {
+
+        elems = js_malloc(sizeof(js_elems));
+        elems->values = NULL;
+        elems->capacity = 0;
+        elems->count = 0;
+        elems->slots = NULL;
+
+        js_priv *priv = js_newprivobj(env, js_elems_kind);
+        priv->val_or_ptr.ptr = elems;
+        priv->gc_callback = js_elems_gc_callback;
+
+        const js_val priv_val =
+                js_gc_manage(env, js_make_object(priv));
+        js_gc_notify(env, priv_val);
+
+        // add the hidden property;  the key is neither a
+        // string nor a symbol, see also js_elems_init ()
+        js_shape *old_shape = obj_ptr->shape;
+        const int old_count = old_shape->num_values;
+        int64_t idx_or_ptr;
+        js_shape *new_shape =
+            js_shape_value(old_shape, env->elems_key,
+                           &idx_or_ptr) && idx_or_ptr > 0
+            ? (js_shape *)idx_or_ptr
+            : js_shape_new(env, old_shape, old_count,
+                           env->elems_key);
+        js_shape_switch(
+                env, obj_ptr, old_count, priv_val, new_shape);
+
+    } else {
+
+        js_val *slot = js_elems_slot(elems, prop_idx);
+        if (slot)
+            return slot;
+    }
+
+    // prop_idx is one beyond requested index number
+    const uint32_t index = prop_idx - 1;
+    uint32_t slot;
+
+    if (!elems->slots) {
+
+        if (index - elems->count <= js_elems_max_gap) {
+
+            // extend the dense array up to the index,
+            // any new slots in between are holes
+            if (index >= elems->capacity)
+                js_elems_grow(env, elems, prop_idx);
+            elems->count = prop_idx;
+            return &elems->values[index];
+        }
+
+        js_elems_sparse(elems);
+    }
+
+    slot = elems->count;
+    if (slot >= elems->capacity)
+        js_elems_grow(env, elems, slot + 1);
+    if (!intmap_set(&elems->slots, index, slot))
+        js_check_alloc(NULL); // out of memory
+    elems->count = slot + 1;
+    return &elems->values[slot];
+}
+
+// ------------------------------------------------------------
+//
+// js_elems_indexes
+//
+// collects the indexes of all elements that are present,
+// in ascending order.  returns the number of indexes, and
+// sets *out to an array which the caller must js_free ().
+//
+// ------------------------------------------------------------
+
+static int js_elems_compare (const void *a, const void *b) {
+
+    const uint32_t x = *(const uint32_t *)a;
+    const uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t js_elems_indexes (js_environ *env,
+                const js_obj *obj_ptr, uint32_t **out) {
+
+    *out = NULL;
+    const js_elems *elems = js_elems_of(env, obj_ptr);
+    if (!elems || !elems->count)
+        return 0;
+
+    uint32_t *indexes =
+            js_malloc(elems->count * sizeof(uint32_t));
+    uint32_t num = 0;
+
+    if (!elems->slots) {
+
+        for (uint32_t index = 0; index < elems->count; index++) {
+            if (elems->values[index].raw != js_deleted.raw)
+                indexes[num++] = index;
+        }
+
+    } else {
+
+        for (int iter = 0;;) {
+            uint64_t index, slot;
+            if (!intmap_get_next(elems->slots,
+                                 &iter, &index, &slot))
+                break;
+            if (elems->values[slot].raw != js_deleted.raw)
+                indexes[num++] = (uint32_t)index;
+        }
+
+        qsort(indexes, num, sizeof(uint32_t),
+              js_elems_compare);
+    }
+
+    *out = indexes;
+    return num;
+}
+
+// ------------------------------------------------------------
+//
+// js_elems_gc_callback
+//
+// ------------------------------------------------------------
+
+static void js_elems_gc_callback (
+                js_gc_env *gc, js_priv *priv, int why) {
+
+    js_elems *elems = priv->val_or_ptr.ptr;
+
+    if (why == 0) {
+        // if notified about collection, free elements
+        if (elems->slots)
+            intmap_destroy(elems->slots);
+        js_free(elems->values);
+        js_free(elems);
+        return;
+    }
+
+    // read capacity before values, see js_elems_grow ()
+    const uint32_t capacity = elems->capacity;
+    js_gc_mark_seq(gc, elems->values, capacity);
+}
+
+// ------------------------------------------------------------
+//
+// js_elems_init
+//
+// ------------------------------------------------------------
+
+static void js_elems_init (js_environ *env) {
+
+    // the hidden property key is an empty objset_id with
+    // no type flags, so js_keys_in_object () skips it,
+    // and no string or symbol value can ever be equal
+    objset_id *id = js_calloc(1, sizeof(objset_id));
+    env->elems_key = (int64_t)id;
+}
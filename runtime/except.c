@@ -1,27 +1,20 @@
 
-// ------------------------------------------------------------
-//
-// 'try' exception handler
-//
-// ------------------------------------------------------------
-
-struct js_try {
-
-    js_try *parent_try;
-    js_link *stack_top;
-    js_val throw_val;
-    jmp_buf jmp_buf;
-};
-
 // ------------------------------------------------------------
 //
 // js_entertry
 //
 // ------------------------------------------------------------
 
-jmp_buf *js_entertry (js_environ *env) {
+js_jmp_buf *js_entertry (js_environ *env, js_try *try) {
+
+    // the js_try record is owned by the caller, and is
+    // usually a local variable in the same function that
+    // calls js_setjmp (), so it remains valid until the
+    // call to js_leavetry ().  note that the gc reads the
+    // 'throw_val' field only when it walks the stack, in
+    // the context of the main thread, so there is no need
+    // to defer releasing the memory, via js_gc_free ()
 
-    js_try *try = js_malloc(sizeof(js_try));
     try->parent_try = env->try_handler;
     try->stack_top = env->stack_top;
     try->throw_val = js_uninitialized;
@@ -39,10 +32,8 @@ jmp_buf *js_entertry (js_environ *env) {
 js_val js_leavetry (js_environ *env) {
 
     js_try *try = env->try_handler;
-    js_val throw_val = try->throw_val;
     env->try_handler = try->parent_try;
-    js_gc_free(env, try);
-    return throw_val;
+    return try->throw_val;
 }
 
 // ------------------------------------------------------------
@@ -74,7 +65,7 @@ static void js_throw_unwind (
 
         const js_func *func =
                 (js_func *)js_get_pointer(stk_ptr->value);
-        if (!(func->flags & js_strict_mode)) {
+        if (func->flags & js_legacy_arguments) {
 
             js_arguments2(
                     env, stk_ptr->value, js_null, NULL);
@@ -113,10 +104,10 @@ js_val js_throw (js_environ *env, js_val throw_val) {
     }
 
     // jump to the execution point where the 'try'
-    // was set up via setjmp ().  see also wmain ()
+    // was set up via js_setjmp ().  see also wmain ()
     // or try_statement () in statement_writer.js
     env->stack_top = try->stack_top;
-    longjmp(try->jmp_buf, 1);
+    js_longjmp(try->jmp_buf);
 }
 
 // ------------------------------------------------------------
@@ -8,13 +8,20 @@
 #define jsf_abort_if_non_strict 1
 #define jsf_not_constructor     2
 
-struct js_closure_var {
-
-    js_val value;
-    js_val owner_or_ref_count;
-    js_val *next;
+// a closure record holds the closure variables declared
+// in one scope, see js_newclosure () below.  a function
+// object references each record it needs through a pointer
+// to its values, and js_closure_rec_of () gets the record
+struct js_closure_rec {
+
+    struct js_closure_rec *next;
+    uint32_t count;
+    js_val values[];
 };
 
+#define js_closure_rec_of(val_ptr) ((struct js_closure_rec *) \
+    ((uintptr_t)(val_ptr) - offsetof(struct js_closure_rec, values)))
+
 // ------------------------------------------------------------
 //
 // js_newfunc
@@ -36,7 +43,8 @@ js_val js_newfunc (js_environ *env, js_c_func c_func,
     func->where = where;
 
     // arity may include some flag bits
-    func->flags = arity & (js_strict_mode | js_not_constructor);
+    func->flags = arity & (js_strict_mode | js_not_constructor
+                                 | js_legacy_arguments);
 
     // during initialization, always 'js_not_constructor'
     if (unlikely(env->internal_flags & jsf_not_constructor))
@@ -52,43 +60,41 @@ js_val js_newfunc (js_environ *env, js_c_func c_func,
     // function_expression () in expression_writer.js.
     // note the count takes up the high 16-bits in 'closures'.
     const int shape_caches = (closures >> 16) & 0xFFFF;
-    if (!shape_caches)
-        func->shape_cache = NULL;
-    else {
-        func->shape_cache =
-                js_calloc(shape_caches, sizeof(int64_t));
-        closures &= 0xFFFF;
-    }
+    closures &= 0xFFFF;
 
-    // record closure variables in the function object.
-    // note that the first (N = closures argument) entries
-    // are zero, and the last N are the actual pointers.
-    // see also:  js_closureval below.
+    // the low 16-bits count the closure records, which are
+    // passed as pointers to their values, see js_newclosure ()
+    // below.  the closure array and the shape cache share a
+    // single allocation, which js_gc_destroy () releases.
 
-    if ((func->closure_count = closures) != 0) {
+    if (closures | shape_caches) {
 
-        func->closure_array =
-                js_calloc(closures * 2, sizeof(js_val *));
+        js_val **closure_array = js_malloc(
+                        closures * sizeof(js_val *)
+                      + shape_caches * sizeof(int64_t));
 
-        // populate the last N elements with pointers
         va_list args;
         va_start(args, closures);
-        js_val **closure_ptr = &func->closure_array[closures];
-        while (closures-- > 0) {
-            struct js_closure_var *closure_var =
-                        va_arg(args, struct js_closure_var *);
-
-            /*if (js_is_object(closure_var->owner_or_ref_count)) {
-                xxx unlink closure from owner temps
-            }*/
+        for (int i = 0; i < closures; i++)
+            closure_array[i] = va_arg(args, js_val *);
+        va_end(args);
 
-            *closure_ptr++ = &closure_var->value;
+        if (!shape_caches)
+            func->shape_cache = NULL;
+        else {
+            func->shape_cache = memset(&closure_array[closures],
+                                0, shape_caches * sizeof(int64_t));
         }
-        va_end(args);
 
-    } else
+        func->closure_array = closure_array;
+
+    } else {
+
         func->closure_array = NULL;
+        func->shape_cache = NULL;
+    }
 
+    func->closure_count = closures;
     func->closure_temps = NULL;
 
     // set up the two initial properties in a function object:
@@ -98,7 +104,8 @@ js_val js_newfunc (js_environ *env, js_c_func c_func,
     //
     // length { value: (arity), writable: false,
     //          enumerable: false, configurable: true }
-    arity &= ~(js_strict_mode | js_not_constructor);
+    arity &= ~(js_strict_mode | js_not_constructor
+                              | js_legacy_arguments);
     values[0 /* length */] =
         js_make_descriptor(js_newdescr(
             js_descr_value | js_descr_config,
@@ -186,13 +193,15 @@ static js_val js_bind_proxy (js_c_func_args) {
 
     js_func *func_obj = (js_func *)js_get_pointer(func_val);
 
+    // the closure record made by js_proto_bind (), below
     js_val **closure_array = func_obj->closure_array;
-    int closure_count = func_obj->closure_count;
+    const js_val *bound_vals = closure_array[0];
+    const int bound_count = js_closure_rec_of(bound_vals)->count;
 
     // if bound function is called as a constructor --
     // see js_callnew () below -- then we need to keep
     // the 'this' value that was passed
-    func_val = *closure_array[closure_count + 0];
+    func_val = bound_vals[0];
     func_obj = (js_func *)js_get_pointer(func_val);
 
     if (unlikely(closure_array[1] == (void *)-1)) {
@@ -205,20 +214,20 @@ static js_val js_bind_proxy (js_c_func_args) {
         }
 
     } else
-        this_val = *closure_array[closure_count + 1];
+        this_val = bound_vals[1];
 
     //
-    // the number of closures, minus 2, is N, the number
+    // the number of bound values, minus 2, is N, the number
     // of parameters to inject into the call.  we make
     // room for these N parameters, by moving arguments
     // forward N slots in the stack, and then copying
-    // the 'bound' parameters, stored as closures.
+    // the 'bound' parameters, stored in the record.
     //
-    js_growstack(env, js_stk_top, closure_count);
+    js_growstack(env, js_stk_top, bound_count);
 
     js_link *old_stk_ptr = js_stk_top;
     js_link *new_stk_ptr = old_stk_ptr;
-    for (int i = 2; i < closure_count; i++) {
+    for (int i = 2; i < bound_count; i++) {
         new_stk_ptr->value = js_undefined;
         new_stk_ptr = new_stk_ptr->next;
     }
@@ -232,10 +241,9 @@ static js_val js_bind_proxy (js_c_func_args) {
         new_stk_ptr->value = old_stk_ptr->value;
     }
 
-    for (int i = 2; i < closure_count; i++) {
+    for (int i = 2; i < bound_count; i++) {
         old_stk_ptr = old_stk_ptr->next;
-        old_stk_ptr->value =
-                *closure_array[closure_count + i];
+        old_stk_ptr->value = bound_vals[i];
     }
 
     // invoke the c function within the func_val object.
@@ -296,9 +304,8 @@ js_val js_callnew (js_environ *env, js_val func_val,
             func2 = func1;
             while (func2->c_func == js_bind_proxy) {
                 // function object created by js_proto_bind (),
-                // the bound function is in the closure array
-                const int closure_count = func2->closure_count;
-                js_val v = *func2->closure_array[closure_count];
+                // the bound function is in the closure record
+                js_val v = func2->closure_array[0][0];
                 func2 = (js_func *)js_get_pointer(v);
             }
             if (func2->flags & js_not_constructor)
@@ -408,105 +415,76 @@ js_val js_callfunc (js_c_func_args) {
 //
 // js_newclosure
 //
-// allocate a closure variable, i.e. a variable which is
-// accessed by a nested function, and therefore must remain
-// 'live' even when its own declaring function has returned.
+// allocate a closure record, i.e. the closure variables of
+// one scope, which are accessed by a nested function, and
+// therefore must remain 'live' even when their own declaring
+// function has returned.  variable_resolver.js groups the
+// variables of a scope into one record, which is shared by
+// all the nested functions that reference any of them.
+//
+// the new values are copied from 'old_values', when a loop
+// makes a fresh copy of its variables on every iteration,
+// see for_statement () in statement_writer.js, or else set
+// to js_uninitialized, see also js_closureval () below.
 //
-// at some later point, the closure variable is assigned to
-// a function via js_newfunc (), see there.  but until then,
-// the closure value must remain reachable, because of gc.
-// the array in js_func->closure_temps is used for this.
+// at some later point, the record is passed to a function
+// via js_newfunc (), see there.  but until then, the record
+// must remain reachable, because of gc.  the list in
+// js_func->closure_temps is used for this.
 //
 // ------------------------------------------------------------
 
-js_val *js_newclosure (js_val func_val, js_val *old_val) {
+js_val *js_newclosure (js_val func_val, int count,
+                       const js_val *old_values) {
 
-    // allocate room to hold the new closure variable
-    struct js_closure_var *new_closure =
-                js_malloc(sizeof(struct js_closure_var));
-    js_val *val_ptr = &new_closure->value;
-    *val_ptr = old_val ? *old_val : js_uninitialized;
+    // allocate room to hold the new closure variables
+    struct js_closure_rec *new_record =
+                js_malloc(sizeof(struct js_closure_rec)
+                        + count * sizeof(js_val));
+    js_val *values = new_record->values;
+    if (old_values)
+        memcpy(values, old_values, count * sizeof(js_val));
+    else {
+        for (int i = 0; i < count; i++)
+            values[i] = js_uninitialized;
+    }
+    new_record->count = count;
 
-    // an owner function reference tells js_newfunc ()
-    // this closure var can be found in 'closure_temps'
-    new_closure->owner_or_ref_count = func_val;
-    // insert the new closure var in 'closure_temps'
+    // insert the new record in 'closure_temps'
     js_func *func_obj = js_get_pointer(func_val);
-    new_closure->next = func_obj->closure_temps;
-    func_obj->closure_temps = val_ptr;
+    new_record->next = func_obj->closure_temps;
+    func_obj->closure_temps = new_record;
 
-    return val_ptr;
+    return values;
 }
 
 // ------------------------------------------------------------
 //
 // js_closureval
 //
-// support routine for closure values.  closure variable is
-// a local variable that is referenced in a nested function.
+// support routine for closure values.  closure variables
+// are initially set to a special value (js_uninitialized)
+// to allow the nested function to detect a reference to
+// a let/const variable before its declaration is reached:
+//      (() => { (() => v)(); let v; })()
 //
-// when this function is invoked by the outer function, it
-// is called with a special value to allocate the variable.
-// these values values are then sent to the nested function
-// as part of the call to js_newfunc (), see above.
-//
-// when this function is invoked by the inner function, it
-// is called with the index number of a particular closure
-// variable.  the indexing of closure variable is set by
-// add_closure_variable () in variable_resolver.js.
-//
-// note that closure variables are initially set to a special
-// value (js_uninitialized) to allow the nested function to
-// detect uninitialized variables.
+// the check is written inline by closure_expression ()
+// in function_writer.js, which calls this function only
+// if the value is js_uninitialized.  the check is skipped
+// when the variable is known to be initialized.
 //
 // ------------------------------------------------------------
 
-js_val *js_closureval (js_environ *env,
-                       js_val func_val,
-                       int closure_index) {
-
-    js_val *val_ptr;
-    const js_func *func_obj = js_get_pointer(func_val);
-    js_val **closure_array = func_obj->closure_array;
-    const int closure_count = func_obj->closure_count;
-
-    if (closure_index < 0) {
-        // a negated index is used when the parent of
-        // a nested function must forward closure vars
-        // to its nested function, and that parent does
-        // not itself reference those particular vars.
-        // the negated index means the forwarded var may
-        // not be initialized, so we must skip the check.
-        // see also import_local_from_outer_func () in
-        // function_writer.js
-        closure_index = ~closure_index;
-        if (closure_index < closure_count) {
-
-            val_ptr = closure_array[closure_index
-                                  + closure_count];
-            return val_ptr;
-        }
-
-    } else if (closure_index < closure_count) {
-
-        // request to reference a closure variable.
-        // note that we first
-
-        val_ptr = closure_array[closure_index
-                              + closure_count];
+js_val *js_closureval (js_environ *env, js_val *val_ptr) {
 
-        if (val_ptr->raw != js_uninitialized.raw)
-            return (closure_array[closure_index] = val_ptr);
+    if (val_ptr->raw != js_uninitialized.raw)
+        return val_ptr;
 
-        // access to an uninitialized variable
-        js_callshadow(
-            env, "ReferenceError_uninitialized_variable",
-            js_undefined);
-    }
-
-    // internal error caused by invalid parameters
-    fprintf(stderr, "Closure error!\n");
-    exit(1);
+    // access to an uninitialized variable
+    js_callshadow(
+        env, "ReferenceError_uninitialized_variable",
+        js_undefined);
+    return val_ptr; // never reached
 }
 
 // ------------------------------------------------------------
@@ -674,29 +652,38 @@ static js_val js_proto_bind (js_c_func_args) {
                 func->super.values[0 /* length */]))
                                 ->data_or_getter = length;
 
-    // keep the bind parameters in the closure array.
+    // keep the bind parameters in a closure record.
     // index 0 for the target function
     // index 1 for the overriding 'this' reference
-    // index 2 and beyond for bound parameters
-
-    int closure_count = func->closure_count = 2 + num_args;
-    js_val **closure_array = func->closure_array =
-            js_calloc(closure_count * 2, sizeof(js_val *));
-
-    for (int i = 0; i < closure_count; i++) {
-        closure_array[closure_count + i] =
-                                js_malloc(sizeof(js_val));
-    }
-
-    *closure_array[closure_count + 0] = func_val;
-    *closure_array[closure_count + 1] = this_val;
+    // index 2 and beyond for bound parameters.
+    // the closure array has a second slot, used as a flag
+    // by js_bind_proxy () and js_callnew (), and the record
+    // follows in the same allocation as the closure array.
+
+    const int bound_count = 2 + num_args;
+    js_val **closure_array = js_malloc(2 * sizeof(js_val *)
+                        + sizeof(struct js_closure_rec)
+                        + bound_count * sizeof(js_val));
+    struct js_closure_rec *bound_record =
+                (struct js_closure_rec *)&closure_array[2];
+    bound_record->next = NULL;
+    bound_record->count = bound_count;
+
+    js_val *bound_vals = bound_record->values;
+    bound_vals[0] = func_val;
+    bound_vals[1] = this_val;
 
     arg_ptr = stk_args->next;
-    for (int i = 2; i < closure_count; i++) {
+    for (int i = 2; i < bound_count; i++) {
         arg_ptr = arg_ptr->next;
-        *closure_array[closure_count + i] = arg_ptr->value;
+        bound_vals[i] = arg_ptr->value;
     }
 
+    closure_array[0] = bound_vals;
+    closure_array[1] = NULL;
+    func->closure_array = closure_array;
+    func->closure_count = 1;
+
     js_return(bound);
 }
 
@@ -730,10 +717,9 @@ static js_val js_hasinstance (js_c_func_args) {
 
         while (((js_func *)obj_ptr)->c_func == js_bind_proxy) {
             // function object created by js_proto_bind (),
-            // the bound function is in the closure array
+            // the bound function is in the closure record
             const js_func *func_obj = (js_func *)obj_ptr;
-            const int closure_count = func_obj->closure_count;
-            func_val = *func_obj->closure_array[closure_count];
+            func_val = func_obj->closure_array[0][0];
             obj_ptr = (js_obj *)js_get_pointer(func_val);
         }
 
@@ -37,6 +37,18 @@ struct js_gc_env {
     // list of malloc-allocated blocks to free ()
     js_gc_val *free_void_ptrs;
 
+    // list of weak interned strings found unmarked
+    // during sweep, see js_gc_purge_strings ()
+    js_gc_val *dead_strings;
+
+    // list of weak collections marked during this cycle,
+    // see js_gc_ephemerons (), and the list from the last
+    // cycle, and the weak keys found unmarked during the
+    // last sweep, see js_gc_purge_weak ()
+    js_gc_val *weak_maps;
+    js_gc_val *swept_weak_maps;
+    js_gc_val *dead_weak_keys;
+
     int num_new_values;
     int num_all_values;
 
@@ -86,7 +98,8 @@ static void js_gc_collect (js_gc_env *gc, bool full);
 //
 // note that this function also returns false
 // if the value is a string (or a symbol) and
-// its flags indicate it is static or interned.
+// its flags indicate it is static or interned,
+// unless it is a weak interned string.
 //
 // ------------------------------------------------------------
 
@@ -117,8 +130,9 @@ static bool js_gc_compare_and_swap (
             ptr = ((char *)&(id)->flags);
 
             uint32_t word = *(uint16_t *)ptr;
-            if (word & (js_str_in_objset
-                      | js_str_is_static)) {
+            if ((word & js_str_is_static) ||
+                    (word & (js_str_in_objset | js_str_is_weak))
+                                        == js_str_in_objset) {
                 // special case to always skip
                 // interned or static strings
                 return false;
@@ -198,13 +212,20 @@ static void js_gc_push_val (
         :   (which == 'A' ? (gc->run_sweep
                           ? &gc->all_values_2
                           : &gc->all_values)
-        :   NULL));
+        :   (which == 'W' ? &gc->weak_maps
+        :   NULL)));
 
     elem->next = *push_list;
     elem->val = val;
     *push_list = elem;
 
-    if (which != 'A') {
+    if (which == 'W') {
+
+        // pushed by the gc thread itself, see
+        // js_gc_weak_register (), so no wakeup
+        js_mutex_leave(gc->mutex);
+
+    } else if (which != 'A') {
 
         gc->wakeup = true;
         bool sleeping = gc->sleeping;
@@ -438,6 +459,32 @@ static void js_gc_mark_seq (js_gc_env *gc,
     }
 }
 
+// ------------------------------------------------------------
+//
+// js_gc_mark_closures
+//
+// ------------------------------------------------------------
+
+static void js_gc_mark_closures (js_gc_env *gc,
+                                 const js_func *func) {
+
+    // closure records referenced by the function,
+    // and records allocated by it, see js_newclosure ()
+    uint32_t num = func->closure_count;
+    js_val **vals = func->closure_array;
+    while (num-- > 0) {
+        struct js_closure_rec *rec =
+                            js_closure_rec_of(*vals++);
+        js_gc_mark_seq(gc, rec->values, rec->count);
+    }
+
+    struct js_closure_rec *temp = func->closure_temps;
+    while (temp) {
+        js_gc_mark_seq(gc, temp->values, temp->count);
+        temp = temp->next;
+    }
+}
+
 // ------------------------------------------------------------
 //
 // js_gc_mark_obj
@@ -469,19 +516,7 @@ static void js_gc_mark_obj (js_gc_env *gc, js_obj *obj) {
     } else if (exotic_type == js_obj_is_function) {
 
         const js_func *func = (js_func *)obj;
-
-        uint32_t num = func->closure_count;
-        js_val **vals = func->closure_array + num;
-        while (num-- > 0) {
-            js_gc_mark_val(gc, **vals);
-            vals++;
-        }
-
-        js_val *temp = func->closure_temps;
-        while (temp) {
-            js_gc_mark_val(gc, *temp);
-            temp = ((struct js_closure_var *)temp)->next;
-        }
+        js_gc_mark_closures(gc, func);
 
         if (func->flags & js_strict_mode) {
             js_link *with_scope = func->u.with_scope;
@@ -517,6 +552,25 @@ static void js_gc_mark_val (js_gc_env *gc, js_val val) {
 
                 // recursively process a value object
                 js_gc_mark_obj(gc, js_get_pointer(val));
+
+            } else if (js_get_primitive_type(val)
+                                    == js_prim_is_string) {
+
+                // a rope references two other strings.
+                // loop on the left side, which may be a
+                // long chain, and recurse on the right
+                // side, which is limited, see js_rope
+                const js_rope *rope = js_get_pointer(val);
+                while (rope->flags & js_str_is_rope) {
+
+                    js_gc_mark_val(gc, rope->right);
+                    val = rope->left;
+                    if (!js_gc_compare_and_swap(val,
+                                js_gc_marked_bit,
+                                true, js_gc_marked_bit))
+                        break;
+                    rope = js_get_pointer(val);
+                }
             }
     }
 }
@@ -534,16 +588,25 @@ static void js_gc_notify (js_environ *env, js_val val) {
     // that a value was ref'ed, while being set
     // as an object property or array index).
 
+    // while a sweep is running, the marked bit of a
+    // live value is about to be cleared, and the next
+    // cycle may scan the object before the caller sets
+    // the value there, so the value is queued anyway,
+    // see also ref_values_2 in js_gc_push_val ().
+    // the flag is read before the bits, as the sweep
+    // may clear the bits and finish in between.
+    js_gc_env *gc = env->gc;
+    const bool sweeping = *(volatile bool *)&gc->run_sweep;
+
     bool marked_and_notify_bits_are_clear =
 
         js_gc_compare_and_swap(val,
             js_gc_marked_bit | js_gc_notify_bit,
                          true, js_gc_notify_bit);
 
-    if (!marked_and_notify_bits_are_clear)
+    if (!marked_and_notify_bits_are_clear && !sweeping)
         return;
 
-    js_gc_env *gc = env->gc;
     js_gc_push_val(gc, val, 'R');
 #endif
 }
@@ -633,6 +696,41 @@ static void js_gc_ref_values (js_gc_env *gc) {
     }
 }
 
+// ------------------------------------------------------------
+//
+// js_gc_destroy
+//
+// ------------------------------------------------------------
+
+static void js_gc_destroy (js_gc_env *gc, js_val val) {
+
+    void *ptr = js_get_pointer(val);
+
+    // gc callback for private objects
+    if (js_is_object(val) &&
+                js_obj_is_exotic(
+                    ptr, js_obj_is_private)) {
+        js_priv *priv = ptr;
+        if (priv->gc_callback)
+            priv->gc_callback(gc, priv, 0);
+    }
+
+    // the closure array and shape cache of a function,
+    // see js_newfunc ().  but not the closure records,
+    // which may be shared with other functions
+    if (js_is_object(val) &&
+                js_obj_is_exotic(
+                    ptr, js_obj_is_function)) {
+        js_func *func = ptr;
+        if (func->closure_array)
+            js_free(func->closure_array);
+    }
+
+    // delete the value
+    *(volatile uint32_t *)ptr = 0xDEADF00D;
+    js_free(ptr);
+}
+
 // ------------------------------------------------------------
 //
 // js_gc_run_sweep
@@ -671,6 +769,33 @@ static void js_gc_run_sweep (js_gc_env *gc) {
             if (!marked_tail)
                 marked_tail = elem;
 
+        } else if (js_is_primitive_string(val) && (((objset_id *)
+                        js_get_pointer(val))->flags
+                            & js_str_in_objset)) {
+
+            // a weak interned string can only be removed
+            // from env->strings_set by the main thread
+            js_mutex_enter(gc->mutex);
+            elem->next = gc->dead_strings;
+            gc->dead_strings = elem;
+            js_mutex_leave(gc->mutex);
+
+        } else if (js_is_object(val) && (((js_obj *)
+                        js_get_pointer(val))->max_values
+                            & js_gc_weak_bit)) {
+
+            // a weak key can only be removed from its weak
+            // collections by the main thread.  clearing the
+            // weak bit tells js_gc_weak_alive () that the
+            // key is dead, see also js_gc_purge_weak ()
+            js_compare_and_swap_32(&((js_obj *)
+                    js_get_pointer(val))->max_values,
+                    ~js_gc_weak_bit, 0);
+            js_mutex_enter(gc->mutex);
+            elem->next = gc->dead_weak_keys;
+            gc->dead_weak_keys = elem;
+            js_mutex_leave(gc->mutex);
+
         } else {
 
             // push half of the now-free element
@@ -683,20 +808,7 @@ static void js_gc_run_sweep (js_gc_env *gc) {
             } else
                 js_free(elem);
 
-            void *ptr = js_get_pointer(val);
-
-            // gc callback for private objects
-            if (js_is_object(val) &&
-                        js_obj_is_exotic(
-                            ptr, js_obj_is_private)) {
-                js_priv *priv = ptr;
-                if (priv->gc_callback)
-                    priv->gc_callback(gc, priv, 0);
-            }
-
-            // delete the value
-            *(volatile uint32_t *)ptr = 0xDEADF00D;
-            js_free(ptr);
+            js_gc_destroy(gc, val);
         }
     }
 
@@ -713,6 +825,19 @@ static void js_gc_run_sweep (js_gc_env *gc) {
 
     js_gc_val *all_values_2 = gc->all_values_2;
     if (all_values_2) {
+
+        // values created during the sweep may have been
+        // marked when traversed from an older value, and
+        // were not reset above.  a stale mark would stop
+        // the next cycle from traversing the value, e.g.
+        // the pieces of a rope string, see js_str_rope ()
+        for (js_gc_val *elem = all_values_2;
+                        elem; elem = elem->next) {
+            js_gc_compare_and_swap(
+                elem->val, js_gc_marked_bit, false,
+                js_gc_marked_bit);
+        }
+
         marked_tail->next = all_values_2;
         gc->all_values_2 = NULL;
     }
@@ -722,6 +847,11 @@ static void js_gc_run_sweep (js_gc_env *gc) {
     gc->p_num_all_values->num =
         (gc->num_all_values = num_marked_values);
 
+    // the weak collections which survived the sweep
+    // may hold dead keys, see js_gc_purge_weak ()
+    gc->swept_weak_maps = gc->weak_maps;
+    gc->weak_maps = NULL;
+
     //
     // reset gc state and finish
     //
@@ -732,6 +862,82 @@ static void js_gc_run_sweep (js_gc_env *gc) {
     js_mutex_leave(gc->mutex);
 }
 
+// ------------------------------------------------------------
+//
+// js_gc_weak_register
+//
+// called by the gc callback of a weak collection, when the
+// collection is marked, see js_map_gc_callback ()
+//
+// ------------------------------------------------------------
+
+static void js_gc_weak_register (js_gc_env *gc, js_priv *priv) {
+
+    js_gc_push_val(gc, js_make_object(priv), 'W');
+}
+
+// ------------------------------------------------------------
+//
+// js_gc_ephemerons
+//
+// an entry in a weak collection keeps its value alive only
+// while the key is alive, and the collection itself does not
+// mark the values of its entries.  so once all other values
+// are marked, we mark the values of those entries whose keys
+// were marked.  this may in turn mark more keys, so repeat
+// until nothing new is marked, see js_map_weak_mark ()
+//
+// ------------------------------------------------------------
+
+static void js_gc_ephemerons (js_gc_env *gc) {
+
+    bool marked_more;
+    do {
+        marked_more = false;
+        for (js_gc_val *elem = gc->weak_maps;
+                        elem; elem = elem->next) {
+            if (js_map_weak_mark(gc, js_get_pointer(elem->val)))
+                marked_more = true;
+        }
+    } while (marked_more);
+}
+
+// ------------------------------------------------------------
+//
+// js_gc_closures
+//
+// a closure variable is set without notifying the gc, so a
+// function which was marked early in the cycle may since
+// have stored a value that is not referenced elsewhere, as
+// in a module-level 'let x' which is set on first use.  so
+// once the stacks were walked, and before the sweep, mark
+// again the closure records of all the marked functions.
+// a function which is only marked here had its records
+// marked along with it, see js_gc_mark_obj ()
+//
+// ------------------------------------------------------------
+
+static void js_gc_closures (js_gc_env *gc) {
+
+    // values created during the sweep sequence are pushed
+    // into 'all_values_2', so this list does not change
+    js_mutex_enter(gc->mutex);
+    js_gc_val *elem = gc->all_values;
+    js_mutex_leave(gc->mutex);
+
+    for (; elem; elem = elem->next) {
+
+        const js_val val = elem->val;
+        if (!js_is_object(val))
+            continue;
+
+        const js_obj *obj = js_get_pointer(val);
+        if (js_obj_is_exotic(obj, js_obj_is_function)
+                && (obj->max_values & js_gc_marked_bit))
+            js_gc_mark_closures(gc, (const js_func *)obj);
+    }
+}
+
 // ------------------------------------------------------------
 //
 // js_gc_loop
@@ -778,10 +984,137 @@ static void js_gc_loop (void *_gc_arg) {
 
         js_gc_ref_values(gc);
 
+        js_gc_closures(gc);
+
+        js_gc_ephemerons(gc);
+
         js_gc_run_sweep(gc);
     }
 }
 
+// ------------------------------------------------------------
+//
+// js_gc_purge_strings
+//
+// removes from env->strings_set the weak interned strings
+// that were found unmarked by the last sweep, see also
+// js_str_intern_weak ().  this must run on the main thread,
+// while the gc thread is idle, as the main thread is the
+// only one to access env->strings_set.  a string that was
+// found in env->strings_set after the sweep is marked, or
+// no longer weak, and is put back on 'all_values'.
+//
+// ------------------------------------------------------------
+
+static void js_gc_purge_strings (js_gc_env *gc) {
+
+    js_mutex_enter(gc->mutex);
+    js_gc_val *elem = gc->dead_strings;
+    gc->dead_strings = NULL;
+    js_mutex_leave(gc->mutex);
+
+    while (elem) {
+
+        js_gc_val *next_elem = elem->next;
+        objset_id *id = js_get_pointer(elem->val);
+
+        if ((id->flags & (js_str_is_weak
+                        | (js_gc_marked_bit >> 16)))
+                                    == js_str_is_weak) {
+
+            objset_delete(&gc->env->strings_set, id);
+            *(volatile uint32_t *)id = 0xDEADF00D;
+            js_free(id);
+            js_free(elem);
+
+        } else {
+
+            js_mutex_enter(gc->mutex);
+            elem->next = gc->all_values;
+            gc->all_values = elem;
+            ++gc->num_all_values;
+            js_mutex_leave(gc->mutex);
+        }
+
+        elem = next_elem;
+    }
+}
+
+// ------------------------------------------------------------
+//
+// js_gc_purge_weak
+//
+// removes the keys that were found unmarked by the last sweep
+// from the weak collections which survived that sweep, then
+// frees those keys.  like js_gc_purge_strings (), this runs
+// on the main thread, while the gc thread is idle.
+//
+// ------------------------------------------------------------
+
+static void js_gc_purge_weak (js_gc_env *gc) {
+
+    js_mutex_enter(gc->mutex);
+    js_gc_val *maps = gc->swept_weak_maps;
+    js_gc_val *keys = gc->dead_weak_keys;
+    gc->swept_weak_maps = NULL;
+    gc->dead_weak_keys = NULL;
+    js_mutex_leave(gc->mutex);
+
+    while (maps) {
+
+        js_gc_val *next_elem = maps->next;
+        if (keys)
+            js_map_weak_purge(gc->env, js_get_pointer(maps->val));
+        js_free(maps);
+        maps = next_elem;
+    }
+
+    while (keys) {
+
+        js_gc_val *next_elem = keys->next;
+        js_gc_destroy(gc, keys->val);
+        js_free(keys);
+        keys = next_elem;
+    }
+}
+
+// ------------------------------------------------------------
+//
+// js_gc_weak_alive
+//
+// called by WeakRef.prototype.deref () to check that the
+// target is still alive.  if the target is not marked, a
+// sweep in progress may be about to find it dead, so wait
+// for the sweep to end.  a dead key has its weak bit cleared
+// by the sweep, see js_gc_run_sweep ().  otherwise the gc
+// is notified, as the target may now be referenced from a
+// local variable only.  note that only the main thread can
+// initiate a sweep, see js_gc_collect ()
+//
+// ------------------------------------------------------------
+
+static bool js_gc_weak_alive (js_environ *env, js_val obj) {
+
+#ifdef js_gc_build
+    const js_obj *obj_ptr = js_get_pointer(obj);
+    js_gc_env *gc = env->gc;
+
+    if (!(obj_ptr->max_values & js_gc_marked_bit)) {
+
+        js_mutex_enter(gc->mutex);
+        while (gc->run_sweep)
+            js_event_wait(gc->event, gc->mutex, 55U);
+        js_mutex_leave(gc->mutex);
+    }
+
+    if (!(obj_ptr->max_values & js_gc_weak_bit))
+        return false;
+
+    js_gc_notify(env, obj);
+#endif
+    return true;
+}
+
 // ------------------------------------------------------------
 //
 // js_gc_collect
@@ -812,6 +1145,8 @@ static void js_gc_collect (js_gc_env *gc, bool full) {
     // to do is walk all stacks so the gc thread
     // can mark values referenced only by locals.
     js_mutex_leave(gc->mutex);
+    js_gc_purge_strings(gc);
+    js_gc_purge_weak(gc);
     js_gc_walkstack(gc->env);
 
     // we can now request sweep, then wait until
@@ -828,6 +1163,11 @@ static void js_gc_collect (js_gc_env *gc, bool full) {
         js_event_wait(gc->event, gc->mutex, 55U);
 
     js_mutex_leave(gc->mutex);
+
+    // no other sweep can begin until the next call, so
+    // dead weak keys can already be removed and freed
+    if (full)
+        js_gc_purge_weak(gc);
 }
 
 // ------------------------------------------------------------
@@ -9,8 +9,25 @@
 // ------------------------------
 
 #include <stdlib.h>
+#include <string.h>
 #include "intmap.h"
 
+//
+// the keys are often pointers, or nan-boxed values, whose
+// low bits are mostly constant, so a key is mixed into a
+// hash, see intmap_hash ().  the low 7 bits of the hash are
+// kept in a control byte for each entry, and the remaining
+// bits select a group of 8 control bytes to probe first.
+// a group is probed in a single 64-bit word, as in the
+// portable implementation of abseil's swiss tables, see
+// https://abseil.io/about/design/swisstables
+//
+// the entries themselves still form a linked list, in
+// order of insertion, which is walked by intmap_get_next ().
+// so a deleted entry is never reused, as it is still part
+// of that list, until the map is resized.
+//
+
 typedef struct intmap_entry intmap_entry;
 struct intmap_entry {
 
@@ -19,7 +36,9 @@ struct intmap_entry {
     // entry in order of insertion.  positive value is
     // a deleted entry, see intmap_get_or_del ()
     int32_t next_index;
-    int32_t unused;
+    // order of insertion, which survives a resize,
+    // see intmap_iterate () and intmap_seek ()
+    uint32_t seq;
     int64_t key;
     int64_t value;
 };
@@ -42,6 +61,13 @@ struct intmap {
     // number of entries populated (including deleted)
     int count;
 
+    // sequence number for the next entry that is added
+    uint32_t next_seq;
+
+    // number of deleted entries, which are still part
+    // of 'count', until the map is resized or compacted
+    int num_deleted;
+
 };
 
 #define header_size_in_entries                  \
@@ -52,84 +78,246 @@ struct intmap {
 #define get_entry(map,index) \
     ((intmap_entry *)map + (index))
 
+// the control bytes follow the last entry
+#define get_ctrl(map) ((uint8_t *)get_entry(map,     \
+                header_size_in_entries + (map)->capacity))
+
+// a control byte is the low 7 bits of the hash for
+// an entry in use, or one of the following values.
+// the sentinel pads the control bytes in a map with
+// less than 8 entries, so it always has one group
+#define ctrl_empty      0x80
+#define ctrl_deleted    0xFE
+#define ctrl_sentinel   0xFF
+
+#define group_width     8
+#define group_lsbs      0x0101010101010101ULL
+#define group_msbs      0x8080808080808080ULL
+
+// the largest count, including deleted entries,
+// before the map has to be resized, i.e. 7/8 full
+#define max_count(capacity) ((capacity) - ((capacity) + 7) / 8)
+
 //
-// intmap_create
+// intmap_hash
 //
 
-intmap *intmap_create (void) {
+static inline uint64_t intmap_hash (uint64_t key) {
 
-    // capacity is used as an AND mask,
-    // so must always be a factor of two
-    const int _initial_capacity = 4;
+    // the finalizer from murmurhash3, which spreads
+    // every bit of the key into the high and low bits
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+    return key;
+}
 
-    // contiguous allocation for the intmap control
-    // structure and entries.  this means that index #0
-    // corresponds to the intmap control structure itself,
-    // and valid entries start at 'header_size_in_entries'.
+//
+// group functions
+//
 
-    const int num_entries_to_allocate =
-        header_size_in_entries + _initial_capacity;
+static inline uint64_t intmap_group (
+                            const intmap *map, int group) {
 
-    intmap *map = calloc(num_entries_to_allocate,
-                         sizeof(intmap_entry));
+    // load 8 control bytes, the first one in the low byte.
+    // note that this assumes a little-endian machine
+    uint64_t word;
+    memcpy(&word, get_ctrl(map) + group * group_width,
+           sizeof(word));
+    return word;
+}
 
-    if (map)
-        map->capacity = _initial_capacity;
+static inline uint64_t intmap_group_match (
+                            uint64_t word, uint8_t h2) {
 
-    return map;
+    // sets the high bit in each byte which equals h2.
+    // this may have false positives, in a byte that
+    // follows a true match, but these are harmless,
+    // as the caller always compares the full key
+    const uint64_t x = word ^ (group_lsbs * h2);
+    return (x - group_lsbs) & ~x & group_msbs;
 }
 
+static inline uint64_t intmap_group_empty (uint64_t word) {
+
+    // sets the high bit in each byte which is ctrl_empty,
+    // the only value with the high bit set and bit 1 clear
+    return (word & ~(word << 6)) & group_msbs;
+}
+
+#define intmap_group_next_bit(mask) \
+    (__builtin_ctzll(mask) >> 3)
+
 //
-// intmap_resize_entry
+// intmap_find
 //
 
-static intmap_entry *intmap_resize_entry (
-                            intmap *map, uint64_t key) {
+static int intmap_find (const intmap *map,
+                        uint64_t key, uint64_t hash) {
 
-    int index = key & (map->capacity - 1);
+    // returns the index of the entry for the key, not
+    // including the map header, or -1 if not found
 
-    for (;;) {
+    const uint8_t h2 = hash & 0x7F;
+    const int group_mask = (map->capacity >= group_width
+                         ?  map->capacity / group_width : 1) - 1;
+    int group = (hash >> 7) & group_mask;
 
-        // note that when indexing, we skip the map control
-        // structure, which resides just before the entries
-        intmap_entry *new_entry =
-                get_entry(map, index + header_size_in_entries);
+    for (int step = 1;; step++) {
 
-        if (!new_entry->next_index) {
+        const uint64_t word = intmap_group(map, group);
+        for (uint64_t mask = intmap_group_match(word, h2);
+                            mask; mask &= mask - 1) {
 
-            // we reached an empty entry that we can reserve,
-            // update the chain of allocated entries
-            index += header_size_in_entries;
-            get_entry(map, map->last_index)->next_index = ~index;
-            map->last_index = index;
-            new_entry->next_index = ~0;
-            return new_entry;
+            const int index = group * group_width
+                            + intmap_group_next_bit(mask);
+            if (index < map->capacity &&
+                    get_entry(map, index + header_size_in_entries)
+                                        ->key == (int64_t)key)
+                return index;
         }
 
-        // otherwise the entry for the calculated hash is taken,
-        // keep searching by advancing in sequential order
-        index = (index + 1) & (map->capacity - 1);
+        // a group with any empty entry terminates the
+        // search, as an insert would have used that entry
+        if (intmap_group_empty(word))
+            return -1;
+
+        // triangular probing visits every group once,
+        // as the number of groups is a power of two
+        group = (group + step) & group_mask;
     }
 }
 
+//
+// intmap_link_entry
+//
+
+static intmap_entry *intmap_link_entry (intmap *map,
+                            uint64_t key, uint64_t hash) {
+
+    // reserve the first empty entry in the probe sequence
+    // for the key, and link it after the last entry in the
+    // map.  the caller must make sure the map has room.
+
+    const int group_mask = (map->capacity >= group_width
+                         ?  map->capacity / group_width : 1) - 1;
+    int group = (hash >> 7) & group_mask;
+    uint64_t mask;
+
+    for (int step = 1;; step++) {
+
+        mask = intmap_group_empty(intmap_group(map, group));
+        if (mask)
+            break;
+        group = (group + step) & group_mask;
+    }
+
+    int index = group * group_width + intmap_group_next_bit(mask);
+    get_ctrl(map)[index] = hash & 0x7F;
+    ++map->count;
+
+    index += header_size_in_entries;
+    intmap_entry *new_entry = get_entry(map, index);
+    new_entry->next_index = ~0;
+    new_entry->seq = ++map->next_seq;
+    new_entry->key = key;
+
+    // if the last entry was deleted, its 'next' index is
+    // kept in the positive form, see intmap_get_or_del ().
+    // the new entry is linked last, so another thread in
+    // intmap_get_next () never sees a partial entry
+    intmap_entry *last_entry = get_entry(map, map->last_index);
+    __atomic_store_n(&last_entry->next_index,
+                     (last_entry->next_index > 0)
+                        ? index + 1 : ~index, __ATOMIC_RELEASE);
+    map->last_index = index;
+
+    return new_entry;
+}
+
+//
+// intmap_next_index
+//
+
+static int intmap_next_index (const intmap_entry *entry) {
+
+    // returns the index of the entry which follows the
+    // specified entry in order of insertion, or zero.
+    // a deleted entry keeps 'next' in positive form
+    return (entry->next_index < 0) ? ~entry->next_index
+                                   : entry->next_index - 1;
+}
+
+//
+// intmap_alloc
+//
+
+static intmap *intmap_alloc (int capacity) {
+
+    // contiguous allocation for the intmap control
+    // structure, entries and control bytes.  this means
+    // that index #0 corresponds to the intmap control
+    // structure itself, and valid entries start at
+    // 'header_size_in_entries'.  there are at least
+    // 8 control bytes, see ctrl_sentinel
+
+    const int num_ctrl = capacity >= group_width
+                       ? capacity : group_width;
+
+    intmap *map = calloc(1, (header_size_in_entries + capacity)
+                                * sizeof(intmap_entry)
+                          + num_ctrl);
+    if (map) {
+        map->capacity = capacity;
+        uint8_t *ctrl = get_ctrl(map);
+        memset(ctrl, ctrl_empty, capacity);
+        memset(ctrl + capacity, ctrl_sentinel,
+               num_ctrl - capacity);
+    }
+
+    return map;
+}
+
+//
+// intmap_create
+//
+
+intmap *intmap_create (void) {
+
+    // capacity is used as an AND mask,
+    // so must always be a factor of two
+    const int _initial_capacity = 4;
+
+    return intmap_alloc(_initial_capacity);
+}
+
 //
 // intmap_resize
 //
 
 static intmap *intmap_resize (intmap *old_map) {
 
-    // allocate a new map with twice the capacity.  this is
-    // a contiguous allocation, same as in intmap_create ()
+    // the new map has room for twice the number of entries
+    // which were not deleted, plus one to be added, so it
+    // may be larger, or smaller, than the old map, or the
+    // same size, but without the deleted entries.  the new
+    // map is at most half full, so it does not have to be
+    // resized again soon, even if entries keep being
+    // deleted and added, see also intmap_compact ()
 
-    int new_capacity = old_map->capacity << 1;
+    const int live_count = old_map->count - old_map->num_deleted;
 
-    intmap *new_map = calloc(
-                new_capacity + header_size_in_entries,
-                sizeof(intmap_entry));
+    int new_capacity = 4;
+    while (new_capacity < (live_count + 1) * 2)
+        new_capacity <<= 1;
+
+    intmap *new_map = intmap_alloc(new_capacity);
 
     if (new_map) {
 
-        new_map->capacity = new_capacity;
+        new_map->next_seq = old_map->next_seq;
 
         // copy entries from the old map to the new map
 
@@ -145,14 +333,15 @@ static intmap *intmap_resize (intmap *old_map) {
                 if (old_entry->next_index < 0) {
                     // copy only non-deleted entries
                     intmap_entry *new_entry =
-                            intmap_resize_entry(
-                                    new_map, old_entry->key);
+                            intmap_link_entry(new_map,
+                                old_entry->key,
+                                intmap_hash(old_entry->key));
 
-                    new_entry->key = old_entry->key;
+                    new_entry->seq = old_entry->seq;
                     new_entry->value = old_entry->value;
                 }
 
-                old_index = ~old_entry->next_index;
+                old_index = intmap_next_index(old_entry);
                 if (!old_index)
                     break;
             }
@@ -162,6 +351,54 @@ static intmap *intmap_resize (intmap *old_map) {
     return new_map;
 }
 
+//
+// intmap_reserve
+//
+
+intmap *intmap_reserve (intmap *map) {
+
+    return (map->count < max_count(map->capacity))
+         ? map : intmap_resize(map);
+}
+
+//
+// intmap_compact
+//
+
+intmap *intmap_compact (intmap *map) {
+
+    // once deleted entries outnumber the entries in use,
+    // they make the map larger, and iteration slower, than
+    // needed.  the cost of the copy is then proportional
+    // to the number of deletes since the last resize
+    const int num_deleted = map->num_deleted;
+    return (num_deleted >= 8
+        &&  num_deleted > map->count - num_deleted)
+         ? intmap_resize(map) : map;
+}
+
+//
+// intmap_add_entry
+//
+
+static intmap_entry *intmap_add_entry (intmap **ptr_to_map,
+                            uint64_t key, uint64_t hash) {
+
+    // add a new entry for a key that is known to
+    // not be in the map, resizing the map if full
+
+    intmap *map = *ptr_to_map;
+    intmap *new_map = intmap_reserve(map);
+    if (new_map != map) {
+        if (!new_map)
+            return NULL;
+        free(map);
+        *ptr_to_map = map = new_map;
+    }
+
+    return intmap_link_entry(map, key, hash);
+}
+
 //
 // intmap_set_or_add
 //
@@ -170,75 +407,29 @@ bool intmap_set_or_add (intmap **ptr_to_map,
                         uint64_t key, uint64_t value,
                         bool *was_added) {
 
-    intmap *map = *ptr_to_map;
-    int index = key & (map->capacity - 1);
-    int del_index = 0;
+    const uint64_t hash = intmap_hash(key);
+    const int index = intmap_find(*ptr_to_map, key, hash);
 
-    for (;;) {
+    intmap_entry *entry;
+    if (index >= 0) {
+        // found a non-deleted entry with a matching key,
+        // so we can just overwrite the value
+        entry = get_entry(*ptr_to_map,
+                          index + header_size_in_entries);
+        if (was_added)
+            *was_added = false;
 
-        // note that when indexing, we skip the map control
-        // structure, which resides just before the entries
-        intmap_entry *entry =
-                get_entry(map, index + header_size_in_entries);
-
-        if (!entry->next_index) {
-            // we reached an entry that was never populated,
-            // so there is no need to search any further
-            if (was_added)
-                *was_added = true;
-
-            if (del_index) {
-                // overwrite a deleted entry if one was found
-                // while searching.  we restore 'next' index
-                // by negating it, see also intmap_get_or_del ()
-                entry = get_entry(map, del_index);
-                entry->next_index = -entry->next_index;
-
-            } else if ((++map->count) < map->capacity >> 1) {
-                // the map can accomodate a new entry without
-                // yet having to grow it.  so we connect the
-                // new entry (via its 'next' field) to the last
-                // entry in the map, and point the last entry
-                // in the map, to this new entry.
-                index += header_size_in_entries;
-                get_entry(map, map->last_index)->next_index = ~index;
-                map->last_index = index;
-                entry->next_index = ~0;
-
-            } else {
-                // resize into a new objset, then
-                // get the index for the new entry
-                intmap *new_map = intmap_resize(map);
-                if (!new_map)
-                    return false;
-                *ptr_to_map = new_map;
-                entry = intmap_resize_entry(new_map, key);
-            }
+    } else {
 
-            entry->key = key;
-            entry->value = value;
-            return true;
-        }
-
-        if (entry->next_index < 0) {
-            if (entry->key == key) {
-                // found a non-deleted entry with a matching key,
-                // so we can just overwrite the value
-                entry->value = value;
-                if (was_added)
-                    *was_added = false;
-                return true;
-            }
-        } else { // entry->next_index > 0
-            // this entry is deleted, and we can overwrite it,
-            // if we exhaust the search without a key match
-            del_index = index + header_size_in_entries;
-        }
-
-        // at this point, entry is deleted, or does not match.
-        // keep searching by advancing in sequential order
-        index = (index + 1) & (map->capacity - 1);
+        entry = intmap_add_entry(ptr_to_map, key, hash);
+        if (!entry)
+            return false;
+        if (was_added)
+            *was_added = true;
     }
+
+    entry->value = value;
+    return true;
 }
 
 //
@@ -249,78 +440,27 @@ bool intmap_get_or_add (intmap **ptr_to_map,
                         uint64_t key, uint64_t *value,
                         bool *was_added) {
 
-    intmap *map = *ptr_to_map;
-    int index = key & (map->capacity - 1);
-    int del_index = 0;
-
-    for (;;) {
+    const uint64_t hash = intmap_hash(key);
+    const int index = intmap_find(*ptr_to_map, key, hash);
 
-        // note that when indexing, we skip the map control
-        // structure, which resides just before the entries
-        intmap_entry *entry =
-                get_entry(map, index + header_size_in_entries);
-
-        if (!entry->next_index) {
-            // we reached an entry that was never populated,
-            // so there is no need to search any further.
-            if (was_added)
-                *was_added = true;
-
-            if (del_index) {
-                // overwrite a deleted entry if one was found
-                // while searching.  we restore 'next' index
-                // by negating it, see also intmap_get_or_del ()
-                entry = get_entry(map, del_index);
-                entry->next_index = -entry->next_index;
-
-            } else if ((++map->count) < map->capacity >> 1) {
-                // the map can accomodate a new entry without
-                // yet having to grow it.  so we connect the
-                // new entry (via its 'next' field) to the last
-                // entry in the map, and point the last entry
-                // in the map, to this new entry.
-                index += header_size_in_entries;
-                get_entry(map, map->last_index)->next_index = ~index;
-                map->last_index = index;
-                entry->next_index = ~0;
-
-            } else {
-
-                // resize into a new map, then add the new entry.
-                // this second, recursive call should neither
-                // fail, nor keep recursing, because the resized
-                // map should always have enough space
-                intmap *new_map = intmap_resize(map);
-                if (!new_map)
-                    return false;
-                *ptr_to_map = new_map;
-                entry = intmap_resize_entry(new_map, key);
-            }
-
-            entry->key = key;
-            entry->value = *value;
-            return true;
-        }
-
-        if (entry->next_index < 0) {
-            if (entry->key == key) {
-                // return the matching entry that was found
-                if (value)
-                    *value = entry->value;
-                if (was_added)
-                    *was_added = false;
-                return true;
-            }
-        } else { // entry->next_index > 0
-            // this entry is deleted, and we can overwrite it,
-            // if we exhaust the search without a key match
-            del_index = index + header_size_in_entries;
+    if (index >= 0) {
+        // return the matching entry that was found
+        if (value) {
+            *value = get_entry(*ptr_to_map,
+                        index + header_size_in_entries)->value;
         }
-
-        // at this point, entry is deleted, or does not match.
-        // keep searching by advancing in sequential order
-        index = (index + 1) & (map->capacity - 1);
+        if (was_added)
+            *was_added = false;
+        return true;
     }
+
+    intmap_entry *entry = intmap_add_entry(ptr_to_map, key, hash);
+    if (!entry)
+        return false;
+    entry->value = *value;
+    if (was_added)
+        *was_added = true;
+    return true;
 }
 
 //
@@ -331,45 +471,37 @@ bool intmap_get_or_del (intmap *map,
                         uint64_t key, uint64_t *value,
                         bool del_if_found) {
 
-    int index = key & (map->capacity - 1);
+    const int index = intmap_find(map, key, intmap_hash(key));
 
-    for (;;) {
+    if (index < 0) {
+        if (value)
+            *value = 0;
+        return false;
+    }
 
-        // note that when indexing, we skip the map control
-        // structure, which resides just before the entries
-        intmap_entry *entry =
+    intmap_entry *entry =
             get_entry(map, index + header_size_in_entries);
 
-        if (!entry->next_index) {
-            // we reached an entry that was never populated,
-            // so there is no need to search any further
-            if (value)
-                *value = 0;
-            return false;
-        }
-
-        if (entry->next_index < 0 && entry->key == key) {
-            // found a non-deleted entry with a matching key
-            if (value)
-                *value = entry->value;
-
-            if (del_if_found) {
-                // an entry is marked as deleted, by negating
-                // its next_index.  note that the value should
-                // be negative, as it is a bitwise NOT of the
-                // index number of the next entry (see also
-                // struct intmap_entry and intmap_set_or_add ()).
-                entry->next_index = -entry->next_index;
-                entry->key = 0;
-                entry->value = 0;
-            }
-            return true;
-        }
-
-        // entry is deleted, or does not match.  keep searching
-        // by advancing to the next entry in sequential order
-        index = (index + 1) & (map->capacity - 1);
+    // found a non-deleted entry with a matching key
+    if (value)
+        *value = entry->value;
+
+    if (del_if_found) {
+        // an entry is marked as deleted, by negating
+        // its next_index.  note that the value should
+        // be negative, as it is a bitwise NOT of the
+        // index number of the next entry (see also
+        // struct intmap_entry and intmap_link_entry ()).
+        // the count is not decremented, as the entry
+        // is not reused until the map is resized, see
+        // also intmap_compact ()
+        entry->next_index = -entry->next_index;
+        entry->key = 0;
+        entry->value = 0;
+        get_ctrl(map)[index] = ctrl_deleted;
+        ++map->num_deleted;
     }
+    return true;
 }
 
 //
@@ -390,8 +522,23 @@ bool intmap_get_next (intmap *map, int *index,
 
     for (;;) {
         intmap_entry *entry = get_entry(map, next_index);
-        if (!entry->next_index) {
-            // end of the linked list of populated entries
+        const int32_t entry_next_index =
+                __atomic_load_n(&entry->next_index,
+                                __ATOMIC_ACQUIRE);
+        if (entry_next_index < 0) {
+            // we have an entry to return
+            if (key)
+                *key = entry->key;
+            if (value)
+                *value = entry->value;
+            if (!(*index = ~entry_next_index))
+                *index = map->capacity + header_size_in_entries;
+            return true;
+        }
+        // next > 0 so this entry is deleted, skip to next,
+        // or stop at the end of the list of entries
+        next_index = entry_next_index - 1;
+        if (next_index <= 0) {
             *index = map->capacity + header_size_in_entries;
             if (key)
                 *key = 0;
@@ -399,20 +546,79 @@ bool intmap_get_next (intmap *map, int *index,
                 *value = 0;
             return false;
         }
+    }
+}
+
+//
+// intmap_iterate
+//
+
+bool intmap_iterate (intmap *map, int *index, uint32_t *seq,
+                     uint64_t *key, uint64_t *value) {
+
+    // unlike intmap_get_next (), the index is left at the
+    // last entry returned, so that an entry which is added
+    // later, is still found by the next call
+
+    int next_index;
+    if (*index < header_size_in_entries)
+        next_index = ~map->first_index;
+    else
+        next_index = intmap_next_index(get_entry(map, *index));
+
+    while (next_index > 0) {
+
+        const intmap_entry *entry = get_entry(map, next_index);
         if (entry->next_index < 0) {
             // we have an entry to return
-            if (key)
-                *key = entry->key;
-            if (value)
-                *value = entry->value;
-            if (!(*index = ~entry->next_index))
-                *index = map->capacity + header_size_in_entries;
+            *index = next_index;
+            *seq = entry->seq;
+            *key = entry->key;
+            *value = entry->value;
             return true;
         }
-        // next > 0 so this entry is deleted, skip to next
-        next_index = -entry->next_index;
+
+        // this entry is deleted, but is still linked,
+        // until the map is resized
+        next_index = intmap_next_index(entry);
+    }
+
+    return false;
+}
+
+//
+// intmap_seek
+//
+
+int intmap_seek (intmap *map, uint32_t seq) {
+
+    // returns an index for intmap_iterate (), which
+    // continues at the first entry that follows the
+    // entry with the specified sequence number, even if
+    // that entry was since deleted, and the map resized
+
+    int prev_index = 0;
+    int next_index = ~map->first_index;
+
+    while (next_index > 0) {
+
+        const intmap_entry *entry = get_entry(map, next_index);
+        if (entry->next_index < 0 && entry->seq > seq)
+            break;
+        prev_index = next_index;
+        next_index = intmap_next_index(entry);
     }
+
+    return prev_index;
 }
 
+#undef ctrl_empty
+#undef ctrl_deleted
+#undef ctrl_sentinel
+#undef group_width
+#undef group_lsbs
+#undef group_msbs
+#undef max_count
+#undef get_ctrl
 #undef header_size_in_entries
 #undef get_entry
@@ -40,6 +40,25 @@ bool intmap_get_or_del (intmap *map,
                         uint64_t key, uint64_t *value,
                         bool del);
 
+// intmap_reserve - make sure the map has room for
+// one more entry, so the next intmap_set_or_add ()
+// does not have to resize the map.  returns the map
+// if it has room, or a resized copy, in which case
+// the caller must free the old map, or NULL if cannot
+// allocate.  this lets a caller publish the new map
+// to another thread, which may still be reading the
+// old map, see also intmap_get_next ().
+intmap *intmap_reserve (intmap *map);
+
+// intmap_compact - returns a copy of the map without
+// deleted entries, which may also be smaller, if most
+// entries were deleted.  otherwise returns the map.
+// the caller should call this after deleting entries,
+// and must free the old map if a copy is returned,
+// same as for intmap_reserve (), or NULL if cannot
+// allocate, in which case the map is still valid.
+intmap *intmap_compact (intmap *map);
+
 #define intmap_set(ptr_to_map,key,value) intmap_set_or_add(ptr_to_map,key,value,NULL)
 
 // intmap_has - returns true or false for a key
@@ -58,5 +77,25 @@ bool intmap_get_or_del (intmap *map,
 // and the function can be called again.  returns
 // false if the iteration is complete.  adding new
 // entries during iteration may introduce errors.
+// another thread may iterate the map concurrently
+// with a thread that adds or deletes entries, if
+// the map is never resized, see intmap_reserve ().
 bool intmap_get_next (intmap *map, int *index,
                       uint64_t *key, uint64_t *value);
+
+// intmap_iterate - iterate through the entries in
+// the map, in order of insertion.  initialize the
+// index parameter to zero before the first call.
+// returns true if the next entry is available, and
+// sets the 'seq', 'key' and 'value' parameters.
+// entries which are added during iteration are also
+// returned.  if the map is resized, the index is not
+// valid in the new map, and should be reset by a call
+// to intmap_seek () with the last 'seq' returned.
+bool intmap_iterate (intmap *map, int *index, uint32_t *seq,
+                     uint64_t *key, uint64_t *value);
+
+// intmap_seek - returns an index for intmap_iterate ()
+// that continues after the entry with the specified
+// sequence number, or where that entry would have been
+int intmap_seek (intmap *map, uint32_t seq);
@@ -47,6 +47,11 @@ struct objset {
 
     // number of entries populated (including deleted)
     int32_t count;
+
+    // number of deleted entries, which are still part
+    // of 'count', until the set is resized, or a deleted
+    // entry is reused, see objset_intern ()
+    int32_t num_deleted;
 };
 
 #define header_size_in_entries                  \
@@ -84,6 +89,21 @@ objset *objset_create (void) {
     return map;
 }
 
+//
+// objset_link_entry
+//
+
+static void objset_link_entry (objset *map, int index) {
+
+    // link the entry at 'index' after the last entry in
+    // the map.  if the last entry was deleted, its 'next'
+    // index is kept in the positive form, see objset_delete ()
+    objset_entry *last_entry = get_entry(map, map->last_index);
+    last_entry->next_index = (last_entry->next_index > 0)
+                           ? index + 1 : ~index;
+    map->last_index = index;
+}
+
 //
 // objset_resize_entry
 //
@@ -107,8 +127,7 @@ static objset_entry *objset_resize_entry (
             // we reached an empty entry that we can reserve,
             // update the chain of allocated entries
             index += header_size_in_entries;
-            get_entry(map, map->last_index)->next_index = ~index;
-            map->last_index = index;
+            objset_link_entry(map, index);
             new_entry->next_index = ~0;
             return new_entry;
         }
@@ -123,12 +142,29 @@ static objset_entry *objset_resize_entry (
 // objset_resize
 //
 
+static int objset_next_index (const objset_entry *entry) {
+
+    // returns the index of the entry which follows the
+    // specified entry in order of insertion, or zero.
+    // a deleted entry keeps 'next' in positive form,
+    // see objset_delete ()
+    return (entry->next_index < 0) ? ~entry->next_index
+                                   : entry->next_index - 1;
+}
+
 static objset *objset_resize (objset *old_map) {
 
-    // allocate a new map with twice the capacity.  this is
-    // a contiguous allocation, same as in intmap_create ()
+    // the new set has room for three times the number of
+    // entries which were not deleted, so it may be larger,
+    // or smaller, than the old set, or the same size, but
+    // without the deleted entries.  this is a contiguous
+    // allocation, same as in objset_create ()
 
-    int new_capacity = old_map->capacity << 1;
+    const int live_count = old_map->count - old_map->num_deleted;
+
+    int new_capacity = 4;
+    while (new_capacity < (live_count + 1) * 3)
+        new_capacity <<= 1;
 
     objset *new_map = calloc(new_capacity
                            + header_size_in_entries,
@@ -136,7 +172,7 @@ static objset *objset_resize (objset *old_map) {
     if (new_map) {
 
         new_map->capacity = new_capacity;
-        new_map->count = old_map->count;
+        new_map->count = live_count;
 
         // copy entries from the old map to the new map
 
@@ -159,7 +195,7 @@ static objset *objset_resize (objset *old_map) {
                     new_entry->id_ptr = old_entry->id_ptr;
                 }
 
-                old_index = ~old_entry->next_index;
+                old_index = objset_next_index(old_entry);
                 if (!old_index)
                     break;
             }
@@ -173,28 +209,70 @@ static objset *objset_resize (objset *old_map) {
 // objset_hash
 //
 
-__forceinline uint32_t objset_hash (const void *data, int len) {
-
-    // some crc32-inspired hash function, following reading here:
-    // https://stackoverflow.com/questions/7666509/
-    // (initially tried some combination of djb2 and sdbm)
-
-    const char *ptr = data;
-    const char *ptr_end = ptr + len;
-    uint32_t hash = 0;
-    while (ptr < ptr_end) {
-        hash ^= *ptr;
-        hash = (hash >> 1) ^ (0xEDB88320U & -(hash & 1));
-        hash = (hash >> 1) ^ (0xEDB88320U & -(hash & 3));
-        hash = (hash >> 1) ^ (0xEDB88320U & -(hash & 5));
-        hash = (hash >> 1) ^ (0xEDB88320U & -(hash & 7));
-        // input is probably a utf-16 string,
-        // so in many cases, every second byte is zero
-        ptr += 2;
+#define objset_rotl(x,r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+uint32_t objset_hash (const void *data, int len) {
+
+    // this is xxhash32 with a zero seed, see
+    // https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+    // it consumes all bytes of the utf-16 code units, so
+    // non-latin strings don't collide on the low byte, and
+    // the four independent lanes in the main loop can be
+    // vectorized by the compiler.  note that the compiler
+    // calculates the same hash for string literals, see
+    // write_string () in literals.js, so the two must match.
+
+    const uint32_t prime1 = 0x9E3779B1U, prime2 = 0x85EBCA77U,
+                   prime3 = 0xC2B2AE3DU, prime4 = 0x27D4EB2FU,
+                   prime5 = 0x165667B1U;
+
+    const uint8_t *ptr = data;
+    const uint8_t *ptr_end = ptr + len;
+    uint32_t hash;
+
+    if (len >= 16) {
+
+        uint32_t acc[4] = { prime1 + prime2, prime2, 0, -prime1 };
+        do {
+            for (int i = 0; i < 4; i++) {
+                uint32_t word;
+                memcpy(&word, ptr + i * 4, 4);
+                acc[i] = objset_rotl(acc[i] + word * prime2, 13)
+                       * prime1;
+            }
+            ptr += 16;
+        } while (ptr_end - ptr >= 16);
+
+        hash = objset_rotl(acc[0], 1)  + objset_rotl(acc[1], 7)
+             + objset_rotl(acc[2], 12) + objset_rotl(acc[3], 18);
+
+    } else
+        hash = prime5;
+
+    hash += (uint32_t)len;
+
+    while (ptr_end - ptr >= 4) {
+        uint32_t word;
+        memcpy(&word, ptr, 4);
+        hash = objset_rotl(hash + word * prime3, 17) * prime4;
+        ptr += 4;
     }
-    return hash;
+
+    for (; ptr < ptr_end; ptr++)
+        hash = objset_rotl(hash + *ptr * prime5, 11) * prime1;
+
+    hash ^= hash >> 15;
+    hash *= prime2;
+    hash ^= hash >> 13;
+    hash *= prime3;
+    hash ^= hash >> 16;
+
+    // zero means not calculated, see objset_id_hash ()
+    return hash ? hash : 1;
 }
 
+#undef objset_rotl
+
 //
 // objset_intern
 //
@@ -203,8 +281,7 @@ objset_id *objset_intern (objset **ptr_to_objset,
                           objset_id *id_ptr, bool *copy) {
 
     objset *map = *ptr_to_objset;
-    const uint32_t id_hash =
-                        objset_hash(id_ptr->data, id_ptr->len);
+    const uint32_t id_hash = objset_id_hash(id_ptr);
     int index = id_hash & (map->capacity - 1);
     int del_index = 0;
 
@@ -237,17 +314,17 @@ objset_id *objset_intern (objset **ptr_to_objset,
                 // by negating it, see also objset_delete ()
                 entry = get_entry(map, del_index);
                 entry->next_index = -entry->next_index;
+                --map->num_deleted;
 
-            } else if (++map->count < map->capacity >> 1) {
+            } else if (map->count + 1 < map->capacity >> 1) {
                 // the map can accomodate a new entry without
                 // yet having to grow it.  so we connect the
                 // new entry (via its 'next' field) to the
                 // last entry in the map, and point the last
                 // entry in the map, to this new entry.
+                ++map->count;
                 index += header_size_in_entries;
-                get_entry(map, map->last_index)
-                                        ->next_index = ~index;
-                map->last_index = index;
+                objset_link_entry(map, index);
                 entry->next_index = ~0;
 
             } else {
@@ -262,7 +339,9 @@ objset_id *objset_intern (objset **ptr_to_objset,
                     return NULL;
                 }
                 *ptr_to_objset = new_map;
+                free(map);
                 entry = objset_resize_entry(new_map, id_hash);
+                ++new_map->count;
             }
 
             entry->id_hash = id_hash;
@@ -295,13 +374,13 @@ objset_id *objset_intern (objset **ptr_to_objset,
 }
 
 //
-// objset_search
+// objset_search_hash
 //
 
-objset_id *objset_search (const objset *map,
-                          const void *id_data, int id_len) {
+static objset_id *objset_search_hash (
+                    const objset *map, const void *id_data,
+                    int id_len, uint32_t id_hash) {
 
-    const uint32_t id_hash = objset_hash(id_data, id_len);
     int index = id_hash & (map->capacity - 1);
 
     for (;;) {
@@ -331,46 +410,81 @@ objset_id *objset_search (const objset *map,
     }
 }
 
-#if false
+//
+// objset_search
+//
+
+objset_id *objset_search (const objset *map,
+                          const void *id_data, int id_len) {
+
+    return objset_search_hash(map, id_data, id_len,
+                              objset_hash(id_data, id_len));
+}
+
+//
+// objset_search_id
+//
+
+objset_id *objset_search_id (const objset *map,
+                             objset_id *id_ptr) {
+
+    return objset_search_hash(map, id_ptr->data, id_ptr->len,
+                              objset_id_hash(id_ptr));
+}
 
 //
 // objset_delete
 //
 
-void objset_delete (objset *objset, objset_id *id_ptr) {
+void objset_delete (objset **ptr_to_objset, objset_id *id_ptr) {
 
-    const uint32_t id_hash =
-                    objset_hash(id_ptr->data, id_ptr->len);
-    int index = id_hash & (objset->capacity - 1);
+    objset *map = *ptr_to_objset;
+    const uint32_t id_hash = objset_id_hash(id_ptr);
+    int index = id_hash & (map->capacity - 1);
 
     for (;;) {
 
         // note that when indexing, we skip the map control
         // structure, which resides just before the entries
         objset_entry *entry =
-            get_entry(objset, index + header_size_in_entries);
+            get_entry(map, index + header_size_in_entries);
+
+        if (!entry->next_index)
+            return; // not found
 
-        if (entry->key_ptr == key_ptr) {
+        if (entry->next_index < 0 && entry->id_ptr == id_ptr) {
             // an entry is marked as deleted, by negating
             // its next_index.  note that the value should
             // be negative, as it is a bitwise NOT of the
-            // index number of the next entry
+            // index number of the next entry.  the count
+            // is not decremented, as the entry is still
+            // part of the chain, see objset_resize ()
             entry->next_index = -entry->next_index;
             entry->id_hash = 0;
             entry->id_ptr = NULL;
-            --objset->count;
-            return;
+            ++map->num_deleted;
+            break;
         }
 
-        // keep searching by advancing to the next entry in
-        // sequential order.  note that this would become an
-        // infinite loop if the entry cannot be found, but
-        // we assume we can never deref a non-existant entry.
-        index = (index + 1) & (objset->capacity - 1);
+        // keep searching by advancing to the next entry
+        // in sequential order
+        index = (index + 1) & (map->capacity - 1);
     }
-}
 
-#endif
+    // once deleted entries outnumber the entries in use,
+    // they make every search longer than needed, so copy
+    // the set without them, and possibly shrink it.  if
+    // the copy cannot be allocated, keep the old set
+    const int num_deleted = map->num_deleted;
+    if (num_deleted >= 8 && num_deleted > map->count - num_deleted) {
+
+        objset *new_map = objset_resize(map);
+        if (new_map) {
+            *ptr_to_objset = new_map;
+            free(map);
+        }
+    }
+}
 
 //
 // objset_next
@@ -406,7 +520,13 @@ bool objset_next (const objset *objset, int *index,
             return true;
         }
         // next > 0 so this entry is deleted, skip to next
-        next_index = -entry->next_index;
+        next_index = objset_next_index(entry);
+        if (!next_index) {
+            *index = objset->capacity + header_size_in_entries;
+            if (id_ptr)
+                *id_ptr = NULL;
+            return false;
+        }
     }
 }
 
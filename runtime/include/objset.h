@@ -20,6 +20,11 @@ struct objset_id {
     // extra info for use by caller
     uint16_t flags;
 
+    // hash of the id data, cached by objset_id_hash (),
+    // or zero if not calculated yet.  the caller should
+    // set this to zero when creating a new objset_id
+    uint32_t hash;
+
     // id data, possibly not null-terminated
     wchar_t data[];
 };
@@ -47,12 +52,28 @@ objset_id *objset_intern (objset **ptr_to_objset,
 objset_id *objset_search (const objset *objset,
                           const void *id_data, int id_len);
 
-#if false
-
-// deletes the specified id from the objset.
-void objset_delete (objset *objset, objset_id *id);
-
-#endif
+// same as objset_search (), but uses the hash which is
+// cached in the specified objset_id, see objset_id_hash ()
+objset_id *objset_search_id (const objset *objset,
+                             objset_id *id);
+
+// calculate the hash for the specified data, which is
+// the same hash cached by objset_id_hash ().  never zero.
+uint32_t objset_hash (const void *data, int len);
+
+// returns the hash of the id data, which is calculated
+// once, and cached in the objset_id structure
+#define objset_id_hash(id)                          \
+    ((id)->hash ? (id)->hash                        \
+                : ((id)->hash = objset_hash(        \
+                            (id)->data, (id)->len)))
+
+// deletes the specified id from the objset, if found.
+// the objset_id structure itself is not freed.  the
+// first parameter is a pointer to the objset, because
+// the objset may be reallocated without the deleted
+// entries, once most of its entries are deleted.
+void objset_delete (objset **ptr_to_objset, objset_id *id);
 
 // enumerate the object set.  set index <= 0 on first
 // call, and keep calling while the return value is true.
@@ -23,6 +23,9 @@ static js_environ *js_init (int64_t version_code) {
     env->internal_flags |= jsf_abort_if_non_strict
                         |  jsf_not_constructor;
 
+    // zero is never a valid epoch, see js_shape_epoch_bump ()
+    env->shape_epoch = 1;
+
     //env->init_elapsed_time = js_elapsed_time();
 
     // initialize components
@@ -31,6 +34,7 @@ static js_environ *js_init (int64_t version_code) {
     js_str_init(env);
     js_shape_init(env);
     js_obj_init(env);
+    js_elems_init(env);
     js_descr_init(env);
     js_func_init(env);
     js_gc_init_2(env);
@@ -78,6 +82,9 @@ static void js_init3 (js_environ *env) {
     env->sym_unscopables = js_getprop(env, symbol,
             js_str_c(env, "unscopables"), &dummy_shape_cache);
 
+    env->sym_match = js_getprop(env, symbol,
+            js_str_c(env, "match"), &dummy_shape_cache);
+
     //
     // disable detection of non-strict functions
     //
@@ -153,7 +160,8 @@ static void report_unhandled_exception (
     const wchar_t *txt_ptr = L"?";
                int txt_len = 1;
 
-    if (setjmp(*js_entertry(env)) == 0) {
+    js_try try;
+    if (js_setjmp(*js_entertry(env, &try)) == 0) {
 
         // call get_exception_as_string () from error.js
         // on the thrown object, to convert it to a string.
@@ -165,16 +173,35 @@ static void report_unhandled_exception (
 
         if (js_is_primitive_string(exception)) {
 
-            const objset_id *id = js_get_pointer(exception);
+            const objset_id *id =
+                    js_get_pointer(js_str_flat(env, exception));
             txt_ptr = id->data;
             txt_len = id->len >> 1;
         }
     }
+    js_leavetry(env);
 
+    js_str_output_flush(env);
     fprintf(stderr, "\nUnhandled exception: "
                     "%*.*ls\n", txt_len, txt_len, txt_ptr);
 }
 
+// ------------------------------------------------------------
+//
+// flush_output_at_exit
+//
+// ------------------------------------------------------------
+
+static js_environ *output_env;
+
+static void flush_output_at_exit (void) {
+
+    // console output is buffered by js_str_output () in
+    // strsup.c, and must also be written if the program
+    // calls exit (), for example on a fatal error
+    js_str_output_flush(output_env);
+}
+
 // ------------------------------------------------------------
 //
 // wmain
@@ -186,11 +213,15 @@ int __stdcall wmain (int argc, wchar_t **argv) {
     // initialize
     js_environ *env = js_init(js_version_code);
 
+    output_env = env;
+    atexit(flush_output_at_exit);
+
     js_growstack(env, js_stk_top, 4);
 
     volatile js_val exit_code = js_undefined;
 
-    if (setjmp(*js_entertry(env)) == 0) {
+    js_try try;
+    if (js_setjmp(*js_entertry(env, &try)) == 0) {
 
         // initialize runtime components written in javscript,
         // in the runtime2.js module
@@ -211,6 +242,7 @@ int __stdcall wmain (int argc, wchar_t **argv) {
     if (!js_is_number(exit_code))
         exit_code = js_make_number(0.0);
 
+    js_str_output_flush(env);
     printf("\n");
     return (int)exit_code.num;
 }
@@ -1,102 +1,609 @@
 
+// map and set iterators, see map.c
+static js_val js_map_iter_next_v (js_c_func_args);
+static void js_map_iter_fast (js_environ *env, js_val *iter);
+static void js_map_iter_reuse (js_environ *env, js_val iter_val,
+                               bool reuse_pair);
+
 // ------------------------------------------------------------
 //
 // js_spreadargs
 //
 // ------------------------------------------------------------
 
-void js_spreadargs (js_environ *env, js_val iterable) {
+void js_spreadargs (js_environ *env, js_val iterable, int room) {
 
-    //
-    // fast-path if iterable is a typical fast-path array.
-    //
+    // 'room' is the number of stack links which the caller
+    // needs after the spread, see write_call_arguments ()
+    // in expression_writer.js, and which are kept free as
+    // the values are pushed, see js_growstack ()
 
-    /*if (js_is_object(iterable)) {
-
-        js_obj *obj_ptr = (js_obj *)js_get_pointer(iterable);
-        uintptr_t proto = (uintptr_t)obj_ptr->proto;
-        uint32_t length;
-        if (likely(proto == (uintptr_t)env->fast_arr_proto
-               && (-1U != (length =
-                            ((js_arr *)obj_ptr)->length)))) {
-            //
-            // push each array element from 0 to 'length'
-            //
-            js_val *values = ((js_arr *)obj_ptr)->values;
-            js_growstack(env, js_stk_top, length);
-            while (length != 0) {
-                length--;
-                js_stk_top->value = *values++;
-                js_stk_top = js_stk_top->next;
-            }
+    js_val iter[3];
+    js_newiter(env, iter, 'O', iterable);
 
-            return;
+    while (iter[0].raw) {
+
+        // the elements of a plain array are pushed in one
+        // batch, up to the first hole, see js_arr_iter_run ()
+        const js_val *src;
+        const uint32_t count = 1 + js_arr_iter_run(iter, &src);
+        js_ensure_stack_at_least(room + (int)count);
+
+        js_link *stk = js_stk_top;
+        stk->value = iter[2];
+        stk = stk->next;
+        for (uint32_t i = 1; i < count; i++) {
+            stk->value = *src++;
+            stk = stk->next;
         }
-    }*/
+        js_stk_top = stk;
 
-    //
-    // iterate the object via Symbol.iterator.  note that
-    // this is true for arrays, because the the iterator
-    // might be overridden on the array object itself, or
-    // on Array.prototype or even Object.prototype.
-    //
+        if (count > 1)
+            iter[0].num += count - 1;
+        js_nextiter1(env, iter);
+    }
+}
+
+// ------------------------------------------------------------
+//
+// js_iter_slot_holds
+//
+// returns true if an own data property of an object holds
+// the expected value.  the location of the property is kept
+// in 'slot' along with the shape of the object, so as long
+// as the object keeps its shape, the check only needs to
+// compare the value in that slot, without a lookup
+//
+// ------------------------------------------------------------
+
+static bool js_iter_slot_holds (js_environ *env,
+                                const js_obj *obj_ptr, js_val prop,
+                                js_val expected, js_iter_slot *slot) {
+
+    if (unlikely(obj_ptr->shape != slot->shape)) {
+
+        int64_t idx_or_ptr;
+        if (!js_shape_value(obj_ptr->shape,
+                            js_shape_key(env, prop), &idx_or_ptr)
+        ||  idx_or_ptr >= 0)
+            return false;
+        slot->shape = obj_ptr->shape;
+        slot->index = ~idx_or_ptr;
+    }
+
+    js_val value = obj_ptr->values[slot->index];
+    if (js_is_descriptor(value)) {
+        const js_descriptor *descr = js_get_pointer(value);
+        if (js_descr_flags_without_setter(descr) & js_descr_getter)
+            return false;
+        value = descr->data_or_getter;
+    }
+    return value.raw == expected.raw;
+}
+
+// ------------------------------------------------------------
+//
+// js_iter_pristine
+//
+// returns true if the iterable is an array without any
+// descriptors, and iterating it would call the original
+// Array.prototype[Symbol.iterator] and the original next ()
+// function of the array iterator prototype, see array.js,
+// or if the iterable is a string, and the same is true for
+// the string iterator, see string.js.  in that case, sets
+// new_iter[0] to the index of the first element, plus one,
+// and new_iter[1] to the array or the string itself, see
+// js_arr_iter_fast () and js_str_iter_fast ().
+//
+// ------------------------------------------------------------
+
+static void js_iter_get_originals (js_environ *env) {
 
     int64_t dummy_shape_cache;
-    js_val iterator = js_getprop(env, iterable,
-                                 env->sym_iterator,
-                                &dummy_shape_cache);
+    const js_val shadow_obj = env->shadow_obj;
+#define get_shadow(name) js_getprop(env, shadow_obj, \
+                js_str_c(env, name), &dummy_shape_cache)
+    env->arr_iterator = get_shadow("array_iterator");
+    env->arr_iterator_next = get_shadow("array_iterator_next");
+    env->arr_iterator_proto =
+                    get_shadow("array_iterator_prototype");
+    env->str_iterator = get_shadow("string_iterator");
+    env->str_iterator_next = get_shadow("string_iterator_next");
+    env->str_iterator_proto =
+                    get_shadow("string_iterator_prototype");
+#undef get_shadow
+}
 
-    if (js_is_object(iterator) &&
-            js_obj_is_exotic(js_get_pointer(iterator),
-                             js_obj_is_function)) {
+static bool js_iter_pristine (js_environ *env, js_val *new_iter,
+                              js_val iterable_val) {
+
+    if (unlikely(!env->arr_iterator.raw))
+        js_iter_get_originals(env);
+
+    if (js_is_object(iterable_val)) {
+
+        const js_arr *arr = js_get_pointer(iterable_val);
+        if (!env->fast_arr_proto
+        ||  arr->super.proto != env->fast_arr_proto
+        ||  arr->length == -1U)
+            return false;
+
+        // an array with other properties than its elements
+        // might have its own Symbol.iterator property
+        int64_t idx_or_ptr;
+        if (arr->super.shape != env->arr_shape
+        &&  js_shape_value(arr->super.shape,
+                           js_shape_key(env, env->sym_iterator),
+                           &idx_or_ptr) && idx_or_ptr < 0)
+            return false;
+
+        if (!js_iter_slot_holds(env, js_obj_get_proto(&arr->super),
+                                env->sym_iterator, env->arr_iterator,
+                                &env->arr_iterator_slot)
+        ||  !js_iter_slot_holds(env,
+                                js_get_pointer(env->arr_iterator_proto),
+                                env->str_next, env->arr_iterator_next,
+                                &env->arr_iterator_next_slot))
+            return false;
+
+    } else if (js_is_primitive_string(iterable_val)) {
+
+        if (!js_iter_slot_holds(env, env->str_proto,
+                                env->sym_iterator, env->str_iterator,
+                                &env->str_iterator_slot)
+        ||  !js_iter_slot_holds(env,
+                                js_get_pointer(env->str_iterator_proto),
+                                env->str_next, env->str_iterator_next,
+                                &env->str_iterator_next_slot))
+            return false;
+
+    } else
+        return false;
+
+    new_iter[0] = js_make_number(1);
+    new_iter[1] = iterable_val;
+    return true;
+}
+
+// ------------------------------------------------------------
+//
+// js_arr_iter_fast
+//
+// steps an array iterator set up by js_newiter (), where
+// iter[0] is the index of the next element, plus one, and
+// iter[1] is the array itself, rather than an iterator.
+// iter[1] may also be an array-like object, such as an
+// arguments object, whose iterator is the array iterator
+//
+// ------------------------------------------------------------
+
+static void js_arr_iter_fast (js_environ *env, js_val *iter) {
+
+    const js_arr *arr = js_get_pointer(iter[1]);
+    const uint32_t index = (uint32_t)iter[0].num - 1;
+    int64_t dummy_shape_cache;
+
+    // the length is checked on every step, as the loop
+    // may add or remove elements, or define descriptors
+    const bool is_fast =
+                js_obj_is_exotic(arr, js_obj_is_array)
+             && arr->length != -1U;
+    uint32_t length;
+    if (likely(is_fast))
+        length = arr->length;
+    else {
+        const double num = js_get_number(js_tonumber(env,
+                js_getprop(env, iter[1], env->str_length,
+                           &dummy_shape_cache)));
+        length = (num > 0) ? ((num < 4294967295.0)
+                                    ? (uint32_t)num : -1U) : 0;
+    }
+
+    if (index < length) {
+
+        js_val value = (is_fast && index < arr->capacity)
+                     ? arr->values[index] : js_deleted;
+        if (value.raw == js_deleted.raw) {
+            // a hole, or a descriptor, or a long array,
+            // or an element of an array-like object
+            value = js_getprop(env, iter[1],
+                               js_make_number(index),
+                               &dummy_shape_cache);
+        }
+
+        iter[2] = value;
+        iter[0].num += 1;
+
+    } else {
+
+        iter[2] = js_undefined;
+        iter[0].raw = 0; // terminate iteration
+    }
+}
+
+// ------------------------------------------------------------
+//
+// js_str_iter_fast
+//
+// steps a string iterator set up by js_newiter (), where
+// iter[0] is the index of the next character, plus one, and
+// iter[1] is the string itself.  like the string iterator
+// in string.js, a surrogate pair is returned as one value
+//
+// ------------------------------------------------------------
+
+static void js_str_iter_fast (js_environ *env, js_val *iter) {
+
+    const uint32_t length =
+            ((const js_rope *)js_get_pointer(iter[1]))->len >> 1;
+    const uint32_t index = (uint32_t)iter[0].num - 1;
+
+    if (index < length) {
+
+        const wchar_t *data = js_str_data(env, iter[1]);
+        uint32_t num_chars = 1;
+        if (data[index] >= 0xD800 && data[index] <= 0xDBFF
+        &&  index + 1 < length
+        &&  data[index + 1] >= 0xDC00 && data[index + 1] <= 0xDFFF)
+            num_chars = 2;
+
+        iter[2] = js_str_sub(env, iter[1], index, num_chars);
+        iter[0].num += num_chars;
+
+    } else {
+
+        iter[2] = js_undefined;
+        iter[0].raw = 0; // terminate iteration
+    }
+}
+
+// ------------------------------------------------------------
+//
+// for-in iterator
+//
+// js_newiter () sets iter[1] to a private object which points
+// to a js_forin structure, and iter[0] to a negative number,
+// which is minus one, less the position of the next key.
+// in the common case, the object has no integer keys, except
+// for the elements of an array, and its prototype chain has
+// no enumerable properties at all, so the keys are read from
+// the list which is cached in the shape of the object, see
+// js_shape_get_keys ().  otherwise, the keys of the object
+// and of its prototypes are collected when the loop begins.
+// either way, a key is skipped if its property is deleted
+// before it is reached, and keys added during the loop are
+// not visited, as permitted by the spec.
+//
+// ------------------------------------------------------------
+
+typedef struct js_forin {
+
+    js_val obj;
+    js_val keys;    // array of collected keys, or zero
+    const js_shape_keys *shape_keys; // if keys is zero
+    uint32_t length; // number of array elements, or keys
+
+} js_forin;
+
+#define js_forin_kind ((js_val){ .raw = 0x466F4900 /* FoI0 */ })
+
+// ------------------------------------------------------------
+//
+// js_forin_gc_callback
+//
+// ------------------------------------------------------------
+
+static void js_forin_gc_callback (
+                js_gc_env *gc, js_priv *priv, int why) {
+
+    js_forin *forin = priv->val_or_ptr.ptr;
+
+    if (why == 0) {
+        // if notified about collection, free iterator
+        js_free(forin);
+        return;
+    }
 
-        iterator = js_callfunc1(env, iterator,
-                                iterable, js_undefined);
-        if (js_is_object(iterator)) {
+    js_gc_mark_val(gc, forin->obj);
+    if (forin->keys.raw)
+        js_gc_mark_val(gc, forin->keys);
+}
 
-            js_val next = js_getprop(env, iterator,
-                                     env->str_next,
-                                    &dummy_shape_cache);
+// ------------------------------------------------------------
+//
+// js_forin_is_plain
+//
+// returns true if neither the object, nor any object on its
+// prototype chain, is a proxy or has integer keys, except
+// for the elements of the object itself, if it is an array,
+// and if no prototype has any enumerable property
+//
+// ------------------------------------------------------------
 
-            if (js_is_object(next) &&
-                js_obj_is_exotic(js_get_pointer(next),
-                                    js_obj_is_function)) {
+static bool js_forin_is_plain (
+                js_environ *env, const js_obj *obj_ptr) {
 
-                //
-                // an iterator function returned an iterable
-                // object with a next () function, so keep
-                // calling this function, and pushing its
-                // result 'value' into the stack, until it
-                // returns a result with 'done' set to true
-                //
+    const int exotic_type = (uintptr_t)obj_ptr->proto & 7;
+    if (exotic_type == js_obj_is_proxy
+    || (exotic_type != js_obj_is_array
+                        && js_elems_of(env, obj_ptr)))
+        return false;
 
-                for (;;) {
+    for (;;) {
 
-                    js_val result = js_callfunc1(
-                        env, next, iterator, js_undefined);
+        obj_ptr = (js_obj *)((uintptr_t)obj_ptr->proto & ~7);
+        if (!obj_ptr)
+            return true;
 
-                    if (!js_is_object(result))
-                        js_callthrow("TypeError_iterator_result");
+        const int exotic_type = (uintptr_t)obj_ptr->proto & 7;
+        if (exotic_type == js_obj_is_proxy)
+            return false;
+        if (exotic_type == js_obj_is_array) {
+            if ((uint32_t)((const js_arr *)obj_ptr)
+                                    ->length_descr[0].num)
+                return false;
+        } else if (js_elems_of(env, obj_ptr))
+            return false;
 
-                    if (js_is_truthy(js_getprop(
-                                    env, result, env->str_done,
-                                   &dummy_shape_cache)))
-                        return;
+        const js_shape_keys *keys =
+                        js_shape_get_keys(obj_ptr->shape);
+        for (uint32_t i = 0; i < keys->count; i++) {
+            if (js_obj_is_enum_value(
+                        obj_ptr->values[keys->keys[i].index]))
+                return false;
+        }
+    }
+}
 
-                    js_stk_top->value = js_getprop(
-                                    env, result, env->str_value,
-                                   &dummy_shape_cache);
-                    js_stk_top = js_stk_top->next;
-                }
+// ------------------------------------------------------------
+//
+// js_forin_collect
+//
+// collects the enumerable keys of an object, or primitive,
+// and of its prototype chain, into an array.  a key which
+// was already seen on an earlier object is skipped, even if
+// that property was not enumerable.  index keys are tracked
+// by their number, with the top bit set, string keys by the
+// pointer to the interned string.
+//
+// ------------------------------------------------------------
+
+static void js_forin_add (js_environ *env, intmap **seen,
+                          js_val keys, uint32_t *count,
+                          uint64_t id, js_val key, js_val val) {
+
+    bool was_added;
+    if (val.raw == js_deleted.raw
+    ||  !intmap_set_or_add(seen, id, 0, &was_added))
+        return;
+    if (was_added && js_obj_is_enum_value(val)) {
+        // the gc may have already scanned the array,
+        // and a new index string is not interned,
+        // see also js_setprop ()
+        if (js_is_number(key)) {
+            key = js_num_tostring(env, key, 10);
+            js_gc_notify(env, key);
+        }
+        js_arr_set(env, keys, ++*count, key);
+    }
+}
+
+static uint32_t js_forin_collect (
+                js_environ *env, js_val keys, js_val obj_val) {
+
+    intmap *seen = js_check_alloc(intmap_create());
+    uint32_t count = 0;
+    const js_obj *obj_ptr;
+
+    if (js_is_object(obj_val))
+        obj_ptr = js_get_pointer(obj_val);
+    else {
+        // a string has an enumerable property for each
+        // character, which no prototype can shadow
+        if (js_is_primitive_string(obj_val)) {
+            const uint32_t length =
+                ((objset_id *)js_get_pointer(obj_val))->len >> 1;
+            for (uint32_t index = 0; index < length; index++) {
+                js_forin_add(env, &seen, keys, &count,
+                             (1ULL << 63) | index,
+                             js_make_number(index), js_true);
             }
         }
+        obj_ptr = js_get_primitive_proto(env, obj_val);
     }
 
-    //
-    //
-    //
+    for (; obj_ptr; obj_ptr =
+                (js_obj *)((uintptr_t)obj_ptr->proto & ~7)) {
 
-    js_callthrow("TypeError_not_iterable");
+        const int exotic_type = (uintptr_t)obj_ptr->proto & 7;
+        if (exotic_type == js_obj_is_proxy)
+            continue;
+
+        if (exotic_type == js_obj_is_array) {
+
+            const js_arr *arr = (const js_arr *)obj_ptr;
+            for (uint32_t index = 0;
+                    index < (uint32_t)arr->length_descr[0].num
+                 && index < arr->capacity; index++) {
+                js_forin_add(env, &seen, keys, &count,
+                             (1ULL << 63) | index,
+                             js_make_number(index),
+                             arr->values[index]);
+            }
+
+        } else {
+
+            uint32_t *indexes;
+            const uint32_t num_indexes =
+                    js_elems_indexes(env, obj_ptr, &indexes);
+            for (uint32_t i = 0; i < num_indexes; i++) {
+                js_forin_add(env, &seen, keys, &count,
+                             (1ULL << 63) | indexes[i],
+                             js_make_number(indexes[i]),
+                             js_elems_get(env, obj_ptr,
+                                          indexes[i] + 1));
+            }
+            if (indexes)
+                js_free(indexes);
+        }
+
+        const js_shape_keys *shape_keys =
+                        js_shape_get_keys(obj_ptr->shape);
+        for (uint32_t i = 0; i < shape_keys->count; i++) {
+            const struct js_shape_key *key =
+                                &shape_keys->keys[i];
+            js_forin_add(env, &seen, keys, &count,
+                         (uint64_t)js_get_pointer(key->key),
+                         key->key, obj_ptr->values[key->index]);
+        }
+    }
+
+    intmap_destroy(seen);
+    return count;
+}
+
+// ------------------------------------------------------------
+//
+// js_forin_step
+//
+// ------------------------------------------------------------
+
+static void js_forin_step (js_environ *env, js_val *iter) {
+
+    const js_forin *forin =
+        ((js_priv *)js_get_pointer(iter[1]))->val_or_ptr.ptr;
+    uint32_t pos = (uint32_t)-iter[0].num - 1;
+
+    if (forin->keys.raw) {
+
+        // keys collected by js_forin_collect (), which are
+        // checked again, in case the property was deleted
+        while (pos < forin->length) {
+            const js_val key = js_arr_get(forin->keys, ++pos);
+            if (!js_is_object(forin->obj)
+            ||  js_hasprop(env, forin->obj, key)) {
+                iter[2] = key;
+                iter[0].num = -(double)pos - 1;
+                return;
+            }
+        }
+
+    } else {
+
+        const js_obj *obj_ptr = js_get_pointer(forin->obj);
+
+        // the elements of an array come first.  the length
+        // is checked on every step, as the loop may add or
+        // remove elements, or define descriptors
+        while (pos < forin->length) {
+            const js_arr *arr = (const js_arr *)obj_ptr;
+            const uint32_t index = pos++;
+            if (index < (uint32_t)arr->length_descr[0].num
+            &&  index < arr->capacity
+            &&  js_obj_is_enum_value(arr->values[index])) {
+                iter[2] = js_num_tostring(
+                            env, js_make_number(index), 10);
+                iter[0].num = -(double)pos - 1;
+                return;
+            }
+        }
+
+        // then the keys cached in the initial shape, whose
+        // values are never moved, even if the object later
+        // switches to a shape with more properties
+        const js_shape_keys *shape_keys = forin->shape_keys;
+        while (pos - forin->length < shape_keys->count) {
+            const struct js_shape_key *key =
+                    &shape_keys->keys[pos++ - forin->length];
+            if (js_obj_is_enum_value(obj_ptr->values[key->index])) {
+                iter[2] = key->key;
+                iter[0].num = -(double)pos - 1;
+                return;
+            }
+        }
+    }
+
+    iter[2] = js_undefined;
+    iter[0].raw = 0; // terminate iteration
+}
+
+// ------------------------------------------------------------
+//
+// js_forin_new
+//
+// ------------------------------------------------------------
+
+static void js_forin_new (js_environ *env, js_val *new_iter,
+                          js_val obj_val) {
+
+    // per the spec, for-in over null or undefined
+    // does not throw, and does not run the loop
+    if (js_is_undefined_or_null(obj_val))
+        return;
+
+    js_forin *forin = js_malloc(sizeof(js_forin));
+    forin->obj = obj_val;
+    forin->keys.raw = 0;
+    forin->shape_keys = NULL;
+    forin->length = 0;
+
+    js_priv *priv = js_newprivobj(env, js_forin_kind);
+    priv->val_or_ptr.ptr = forin;
+    priv->gc_callback = js_forin_gc_callback;
+    new_iter[1] = js_gc_manage(env, js_make_object(priv));
+
+    const js_obj *obj_ptr;
+    if (js_is_object(obj_val)
+    &&  js_forin_is_plain(env,
+                obj_ptr = js_get_pointer(obj_val))) {
+
+        if (js_obj_is_exotic(obj_ptr, js_obj_is_array)) {
+            forin->length = (uint32_t)
+                ((const js_arr *)obj_ptr)->length_descr[0].num;
+        }
+        forin->shape_keys = js_shape_get_keys(obj_ptr->shape);
+
+    } else {
+
+        js_val keys = js_newarr(env, 0);
+        forin->keys = keys;
+        js_gc_notify(env, keys);
+        forin->length = js_forin_collect(env, keys, obj_val);
+    }
+
+    if (js_is_object(obj_val))
+        js_gc_notify(env, obj_val);
+    new_iter[0] = js_make_number(-1);
+    js_forin_step(env, new_iter);
+}
+
+// ------------------------------------------------------------
+//
+// js_arr_iter_unmodified
+//
+// returns true if Array.prototype[Symbol.iterator] and the
+// next () function of the array iterator prototype are the
+// original functions, so destructuring a new array literal
+// may skip the iterator, see array_pattern_literal () in
+// expression_writer.js, and also js_iter_pristine ()
+//
+// ------------------------------------------------------------
+
+bool js_arr_iter_unmodified (js_environ *env) {
+
+    if (unlikely(!env->arr_iterator.raw))
+        js_iter_get_originals(env);
+
+    // note that arr_proto is tagged, see js_arr_init ()
+    const js_obj *arr_proto =
+                (js_obj *)((uintptr_t)env->arr_proto & ~7);
+    return js_iter_slot_holds(env, arr_proto,
+                              env->sym_iterator, env->arr_iterator,
+                              &env->arr_iterator_slot)
+        && js_iter_slot_holds(env,
+                              js_get_pointer(env->arr_iterator_proto),
+                              env->str_next, env->arr_iterator_next,
+                              &env->arr_iterator_next_slot);
 }
 
 // ------------------------------------------------------------
@@ -111,6 +618,18 @@ void js_spreadargs (js_environ *env, js_val iterable) {
 // new_iter[1] is a reference to the iterator object;
 // new_iter[2] receives the next result value, if not done.
 //
+// parameter 'kind' is 'I' for for-in, or 'O' for for-of, or
+// 'P' for for-of where the loop variable is an array pattern,
+// and each result value is only ever destructured.
+//
+// if the iterable is a plain array, or a string, new_iter[0]
+// is a number instead of a function, see js_iter_pristine (),
+// and it is a negative number for a for-in loop, see
+// js_forin_new ().  note that
+// js_nextiter1 () also recognizes a map or set iterator, see
+// js_map_iter_fast () in map.c.  in both cases, the iteration
+// does not create a result object for each step.
+//
 // ------------------------------------------------------------
 
 void js_newiter (js_environ *env, js_val *new_iter,
@@ -124,29 +643,24 @@ void js_newiter (js_environ *env, js_val *new_iter,
     if (kind == 'I') {
 
         //
-        // for-in iterator
+        // for-in iterator, see js_forin_new ()
         //
-        // locate the _shadow.for_in_iterator function,
-        // provided by runtime2.js
-        if (!env->for_in_iterator.raw) {
-            env->for_in_iterator = js_getprop(
-                            env, env->shadow_obj,
-                            js_str_c(env, "for_in_iterator"),
-                            &dummy_shape_cache);
-        }
-
-        // the for_in_iterator () function creates an iterator
-        // which enumerates the keys of the specifieid object
-        new_iter[1] = js_callfunc1(env, env->for_in_iterator,
-                                   js_undefined, iterable_val);
+        js_forin_new(env, new_iter, iterable_val);
+        return;
 
     } else {
 
         //
         // for-of iterator
         //
-        // invoke [Symbol.iterator] on the specified object
+        // an array or a string with the original iterator
+        // is stepped in place, without calling anything
+        if (js_iter_pristine(env, new_iter, iterable_val)) {
+            js_nextiter1(env, new_iter);
+            return;
+        }
 
+        // otherwise invoke [Symbol.iterator] on the object
         js_val method = js_getprop(env, iterable_val,
                                    env->sym_iterator,
                                   &dummy_shape_cache);
@@ -155,6 +669,22 @@ void js_newiter (js_environ *env, js_val *new_iter,
         &&  js_obj_is_exotic(js_get_pointer(method),
                              js_obj_is_function)) {
 
+            // an array-like object, such as 'arguments', with
+            // the original array iterator, is stepped in place
+            // as well, see js_arr_iter_fast ()
+            if (method.raw == env->arr_iterator.raw
+            &&  js_is_object(iterable_val)
+            &&  js_iter_slot_holds(env,
+                        js_get_pointer(env->arr_iterator_proto),
+                        env->str_next, env->arr_iterator_next,
+                        &env->arr_iterator_next_slot)) {
+
+                new_iter[0] = js_make_number(1);
+                new_iter[1] = iterable_val;
+                js_nextiter1(env, new_iter);
+                return;
+            }
+
             new_iter[1] = js_callfunc1(
                             env, method, iterable_val,
                             js_undefined);
@@ -182,6 +712,11 @@ void js_newiter (js_environ *env, js_val *new_iter,
                              js_obj_is_function)) {
 
             new_iter[0] = method;
+            if (((js_func *)js_get_pointer(method))->c_func
+                                    == js_map_iter_next_v) {
+                js_map_iter_reuse(
+                        env, new_iter[1], kind == 'P');
+            }
             js_nextiter1(env, new_iter);
             return;
         }
@@ -243,6 +778,22 @@ static void js_checkiter (js_environ *env, js_val *iter,
 
 void js_nextiter1 (js_environ *env, js_val *iter) {
 
+    if (js_is_number(iter[0])) {
+        if (iter[0].num < 0)
+            js_forin_step(env, iter);
+        else if (js_is_object(iter[1]))
+            js_arr_iter_fast(env, iter);
+        else
+            js_str_iter_fast(env, iter);
+        return;
+    }
+
+    if (((js_func *)js_get_pointer(iter[0]))->c_func
+                                == js_map_iter_next_v) {
+        js_map_iter_fast(env, iter);
+        return;
+    }
+
     js_val result = js_callfunc1(
                         env, /* next () func */ iter[0],
                         /* this */ iter[1], js_undefined);
@@ -295,6 +846,21 @@ bool js_nextiter2 (js_environ *env, js_val *iter,
     int64_t dummy_shape_cache;
     js_val func;
 
+    if (js_is_number(iter[0])) {
+        // iterating a plain array or a string, see
+        // js_newiter (), so there is no iterator object,
+        // and the iterator does not have return () or throw ()
+        if (cmd == 0) {
+            js_nextiter1(env, iter);
+            return true;
+        }
+        if (cmd > 0)
+            return false;
+        js_callshadow(
+                env, "TypeError_iterator_cannot_call",
+                env->str_throw);
+    }
+
     if (cmd < 0) {
         //
         // request to call throw () on the iterator
@@ -77,26 +77,12 @@ defineNotEnum(Array_prototype, 'push', function push (...elements) {
 // join
 //
 
-defineNotEnum(Array_prototype, 'join', function join (sep) {
+const _join = _shadow.str_sup.join;
 
-    const arr = check_obj_arg(this);
-    let len = +this.length;
-    if (!(len >= 0)) // if NaN or negative number
-        len = 0;
+defineNotEnum(Array_prototype, 'join', function join (sep) {
 
-    sep = (sep === undefined) ? ',' : ('' + sep);
-    let sep1 = '';
-
-    let str = '';
-    let idx = 0;
-    while (idx < len) {
-        str += sep1;
-        sep1 = sep;
-        const e = arr[idx++];
-        str += (e === undefined || e === null)
-            ? '' : ('' + e);
-    }
-    return str;
+    // see js_str_join () in strsup.c
+    return _join.call(check_obj_arg(this), sep);
 });
 
 //
@@ -176,4 +162,10 @@ function iterator_next () {
 overrideFunctionName(iterator, _shadow.this_iterator[Symbol.iterator].name);
 overrideFunctionName(iterator_next, 'next');
 
+// while these are not modified, js_newiter () in iter.c
+// can iterate an array without creating an iterator
+_shadow.array_iterator = iterator;
+_shadow.array_iterator_next = iterator_next;
+_shadow.array_iterator_prototype = iterator_prototype;
+
 })()    // Array_init
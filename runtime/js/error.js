@@ -308,6 +308,17 @@ _shadow.TypeError_incompatible_object = function throw_TypeError (expectedType)
     throw TypeError('Incompatible object' + expectedType);
 }
 
+_shadow.TypeError_regexp_argument = function throw_TypeError (funcName) {
+
+    throw TypeError('First argument to String.prototype.' + funcName
+                  + ' must not be a regular expression');
+}
+
+_shadow.TypeError_invalid_weak_key = function throw_TypeError () {
+
+    throw TypeError('Invalid value used as weak key');
+}
+
 _shadow.TypeError_mix_types_in_arithmetic = function throw_TypeError () {
 
     throw TypeError('Cannot mix incompatible types in arithmetic');
@@ -364,6 +375,11 @@ _shadow.RangeError_property_count = function throw_RangeError () {
     throw RangeError('Too many properties');
 }
 
+_shadow.RangeError_string_length = function throw_RangeError () {
+
+    throw RangeError('Invalid string length');
+}
+
 _shadow.SyntaxError_invalid_argument = function throw_SyntaxError () {
 
     throw SyntaxError('Invalid argument');
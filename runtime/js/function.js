@@ -164,6 +164,15 @@ _shadow.CoroutineFunction = function CoroutineFunction (kind) {
     // this function is called by js_newcoroutine ()
     // in coroutine.c, as result of code injected by
     // convert_to_coroutine () in function_writer.js.
+    // kind 6 is a generator which was compiled as a
+    // state machine, rather than to run in a separate
+    // context, see also generator_scanner.js
+
+    let init_cmd = 0x49; // I
+    if (kind === 6) {
+        init_cmd = 0x53; // S
+        kind = 2;
+    }
 
     if (kind === 2)
         kind = Generator;
@@ -181,7 +190,7 @@ _shadow.CoroutineFunction = function CoroutineFunction (kind) {
         // function which, when called, actually creates
         // an instance of the generator.
         const generator = js_coroutine(
-                        0x49 /* I */, wrapped, this);
+                        init_cmd, wrapped, this);
         js_getOrSetPrototype(generator, wrapper_proto);
         return generator;
     }
@@ -10,6 +10,26 @@
 // the js_map_util () function from map.c
 const js_map_util = _shadow.js_map_util;
 
+// the methods implemented in C, see js_map_method ()
+const map_sup = _shadow.map_sup;
+
+const map_get = map_sup.map_get;
+const map_set = map_sup.map_set;
+const map_has = map_sup.map_has;
+const map_del = map_sup.map_delete;
+const map_clr = map_sup.map_clear;
+const map_siz = map_sup.map_size;
+
+const set_has = map_sup.set_has;
+const set_add = map_sup.set_add;
+const set_del = map_sup.set_delete;
+const set_clr = map_sup.set_clear;
+const set_siz = map_sup.set_size;
+
+// the iterators implemented in C, see js_map_iter_create_v ()
+const map_itr = map_sup.iterator;
+const map_ent = map_sup.iter_entry;
+
 // ------------------------------------------------------------
 //
 // Map constructor
@@ -76,51 +96,27 @@ defineNotEnum(Map_prototype, _Symbol.iterator, map_entries);
 //
 // ------------------------------------------------------------
 
-const map_iterator_symbol = _Symbol('map_iterator');
 const map_iterator_prototype = { __proto__: _shadow.this_iterator };
-defineNotEnum(map_iterator_prototype, 'next', function next () {
-    return map_or_set_iterator_next(
-            js_private_object(this, map_iterator_symbol));
-});
+defineNotEnum(map_iterator_prototype, 'next', map_sup.iter_next);
 defineConfig(map_iterator_prototype, _Symbol.toStringTag, 'Map Iterator');
 
 function map_entries () {
-    js_map_util(0x4E31 /* N1 */, this); // type check
-    const iterator_object =
-                create_map_or_set_iterator(
-                    map_iterator_symbol, this,
-                    0x4931 /* I1 */);
-    iterator_object.__proto__ = map_iterator_prototype;
-    return iterator_object;
+    return map_itr(this, 0x4531 /* E1 */, map_iterator_prototype);
 }
 
 function map_keys () {
-    const iterator_object = map_entries.call(this);
-    const ctx = js_private_object(
-                    iterator_object, map_iterator_symbol);
-    ctx[4] = 1; // value is just key
-    return iterator_object;
+    return map_itr(this, 0x4B31 /* K1 */, map_iterator_prototype);
 }
 
 function map_values () {
-    const iterator_object = map_entries.call(this);
-    const ctx = js_private_object(
-                    iterator_object, map_iterator_symbol);
-    ctx[4] = 2; // value is just value
-    return iterator_object;
+    return map_itr(this, 0x5631 /* V1 */, map_iterator_prototype);
 }
 
 function map_foreach (callbackFn, thisArg) {
-    const iterator_object = map_entries.call(this);
-    const ctx = js_private_object(
-                    iterator_object, map_iterator_symbol);
-    ctx[4] = 0; // don't return value
-    for (;;) {
-        map_or_set_iterator_next(ctx);
-        if (ctx[0] < 0)
-            break;
-        callbackFn.call(thisArg, ctx[2], ctx[1], this);
-    }
+    const iterator_object = map_itr(this, 0x4531 /* E1 */);
+    const entry = [ undefined, undefined ];
+    while (map_ent(iterator_object, entry))
+        callbackFn.call(thisArg, entry[1], entry[0], this);
 }
 
 overrideFunctionName(map_entries, 'entries');
@@ -128,44 +124,6 @@ overrideFunctionName(map_keys,    'keys');
 overrideFunctionName(map_values,  'values');
 overrideFunctionName(map_foreach, 'foreach');
 
-// ------------------------------------------------------------
-//
-// Map non-iterator functions
-//
-// ------------------------------------------------------------
-
-function map_get (key) {
-    return js_map_util(0x4731 /* G1 */, this, key);
-}
-
-function map_set (key, val) {
-    js_map_util(0x5331 /* S1 */, this, key, val);
-    return this;
-}
-
-function map_has (key) {
-    return js_map_util(0x4631 /* H1 */, this, key);
-}
-
-function map_del (key) {
-    return js_map_util(0x5231 /* R */, this, key);
-}
-
-function map_clr () {
-    js_map_util(0x4531 /* E */, this);
-}
-
-function map_siz () {
-    return js_map_util(0x4E31 /* N */, this);
-}
-
-overrideFunctionName(map_get, 'get');
-overrideFunctionName(map_set, 'set');
-overrideFunctionName(map_has, 'has');
-overrideFunctionName(map_del, 'delete');
-overrideFunctionName(map_clr, 'clear');
-overrideFunctionName(map_siz, 'get size');
-
 // ------------------------------------------------------------
 //
 // Set constructor
@@ -231,51 +189,29 @@ defineNotEnum(Set_prototype, _Symbol.iterator, set_values);
 //
 // ------------------------------------------------------------
 
-const set_iterator_symbol = _Symbol('set_iterator');
 const set_iterator_prototype = { __proto__: _shadow.this_iterator };
-defineNotEnum(set_iterator_prototype, 'next', function next () {
-    return map_or_set_iterator_next(
-            js_private_object(this, set_iterator_symbol));
-});
+defineNotEnum(set_iterator_prototype, 'next', map_sup.iter_next);
 defineConfig(set_iterator_prototype, _Symbol.toStringTag, 'Set Iterator');
 
+// the value of a set element is the element itself,
+// see js_map_method (), so entries () returns pairs
 function set_entries () {
-    js_map_util(0x4E32 /* N2 */, this); // type check
-    const iterator_object =
-                create_map_or_set_iterator(
-                    set_iterator_symbol, this,
-                    0x4932 /* I2 */);
-    iterator_object.__proto__ = set_iterator_prototype;
-    return iterator_object;
+    return map_itr(this, 0x4532 /* E2 */, set_iterator_prototype);
 }
 
 function set_keys () {
-    const iterator_object = set_entries.call(this);
-    const ctx = js_private_object(
-                    iterator_object, set_iterator_symbol);
-    ctx[4] = 1; // value is just key
-    return iterator_object;
+    return map_itr(this, 0x4B32 /* K2 */, set_iterator_prototype);
 }
 
 function set_values () {
-    const iterator_object = set_entries.call(this);
-    const ctx = js_private_object(
-                    iterator_object, set_iterator_symbol);
-    ctx[4] = 1; // value is just value
-    return iterator_object;
+    return map_itr(this, 0x4B32 /* K2 */, set_iterator_prototype);
 }
 
 function set_foreach (callbackFn, thisArg) {
-    const iterator_object = set_entries.call(this);
-    const ctx = js_private_object(
-                    iterator_object, set_iterator_symbol);
-    ctx[4] = 0; // don't return value
-    for (;;) {
-        map_or_set_iterator_next(ctx);
-        if (ctx[0] < 0)
-            break;
-        callbackFn.call(thisArg, ctx[2], ctx[1], this);
-    }
+    const iterator_object = map_itr(this, 0x4532 /* E2 */);
+    const entry = [ undefined, undefined ];
+    while (map_ent(iterator_object, entry))
+        callbackFn.call(thisArg, entry[1], entry[0], this);
 }
 
 overrideFunctionName(set_entries, 'entries');
@@ -285,97 +221,254 @@ overrideFunctionName(set_foreach, 'foreach');
 
 // ------------------------------------------------------------
 //
-// Map non-iterator functions
+// WeakMap and WeakSet
+//
+// the keys are objects, which the collection does not keep
+// alive.  see js_map_weak_mark () and js_map_weak_purge ()
 //
 // ------------------------------------------------------------
 
-function set_has (key) {
-    return js_map_util(0x4632 /* H2 */, this, key);
-}
+const WeakMap = function WeakMap (iterable) {
 
-function set_add (key) {
-    js_map_util(0x5332 /* S2 */, this, key, 0);
-    return this;
+    if (!new.target)
+        _shadow.TypeError_constructor_requires_new('WeakMap');
+    const map = js_map_util(0x4333 /* C3 */,
+                            WeakMap.prototype);
+    if (iterable === undefined || iterable === null)
+        return map;
+    for (const entries of iterable)
+        map.set(entries[0], entries[1]);
+    return map;
 }
 
-function set_del (key) {
-    return js_map_util(0x5232 /* R2 */, this, key);
-}
+defineProperty(WeakMap, 'length', { value: 0 });
+
+_shadow.js_flag_as_constructor(WeakMap);
+
+defineNotEnum(_global, 'WeakMap', WeakMap);
 
-function set_clr () {
-    js_map_util(0x4532 /* E2 */, this);
+const WeakMap_prototype = {};
+defineProperty(WeakMap, 'prototype', { value: WeakMap_prototype });
+
+defineNotEnum(WeakMap_prototype, 'get',     map_sup.weakmap_get);
+defineNotEnum(WeakMap_prototype, 'set',     map_sup.weakmap_set);
+defineNotEnum(WeakMap_prototype, 'has',     map_sup.weakmap_has);
+defineNotEnum(WeakMap_prototype, 'delete',  map_sup.weakmap_delete);
+defineConfig(WeakMap_prototype,  _Symbol.toStringTag, 'WeakMap');
+
+const WeakSet = function WeakSet (iterable) {
+
+    if (!new.target)
+        _shadow.TypeError_constructor_requires_new('WeakSet');
+    const set = js_map_util(0x4334 /* C4 */,
+                            WeakSet.prototype);
+    if (iterable === undefined || iterable === null)
+        return set;
+    for (const key of iterable)
+        set.add(key);
+    return set;
 }
 
-function set_siz () {
-    return js_map_util(0x4E32 /* N2 */, this);
+defineProperty(WeakSet, 'length', { value: 0 });
+
+_shadow.js_flag_as_constructor(WeakSet);
+
+defineNotEnum(_global, 'WeakSet', WeakSet);
+
+const WeakSet_prototype = {};
+defineProperty(WeakSet, 'prototype', { value: WeakSet_prototype });
+
+defineNotEnum(WeakSet_prototype, 'add',     map_sup.weakset_add);
+defineNotEnum(WeakSet_prototype, 'has',     map_sup.weakset_has);
+defineNotEnum(WeakSet_prototype, 'delete',  map_sup.weakset_delete);
+defineConfig(WeakSet_prototype,  _Symbol.toStringTag, 'WeakSet');
+
+// ------------------------------------------------------------
+//
+// WeakRef
+//
+// a weak collection with a single key, the target
+//
+// ------------------------------------------------------------
+
+const weakref_init = map_sup.weakref_init;
+
+const WeakRef = function WeakRef (target) {
+
+    if (!new.target)
+        _shadow.TypeError_constructor_requires_new('WeakRef');
+    const ref = js_map_util(0x4335 /* C5 */,
+                            WeakRef.prototype);
+    weakref_init.call(ref, target);
+    return ref;
 }
 
-overrideFunctionName(set_has, 'has');
-overrideFunctionName(set_add, 'add');
-overrideFunctionName(set_del, 'delete');
-overrideFunctionName(set_clr, 'clear');
-overrideFunctionName(set_siz, 'get size');
+_shadow.js_flag_as_constructor(WeakRef);
+
+defineNotEnum(_global, 'WeakRef', WeakRef);
+
+const WeakRef_prototype = {};
+defineProperty(WeakRef, 'prototype', { value: WeakRef_prototype });
+
+defineNotEnum(WeakRef_prototype, 'deref',   map_sup.weakref_deref);
+defineConfig(WeakRef_prototype,  _Symbol.toStringTag, 'WeakRef');
 
 // ------------------------------------------------------------
 //
-// Iterator
+// FinalizationRegistry
+//
+// a weak collection which maps each target to an array of
+// cells, one for each registration, and each cell holds the
+// held value, and a flag that is cleared once the cell is
+// unregistered or cleaned up.  when a target is collected,
+// its cells become pending, see js_map_weak_purge (), and
+// are taken by cleanupSome ().
+//
+// there is no job queue in which to call the callbacks, so
+// they are called by cleanupSome (), and after each call to
+// gc (), see utils.js.  a registry is kept alive while it
+// has any registered targets, so its callback can be called
 //
 // ------------------------------------------------------------
 
-function create_map_or_set_iterator (
-            type_symbol, map_or_set_obj, map_or_set_cmd) {
-
-    const ctx = [];
-    const iterator_object =
-            js_private_object(type_symbol, ctx);
-    // ctx[0] is internal iteration index,
-    // which is set to -1 when iteration is done
-    //
-    // after each iteration:
-    // ctx[1] receives the iteration key
-    // ctx[2] receives the iteration value
-    //
-    // ctx[3] is a reference to the map object
-    // ctx[4] determines the result value:
-    //       <= 0 to do nothing
-    //          1 for just key
-    //          2 for just value
-    //          3 for [ key, value ]
-    //
-    // ctx[5] is the 'I0' .. 'I3' command
-    ctx[0] = 0;
-    ctx[3] = map_or_set_obj;
-    ctx[4] = 3; // default to [ key, value ]
-    ctx[5] = map_or_set_cmd;
-    return iterator_object;
+const finreg_get  = map_sup.finreg_get;
+const finreg_set  = map_sup.finreg_set;
+const finreg_take = map_sup.finreg_take;
+const finreg_size = map_sup.finreg_size;
+
+// the callback and unregister tokens of each registry
+const finreg_state = new WeakMap();
+
+// the registries which have any registered targets
+const finreg_active = new Set();
+
+function finreg_this (registry) {
+
+    const state = finreg_state.get(registry);
+    if (!state) {
+        _shadow.TypeError_incompatible_object(
+                                'FinalizationRegistry');
+    }
+    return state;
+}
+
+function is_weak_key (v) {
+
+    // see also js_map_can_be_weak_key () in map.c
+    return (typeof v === 'object' && v !== null)
+        ||  typeof v === 'function'
+        ||  (typeof v === 'symbol' && _Symbol.keyFor(v) === undefined);
 }
 
-function map_or_set_iterator_next (ctx) {
+const FinalizationRegistry =
+                function FinalizationRegistry (cleanupCallback) {
 
-    if (ctx[0] >= 0) {
-        if (!js_map_util(ctx[5], ctx[3], ctx))
-            ctx[0] = -1;
+    if (!new.target) {
+        _shadow.TypeError_constructor_requires_new(
+                                'FinalizationRegistry');
     }
+    if (typeof cleanupCallback !== 'function')
+        _shadow.TypeError_expected_function();
+    const registry = js_map_util(0x4336 /* C6 */,
+                                 FinalizationRegistry.prototype);
+    finreg_state.set(registry, [ cleanupCallback, new WeakMap() ]);
+    return registry;
+}
+
+_shadow.js_flag_as_constructor(FinalizationRegistry);
+
+defineNotEnum(_global, 'FinalizationRegistry', FinalizationRegistry);
+
+const FinalizationRegistry_prototype = {};
+defineProperty(FinalizationRegistry, 'prototype',
+                { value: FinalizationRegistry_prototype });
+
+defineNotEnum(FinalizationRegistry_prototype, 'register',    finreg_register);
+defineNotEnum(FinalizationRegistry_prototype, 'unregister',  finreg_unregister);
+defineNotEnum(FinalizationRegistry_prototype, 'cleanupSome', finreg_cleanup);
+defineConfig(FinalizationRegistry_prototype,
+             _Symbol.toStringTag, 'FinalizationRegistry');
+
+function finreg_register (target, heldValue, unregisterToken) {
+
+    const state = finreg_this(this);
+    if (!is_weak_key(target) || (unregisterToken !== undefined
+                             && !is_weak_key(unregisterToken)))
+        _shadow.TypeError_invalid_weak_key();
+    if (target === heldValue)
+        _shadow.TypeError_invalid_argument();
+
+    const cell = [ heldValue, true ];
+    const cells = finreg_get.call(this, target);
+    if (cells)
+        cells.push(cell);
+    else
+        finreg_set.call(this, target, [ cell ]);
+
+    if (unregisterToken !== undefined) {
+        const tokens = state[1];
+        const token_cells = tokens.get(unregisterToken);
+        if (token_cells)
+            token_cells.push(cell);
+        else
+            tokens.set(unregisterToken, [ cell ]);
+    }
+
+    finreg_active.add(this);
+}
+
+function finreg_unregister (unregisterToken) {
+
+    const state = finreg_this(this);
+    if (!is_weak_key(unregisterToken))
+        _shadow.TypeError_invalid_weak_key();
+
+    const token_cells = state[1].get(unregisterToken);
+    if (!token_cells)
+        return false;
+    state[1].delete(unregisterToken);
+
+    let removed = false;
+    for (const cell of token_cells) {
+        if (cell[1]) {
+            cell[1] = false;
+            removed = true;
+        }
+    }
+    return removed;
+}
+
+function finreg_cleanup (callback) {
+
+    const state = finreg_this(this);
+    if (callback === undefined)
+        callback = state[0];
+    else if (typeof callback !== 'function')
+        _shadow.TypeError_expected_function();
+
+    let cells;
+    while ((cells = finreg_take.call(this)) !== undefined) {
+        for (const cell of cells) {
+            if (cell[1]) {
+                cell[1] = false;
+                callback(cell[0]);
+            }
+        }
+    }
+}
+
+overrideFunctionName(finreg_register,   'register');
+overrideFunctionName(finreg_unregister, 'unregister');
+overrideFunctionName(finreg_cleanup,    'cleanupSome');
+
+// called by gc (), see utils.js
+_shadow.js_run_finalizers = function js_run_finalizers () {
 
-    // ctx[4] determines the result value,
-    // see create_map_or_set_iterator ()
-    const ctx_4 = ctx[4];
-    if (ctx_4 <= 0)
-        return;
-
-    let value, done;
-    if (ctx[0] < 0)
-        done = true;
-    else {
-        done = false;
-        if (ctx_4 === 1)
-            value = ctx[1];
-        else if (ctx_4 === 2)
-            value = ctx[2];
-        else if (ctx_4 === 3)
-            value = [ ctx[1], ctx[2] ];
+    for (const registry of finreg_active) {
+        finreg_cleanup.call(registry);
+        if (finreg_size.call(registry) === 0)
+            finreg_active.delete(registry);
     }
-    return { value, done };
 }
 
 // ------------------------------------------------------------
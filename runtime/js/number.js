@@ -162,6 +162,10 @@ function parseFloat (val) {
 }
 
 function parseInt (val, radix) {
+    // an undefined radix would mean parseFloat, see
+    // js_num_parse () in num.c, and zero means default
+    if (radix === undefined)
+        radix = 0;
     return js_num_util(val, 0x52 /* R */, radix); // paRse
 }
 
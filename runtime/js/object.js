@@ -353,6 +353,7 @@ function seal_or_freeze (obj, clear_write, clear_config) {
         if (redef)
             defineProperty(obj, key, descr);
     });
+    return obj;
 }
 
 defineNotEnum(Object, 'preventExtensions', _shadow.preventExtensions);
@@ -405,10 +406,25 @@ defineNotEnum(Object, 'isSealed', obj => is_sealed_or_frozen(obj, false, true));
 //
 // ------------------------------------------------------------
 
-defineNotEnum(Object, 'keys',                       null);
-defineNotEnum(Object, 'entries',                    null);
+// see js_obj_keys () in objsup.c
+const js_obj_keys = _shadow.js_obj_keys;
+
+function keys (obj) {
+    return js_obj_keys(obj, 0x4B /* K */);
+}
+
+function values (obj) {
+    return js_obj_keys(obj, 0x56 /* V */);
+}
+
+function entries (obj) {
+    return js_obj_keys(obj, 0x45 /* E */);
+}
+
+defineNotEnum(Object, 'keys',                       keys);
+defineNotEnum(Object, 'entries',                    entries);
 defineNotEnum(Object, 'fromEntries',                null);
-defineNotEnum(Object, 'values',                     null);
+defineNotEnum(Object, 'values',                     values);
 
 // ------------------------------------------------------------
 //
@@ -446,11 +462,13 @@ function getOwnPropertyNamesAndSymbols (obj, callback) {
             // property not a symbol (0x0004)
             const key_as_num = +key_as_str;
             if (!idx_arr) {
-                if (key_as_num === idx_num) {
+                if (key_as_num >= idx_num) {
                     // as long as keys are enumerated
-                    // in the proper order, we can
-                    // just forward them to callback
-                    idx_num++;
+                    // in ascending order, we can
+                    // just forward them to callback.
+                    // note that js_keys_in_object
+                    // lists object elements in order
+                    idx_num = key_as_num + 1;
                     callback(key_as_str, flg);
                     continue;
                 }
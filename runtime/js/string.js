@@ -169,10 +169,27 @@ defineNotEnum(String_prototype, 'concat', _shadow.str_sup.concat);
 
 // ------------------------------------------------------------
 
-//defineNotEnum(String_prototype, 'endsWith',
-//defineNotEnum(String_prototype, 'includes',
-//defineNotEnum(String_prototype, 'indexOf',
-//defineNotEnum(String_prototype, 'lastIndexOf',
+//
+// String.prototype.endsWith
+// String.prototype.includes
+// String.prototype.indexOf
+// String.prototype.lastIndexOf
+// String.prototype.startsWith
+//
+// see js_str_search_helper () in strsup.c
+//
+// ------------------------------------------------------------
+
+const _indexOf = _shadow.str_sup.indexOf;
+const _builder = _shadow.str_sup.builder;
+const _append = _shadow.str_sup.append;
+const _finish = _shadow.str_sup.finish;
+
+defineNotEnum(String_prototype, 'endsWith',    _shadow.str_sup.endsWith);
+defineNotEnum(String_prototype, 'includes',    _shadow.str_sup.includes);
+defineNotEnum(String_prototype, 'indexOf',     _indexOf);
+defineNotEnum(String_prototype, 'lastIndexOf', _shadow.str_sup.lastIndexOf);
+defineNotEnum(String_prototype, 'startsWith',  _shadow.str_sup.startsWith);
 
 // ------------------------------------------------------------
 
@@ -183,13 +200,110 @@ defineNotEnum(String_prototype, 'concat', _shadow.str_sup.concat);
 
 // ------------------------------------------------------------
 
-//defineNotEnum(String_prototype, 'padEnd',
-//defineNotEnum(String_prototype, 'padStart',
-//defineNotEnum(String_prototype, 'repeat',
-//defineNotEnum(String_prototype, 'replace',
-//defineNotEnum(String_prototype, 'replaceAll',
+defineNotEnum(String_prototype, 'padEnd',   _shadow.str_sup.padEnd);
+defineNotEnum(String_prototype, 'padStart', _shadow.str_sup.padStart);
+defineNotEnum(String_prototype, 'repeat',   _shadow.str_sup.repeat);
 //defineNotEnum(String_prototype, 'search',
 
+// ------------------------------------------------------------
+//
+// String.prototype.replace
+// String.prototype.replaceAll
+//
+// ------------------------------------------------------------
+
+defineNotEnum(String_prototype, 'replace',
+function replace (searchValue, replaceValue) {
+
+    const replacer = get_symbol_method(
+                        this, searchValue, _Symbol.replace);
+    if (replacer)
+        return replacer.call(searchValue, this, replaceValue);
+
+    const string = '' + this;
+    const search = '' + searchValue;
+    if (typeof(replaceValue) !== 'function')
+        replaceValue = '' + replaceValue;
+
+    const pos = _indexOf.call(string, search);
+    if (pos === -1)
+        return string;
+
+    return string.substring(0, pos)
+         + get_replacement(string, search, pos, replaceValue)
+         + string.substring(pos + search.length);
+});
+
+defineNotEnum(String_prototype, 'replaceAll',
+function replaceAll (searchValue, replaceValue) {
+
+    const replacer = get_symbol_method(
+                        this, searchValue, _Symbol.replace);
+    if (replacer)
+        return replacer.call(searchValue, this, replaceValue);
+
+    const string = '' + this;
+    const search = '' + searchValue;
+    if (typeof(replaceValue) !== 'function')
+        replaceValue = '' + replaceValue;
+
+    // an empty search string matches between characters
+    const advance = search.length || 1;
+    const result = _builder();
+    let end = 0;
+    let pos = _indexOf.call(string, search);
+    while (pos !== -1) {
+
+        _append(result, string.substring(end, pos),
+                get_replacement(string, search, pos, replaceValue));
+        end = pos + search.length;
+        // note that indexOf () clamps the position to length
+        pos += advance;
+        pos = (pos <= string.length)
+            ? _indexOf.call(string, search, pos) : -1;
+    }
+
+    _append(result, string.substring(end));
+    return _finish(result);
+});
+
+function get_replacement (string, matched, pos, replaceValue) {
+
+    if (typeof(replaceValue) === 'function')
+        return '' + replaceValue(matched, pos, string);
+
+    // patterns in the replacement string.  there are no
+    // capture groups when the search value is a string,
+    // so $n and $<name> are copied as they are
+    if (_indexOf.call(replaceValue, '$') === -1)
+        return replaceValue;
+
+    let result = '';
+    const n = replaceValue.length;
+    for (let i = 0; i < n; i++) {
+        const ch = replaceValue[i];
+        if (ch !== '$' || i + 1 === n) {
+            result += ch;
+            continue;
+        }
+        const next = replaceValue[i + 1];
+        if (next === '$')
+            result += '$';
+        else if (next === '&')
+            result += matched;
+        else if (next === '`')
+            result += string.substring(0, pos);
+        else if (next === "'")
+            result += string.substring(pos + matched.length);
+        else {
+            result += ch;
+            continue;
+        }
+        i++;
+    }
+    return result;
+}
+
 // ------------------------------------------------------------
 //
 // String.prototype.slice
@@ -199,14 +313,22 @@ defineNotEnum(String_prototype, 'concat', _shadow.str_sup.concat);
 //
 // ------------------------------------------------------------
 
+const _split = _shadow.str_sup.split;
+
 defineNotEnum(String_prototype, 'slice',     _shadow.str_sup.slice);
-defineNotEnum(String_prototype, 'split',     null);
-defineNotEnum(String_prototype, 'substr',    _shadow.str_sup.substr);
-defineNotEnum(String_prototype, 'substring', _shadow.str_sup.substring);
+defineNotEnum(String_prototype, 'split',
+function split (separator, limit) {
 
-// ------------------------------------------------------------
+    const splitter = get_symbol_method(
+                        this, separator, _Symbol.split);
+    if (splitter)
+        return splitter.call(separator, this, limit);
 
-//defineNotEnum(String_prototype, 'startsWith',
+    // split with a string separator, see js_str_split ()
+    return _split.call(this, separator, limit);
+});
+defineNotEnum(String_prototype, 'substr',    _shadow.str_sup.substr);
+defineNotEnum(String_prototype, 'substring', _shadow.str_sup.substring);
 
 // ------------------------------------------------------------
 //
@@ -336,6 +458,12 @@ function iterator_next () {
 overrideFunctionName(iterator, _shadow.this_iterator[_Symbol.iterator].name);
 overrideFunctionName(iterator_next, 'next');
 
+// while these are not modified, js_newiter () in iter.c
+// can iterate a string without creating an iterator
+_shadow.string_iterator = iterator;
+_shadow.string_iterator_next = iterator_next;
+_shadow.string_iterator_prototype = iterator_prototype;
+
 // ------------------------------------------------------------
 //
 // check_str_arg
@@ -349,6 +477,27 @@ function check_str_arg (obj) {
     return '' + obj;
 }
 
+// ------------------------------------------------------------
+//
+// get_symbol_method
+//
+// ------------------------------------------------------------
+
+function get_symbol_method (obj, arg, symbol) {
+
+    // replace () and split () defer to a method on
+    // the argument, e.g. a RegExp, if it is an object
+    if (obj === undefined || obj === null)
+        _shadow.TypeError_convert_null_to_object();
+
+    const type = typeof(arg);
+    if ((type === 'object' && arg !== null) || type === 'function') {
+        const method = arg[symbol];
+        if (method !== undefined && method !== null)
+            return method;
+    }
+}
+
 // ------------------------------------------------------------
 //
 // notImpl function
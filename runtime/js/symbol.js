@@ -55,7 +55,7 @@ function sym_reg_for (key) {
     key = '' + key;
     let sym = sym_reg_map.get(key);
     if (typeof(sym) !== 'symbol') {
-        sym = js_sym_util(key); // new symbol
+        sym = js_sym_util(key, true); // new registered symbol
         sym_reg_map.set(key, sym);
         sym_reg_map.set(sym, key);
     }
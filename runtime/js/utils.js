@@ -124,16 +124,13 @@ function unwrap_object_wrapper (obj, primitiveType) {
 
 // ------------------------------------------------------------
 
-_shadow.for_in_iterator = function for_in_iterator (obj) {
-
-    console.log('utils.js: for_in not yet implemented');
-    return [];
-}
-
-// ------------------------------------------------------------
-
 const js_gc_util = _shadow.js_gc_util;
-const _gc = function gc (full) { return js_gc_util(full !== false); }
+const _gc = function gc (full) {
+    const ret_val = js_gc_util(full !== false);
+    // call FinalizationRegistry callbacks, see mapset.js
+    _shadow.js_run_finalizers();
+    return ret_val;
+}
 // number of values managed by the gc, updated each sweep
 defineProperty(_gc, 'vcount',
         { get() { return js_gc_util.number; } });
@@ -145,6 +142,26 @@ defineProperty(_gc, 'threshold',
       set(v) { if ((v = +v) > 1)
                     js_gc_util(null, _gc_threshold = v); }});
 
+// statistics for the pool of coroutine stacks, and the
+// stack size for new coroutines and the number of stacks
+// kept for reuse, see coroutine.c
+const js_coroutine = _shadow.js_coroutine;
+defineProperty(_gc, 'coroutines',
+    { get() {
+        const q = js_coroutine(0x51 /* Q */);
+        return { stack_size: q[0], max_free: q[1],
+                 free: q[2], created: q[3], reused: q[4],
+                 active: q[5], max_active: q[6],
+                 max_stack_used: q[7] }; }});
+
+defineProperty(_gc, 'coroutine_stack_size',
+    { get() { return js_coroutine(0x51 /* Q */)[0]; },
+      set(v) { js_coroutine(0x43 /* C */, +v); }});
+
+defineProperty(_gc, 'coroutine_max_free',
+    { get() { return js_coroutine(0x51 /* Q */)[1]; },
+      set(v) { js_coroutine(0x43 /* C */, undefined, +v); }});
+
 _global.gc = _gc;
 
 // ------------------------------------------------------------
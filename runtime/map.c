@@ -7,17 +7,56 @@
 
 typedef struct js_map {
 
+    // the gc thread reads this map concurrently, without
+    // a lock.  so the map is never resized in place, see
+    // js_map_set (), and an old map is freed by the gc
     intmap *key2val_map;
     objset *strings_set;
     objset *bigints_set;
-    struct js_mutex *mutex; // sync with gc
     uint32_t elem_count;
 
+    // incremented whenever key2val_map is replaced,
+    // so an iterator knows to find its position again,
+    // see js_map_iter_step ()
+    uint32_t generation;
+    uint32_t clear_generation;
+
+    // in a weak collection, the keys are objects which
+    // the map does not keep alive, see js_map_weak_mark ()
+    bool weak_keys;
+
+    // set once a symbol becomes a key in a weak collection.
+    // such a key is kept alive, as are other symbols, see
+    // js_map_can_be_weak_key () and js_map_gc_callback ()
+    bool weak_sym_keys;
+
+    // key for the next entry that is pending finalization,
+    // see js_map_weak_purge ()
+    uint32_t pending_seq;
+
 } js_map;
 
+// the kind of a map or set private object, where
+// 'which' is a digit character, '1' for Map, '2' for
+// Set, '3' for WeakMap, '4' for WeakSet, '5' for WeakRef,
+// and '6' for FinalizationRegistry, see js_map_create ()
+#define js_map_kind(which) \
+    ((js_val){ .raw = 0x4D655000 /* MAP0 */ + (which) })
+
+// the key of a weak collection may be an object, or a
+// symbol which was not created by Symbol.for ().  the gc
+// does not collect symbol keys, which the spec permits
+#define js_map_can_be_weak_key(key)                         \
+    (js_is_object(key) || (js_is_primitive_symbol(key)      \
+        && !(((objset_id *)js_get_pointer(key))->flags      \
+                            & js_sym_is_registered)))
+
 static void js_map_gc_callback (
                 js_gc_env *gc, js_priv *obj, int why);
 
+static void js_map_iter_gc_callback (
+                js_gc_env *gc, js_priv *obj, int why);
+
 // ------------------------------------------------------------
 //
 // js_map_string
@@ -31,17 +70,12 @@ static js_val js_map_string (js_environ *env, js_map *map,
     // interns string property values into the
     // global env->strings_set.  (see shape.c)
     // we do the same here with map string keys.
+    // the set holds the flat string itself, which
+    // is immutable, so an iterator can return it
+    // without a copy.  the gc marks the string as
+    // a key in the map, see js_map_gc_callback ()
 
-    objset_id *id = js_get_pointer(key);
-
-    if (!map) {
-        // called by js_map_iter to clone key
-        uint32_t len = sizeof(objset_id) + id->len;
-        objset_id *id2 = js_malloc(len);
-        memcpy(id2, id, len);
-        return js_gc_manage(env,
-                    js_make_primitive_string(id2));
-    }
+    objset_id *id = js_get_pointer(js_str_flat(env, key));
 
     if (set_or_get) {   // 'set' command
 
@@ -50,11 +84,8 @@ static js_val js_map_string (js_environ *env, js_map *map,
                 js_check_alloc(objset_create());
         }
 
-        bool copy;
         id = js_check_alloc(objset_intern(
-                    &map->strings_set, id, &copy));
-
-        id->flags = js_prim_is_string;
+                    &map->strings_set, id, NULL));
 
     } else {            // 'get' command
 
@@ -64,8 +95,7 @@ static js_val js_map_string (js_environ *env, js_map *map,
             return js_make_number(0);
         }
 
-        id = objset_search(map->strings_set,
-                           id->data, id->len);
+        id = objset_search_id(map->strings_set, id);
         if (!id) {
             // a string key can only be found
             // if it also exists in string set
@@ -91,7 +121,7 @@ static js_val js_map_bigint (js_environ *env, js_map *map,
     // we do the same here with map bigint keys.
 
     if (!map) {
-        // called by js_map_iter to clone key
+        // called by js_map_iter_step to clone key
         const objset_id *id = js_get_pointer(key);
         const uint32_t id_len = id->len;
         uint32_t *big =
@@ -135,6 +165,7 @@ static js_val js_map_bigint (js_environ *env, js_map *map,
         id = js_malloc(sizeof(objset_id) + len_big);
         id->len = len_big;
         id->flags = js_prim_is_bigint;
+        id->hash = 0;
         memcpy(id->data, ptr_big, len_big);
 
         objset_id *id2 =
@@ -159,18 +190,7 @@ static js_val js_map_bigint (js_environ *env, js_map *map,
 // ------------------------------------------------------------
 
 static void js_map_set (js_environ *env, js_map *map,
-                        js_link *arg_ptr) {
-
-    js_val key = js_undefined;
-    js_val val = js_undefined;
-
-    if (arg_ptr != js_stk_top) {
-        if ((arg_ptr = arg_ptr->next) != js_stk_top) {
-            key = arg_ptr->value;
-            if ((arg_ptr = arg_ptr->next) != js_stk_top)
-                val = arg_ptr->value;
-        }
-    }
+                        js_val key, js_val val) {
 
     //
     // if key is a primitive, make it unique
@@ -178,10 +198,17 @@ static void js_map_set (js_environ *env, js_map *map,
 
     if (js_is_primitive(key)) {
         int prim_type = js_get_primitive_type(key);
-        if (prim_type == js_prim_is_string)
+        if (prim_type == js_prim_is_string) {
             key = js_map_string(env, map, key, true);
-        else if (prim_type == js_prim_is_bigint)
+            js_gc_notify(env, key);
+        } else if (prim_type == js_prim_is_bigint)
             key = js_map_bigint(env, map, key, true);
+        else if (prim_type == js_prim_is_symbol) {
+            // as for an object key, below
+            js_gc_notify(env, key);
+            if (map->weak_keys)
+                map->weak_sym_keys = true;
+        }
         /*else if (prim_type == js_prim_is_symbol) {
             // flag symbol so it never gets deleted
             objset_id *id = js_get_pointer(key);
@@ -194,7 +221,15 @@ static void js_map_set (js_environ *env, js_map *map,
         // in case the map was already scanned,
         // and nothing else references that key.
         // we do the same for the value, below.
-        js_gc_notify(env, key);
+        // but a weak key is only flagged, so the
+        // sweep leaves it for js_gc_purge_weak ()
+        js_obj *key_ptr = js_get_pointer(key);
+        if (!map->weak_keys)
+            js_gc_notify(env, key);
+        else if (!(key_ptr->max_values & js_gc_weak_bit)) {
+            js_compare_and_swap_32(&key_ptr->max_values,
+                                   -1U, js_gc_weak_bit);
+        }
 
     } else if (js_is_number(key)) {
         // make sure canonical zero and NaN
@@ -208,19 +243,28 @@ static void js_map_set (js_environ *env, js_map *map,
         js_gc_notify(env, val);
 
     //
-    // insert value into the map
+    // make room in the map before inserting, so the
+    // insert never resizes the map in place.  a new map
+    // is published to the gc thread, which may still be
+    // reading the old map, so the gc frees the old map
     //
 
-    js_mutex_enter(map->mutex);
-
-    bool was_added;
-    bool ok = intmap_set_or_add(&map->key2val_map,
-                    key.raw, val.raw, &was_added);
+    intmap *old_map = map->key2val_map;
+    intmap *new_map = js_check_alloc(intmap_reserve(old_map));
+    if (new_map != old_map) {
+        __atomic_store_n(&map->key2val_map, new_map,
+                         __ATOMIC_RELEASE);
+        js_gc_free(env, old_map);
+        map->generation++;
+    }
 
-    js_mutex_leave(map->mutex);
+    //
+    // insert value into the map
+    //
 
-    if (!ok)
-        js_check_alloc(NULL); // out of memory
+    bool was_added;
+    intmap_set_or_add(&map->key2val_map,
+                      key.raw, val.raw, &was_added);
 
     if (was_added)
         map->elem_count++;
@@ -228,21 +272,60 @@ static void js_map_set (js_environ *env, js_map *map,
 
 // ------------------------------------------------------------
 //
-// js_map_get
+// js_map_forget_key
 //
 // ------------------------------------------------------------
 
-static js_val js_map_get (js_environ *env, js_map *map,
-                          js_link *arg_ptr, int cmd) {
+static void js_map_forget_key (js_map *map, js_val key) {
 
-    if (cmd == /* 0x4E */ 'N')
-        return js_make_number((double)map->elem_count);
+    // after a key was deleted from the map, also remove
+    // a string or bigint key from the set that makes it
+    // unique.  a string key belongs to the gc, while a
+    // bigint key is a copy which belongs to the map
 
-    js_val key = js_undefined;
-    if (arg_ptr != js_stk_top) {
-        if ((arg_ptr = arg_ptr->next) != js_stk_top)
-            key = arg_ptr->value;
+    if (js_is_primitive(key)) {
+        objset_id *id = js_get_pointer(key);
+        int prim_type = js_get_primitive_type(key);
+        if (prim_type == js_prim_is_string)
+            objset_delete(&map->strings_set, id);
+        else if (prim_type == js_prim_is_bigint) {
+            objset_delete(&map->bigints_set, id);
+            js_free(id);
+        }
+    }
+}
+
+// ------------------------------------------------------------
+//
+// js_map_compact
+//
+// ------------------------------------------------------------
+
+static void js_map_compact (js_environ *env, js_map *map) {
+
+    // once most entries in the map were deleted, replace
+    // the map with a copy without the deleted entries.
+    // the copy is published the same way as when the map
+    // grows, see js_map_set ().  if the copy cannot be
+    // allocated, the old map is still valid
+    intmap *old_map = map->key2val_map;
+    intmap *new_map = intmap_compact(old_map);
+    if (new_map && new_map != old_map) {
+        __atomic_store_n(&map->key2val_map, new_map,
+                         __ATOMIC_RELEASE);
+        js_gc_free(env, old_map);
+        map->generation++;
     }
+}
+
+// ------------------------------------------------------------
+//
+// js_map_get
+//
+// ------------------------------------------------------------
+
+static js_val js_map_get (js_environ *env, js_map *map,
+                          js_val key, int cmd) {
 
     const bool _get = (cmd == /* 0x47 */ 'G');
     const bool _del = (cmd == /* 0x52 */ 'R');
@@ -281,8 +364,11 @@ static js_val js_map_get (js_environ *env, js_map *map,
         if (ok) {
             if (_get)
                 return val;
-            if (_del)
+            if (_del) {
                 map->elem_count--;
+                js_map_forget_key(map, key);
+                js_map_compact(env, map);
+            }
             return js_true;
         }
 
@@ -293,55 +379,6 @@ static js_val js_map_get (js_environ *env, js_map *map,
     return _get ? js_undefined : js_false;
 }
 
-// ------------------------------------------------------------
-//
-// js_map_iter
-//
-// ------------------------------------------------------------
-
-static js_val js_map_iter (js_environ *env, js_map *map,
-                           js_link *arg_ptr) {
-
-    do {
-        if (arg_ptr == js_stk_top)
-            break;
-        if ((arg_ptr = arg_ptr->next) == js_stk_top)
-            break;
-
-        js_val ctx = arg_ptr->value;
-        void *ctx_ptr = js_get_pointer(ctx);
-        if (!js_obj_is_exotic(ctx_ptr, js_obj_is_array))
-            break;
-
-        // ctx[0] is internal iteration index
-        const js_val ctx_0 =
-                        js_arr_get(ctx, (0U + 1U));
-        int index = (int)js_get_number(ctx_0);
-
-        js_val key, val;
-        if (!intmap_get_next(map->key2val_map,
-                        &index, &key.raw, &val.raw))
-            break;
-
-        if (js_is_primitive(key)) {
-            int prim_type = js_get_primitive_type(key);
-            if (prim_type == js_prim_is_string)
-                key = js_map_string(env, NULL, key, 0);
-            else if (prim_type == js_prim_is_bigint)
-                key = js_map_bigint(env, NULL, key, 0);
-        }
-
-        js_arr_set(env, ctx, (0U + 1U),
-                js_make_number(index));
-        js_arr_set(env, ctx, (1U + 1U), key);
-        js_arr_set(env, ctx, (2U + 1U), val);
-
-        return js_true;
-
-    } while (false);
-    return js_false;
-}
-
 // ------------------------------------------------------------
 //
 // js_map_create
@@ -352,9 +389,9 @@ static js_val js_map_create (js_environ *env,
                              js_val kind,
                              js_link *arg_ptr) {
 
-    // kind must be digits 1 through 4
+    // kind must be digits 1 through 6
     if (    (kind.raw & 0xFF) < 0x31
-         || (kind.raw & 0xFF) > 0x34)
+         || (kind.raw & 0xFF) > 0x36)
         return js_undefined;
 
     // the next parameter is an object that will
@@ -370,8 +407,12 @@ static js_val js_map_create (js_environ *env,
             js_check_alloc(intmap_create());
     map->strings_set = NULL;
     map->bigints_set = NULL;
-    map->mutex = js_check_alloc(js_mutex_new());
     map->elem_count = 0;
+    map->generation = 0;
+    map->clear_generation = 0;
+    map->weak_keys = (kind.raw & 0xFF) >= 0x33;
+    map->weak_sym_keys = false;
+    map->pending_seq = 0;
 
     // create a private object for the map
     js_priv *priv = js_newprivobj(env, kind);
@@ -388,17 +429,18 @@ static js_val js_map_create (js_environ *env,
 //
 // ------------------------------------------------------------
 
-static void js_map_free_set (objset *set) {
+static void js_map_free_set (objset *set, bool free_ids) {
 
-    if (set) {
+    if (set && free_ids) {
         for (int index = 0;;) {
             objset_id *id;
             if (!objset_next(set, &index, &id))
                 break;
             free(id);
         }
-        objset_destroy(set);
     }
+    if (set)
+        objset_destroy(set);
 }
 
 // ------------------------------------------------------------
@@ -407,25 +449,26 @@ static void js_map_free_set (objset *set) {
 //
 // ------------------------------------------------------------
 
-static void js_map_clear (js_map *map) {
-
-    js_mutex_enter(map->mutex);
+static void js_map_clear (js_environ *env, js_map *map) {
 
     void *old_key2val = map->key2val_map;
     void *old_strings = map->strings_set;
     void *old_bigints = map->bigints_set;
 
-    map->key2val_map =
-            js_check_alloc(intmap_create());
+    __atomic_store_n(&map->key2val_map,
+                     js_check_alloc(intmap_create()),
+                     __ATOMIC_RELEASE);
     map->strings_set = NULL;
     map->bigints_set = NULL;
     map->elem_count  = 0;
-
-    js_mutex_leave(map->mutex);
-
-    intmap_destroy(old_key2val);
-    js_map_free_set(old_strings);
-    js_map_free_set(old_bigints);
+    map->clear_generation = ++map->generation;
+
+    // the gc thread may still be reading the old map,
+    // but it never looks at the string or bigint sets,
+    // and string keys are not freed until the next gc
+    js_gc_free(env, old_key2val);
+    js_map_free_set(old_strings, false);
+    js_map_free_set(old_bigints, true);
 }
 
 // ------------------------------------------------------------
@@ -442,36 +485,152 @@ static void js_map_gc_callback (
     if (why == 0) {
         // if notified about collection, free map
         intmap_destroy(map->key2val_map);
-        js_map_free_set(map->strings_set);
-        js_map_free_set(map->bigints_set);
-        js_free(map->mutex);
+        js_map_free_set(map->strings_set, false);
+        js_map_free_set(map->bigints_set, true);
         js_free(map);
         return;
     }
 
-    // otherwise recursively mark keys or values,
-    // in map, set, or weakmap, but not weakset
-    int kind = priv->type.raw & 0xFF;
-    if (kind == 0x34) // weakset
-        return;
+    // a weak collection does not mark its keys, and
+    // the value of an entry is only marked once its key
+    // is marked, see js_map_weak_mark ().  except that a
+    // FinalizationRegistry keeps all its values alive
+    if (map->weak_keys) {
+        js_gc_weak_register(gc, priv);
+        if ((priv->type.raw & 0xFF) != 0x36 && !map->weak_sym_keys)
+            return;
+    }
+
+    // otherwise recursively mark keys and values.
+    // the main thread may replace the map while we
+    // iterate, but the old map is freed by this thread,
+    // see js_map_set (), and any key or value added to
+    // the new map is passed to js_gc_notify ()
+    intmap *key2val_map = __atomic_load_n(
+                    &map->key2val_map, __ATOMIC_ACQUIRE);
 
     for (int index = 0;;) {
 
-        js_mutex_enter(map->mutex);
         js_val key, val;
-        bool more = intmap_get_next(map->key2val_map,
-                        &index, &key.raw, &val.raw);
-        js_mutex_leave(map->mutex);
-        if (!more)
+        if (!intmap_get_next(key2val_map,
+                        &index, &key.raw, &val.raw))
             break;
 
-        if (js_is_object(key) ||
-                js_is_primitive_symbol(key)) {
+        // a symbol key is kept alive even in a weak
+        // collection, and so is the value of its entry
+        const bool is_sym = js_is_primitive_symbol(key);
+        if (js_is_object(key) || is_sym ||
+                js_is_primitive_string(key)) {
 
-            js_gc_mark_val(gc, key);
+            if (!map->weak_keys || is_sym)
+                js_gc_mark_val(gc, key);
         }
+        if (!map->weak_keys || is_sym
+                || (priv->type.raw & 0xFF) == 0x36)
+            js_gc_mark_val(gc, val);
+    }
+}
+
+// ------------------------------------------------------------
+//
+// js_map_weak_mark
+//
+// called by js_gc_ephemerons () for a WeakMap which was
+// marked during this gc cycle, to mark the value of each
+// entry whose key is marked.  returns true if any object
+// was newly marked, which may be the key of another entry
+//
+// ------------------------------------------------------------
+
+static bool js_map_weak_mark (js_gc_env *gc, js_priv *priv) {
+
+    // in a WeakSet or WeakRef, the value is the key itself,
+    // and a FinalizationRegistry already marked its values
+    if ((priv->type.raw & 0xFF) != 0x33)
+        return false;
+
+    js_map *map = priv->val_or_ptr.ptr;
+    intmap *key2val_map = __atomic_load_n(
+                    &map->key2val_map, __ATOMIC_ACQUIRE);
+    bool marked_more = false;
+
+    for (int index = 0;;) {
+
+        js_val key, val;
+        if (!intmap_get_next(key2val_map,
+                        &index, &key.raw, &val.raw))
+            break;
+
+        // a symbol key was marked along with its value,
+        // see js_map_gc_callback ()
+        if (!js_is_object(key))
+            continue;
+        const js_obj *key_ptr = js_get_pointer(key);
+        if (!(key_ptr->max_values & js_gc_marked_bit))
+            continue;
+
+        if (js_is_object(val) && !(((js_obj *)
+                js_get_pointer(val))->max_values
+                                & js_gc_marked_bit))
+            marked_more = true;
+
         js_gc_mark_val(gc, val);
     }
+
+    return marked_more;
+}
+
+// ------------------------------------------------------------
+//
+// js_map_weak_purge
+//
+// called by js_gc_purge_weak () on the main thread, to delete
+// the entries whose keys were found dead by the last sweep.
+// the sweep cleared the weak bit of these keys.  in the case
+// of a FinalizationRegistry, the value of such an entry is
+// kept, under a number key, until taken by the 'T' command,
+// see js_map_method ()
+//
+// ------------------------------------------------------------
+
+static void js_map_weak_purge (js_environ *env, js_priv *priv) {
+
+    js_map *map = priv->val_or_ptr.ptr;
+    js_val *pending_vals = NULL;
+    uint32_t num_pending = 0;
+    if ((priv->type.raw & 0xFF) == 0x36 && map->elem_count)
+        pending_vals = js_malloc(map->elem_count * sizeof(js_val));
+
+    for (int index = 0;;) {
+
+        js_val key, val;
+        if (!intmap_get_next(map->key2val_map,
+                        &index, &key.raw, &val.raw))
+            break;
+
+        if (!js_is_object(key) || (((js_obj *)
+                js_get_pointer(key))->max_values
+                                & js_gc_weak_bit))
+            continue;
+
+        intmap_get_or_del(map->key2val_map,
+                          key.raw, &val.raw, true);
+        map->elem_count--;
+
+        if (pending_vals)
+            pending_vals[num_pending++] = val;
+    }
+
+    // a new entry may replace the intmap, so new entries
+    // are only added once the iteration is done
+    for (uint32_t i = 0; i < num_pending; i++) {
+        js_map_set(env, map, js_make_number(
+                    (double)++map->pending_seq),
+                   pending_vals[i]);
+    }
+    js_free(pending_vals);
+
+    js_map_compact(env, map);
 }
 
 // ------------------------------------------------------------
@@ -494,9 +653,7 @@ static js_val js_map_util (js_c_func_args) {
             break;
 
         int cmd = (int)arg_ptr->value.num;
-        js_val kind =
-            ((js_val){ .raw = 0x4D655000 /* MAP0 */
-                            + (cmd & 0xFF) });
+        js_val kind = js_map_kind(cmd & 0xFF);
         cmd = cmd >> 8;
 
         // we expect at least one more parameter
@@ -504,36 +661,480 @@ static js_val js_map_util (js_c_func_args) {
         if (arg_ptr == js_stk_top)
             break;
 
-        // if command is create, we are done
-        if (cmd == /* 0x43 */ 'C') {
+        // the only command is create, other operations
+        // are methods, see js_map_method () and below
+        if (cmd == /* 0x43 */ 'C')
             ret = js_map_create(env, kind, arg_ptr);
+
+    } while (0);
+    js_return(ret);
+}
+
+// ------------------------------------------------------------
+//
+// js_map_this
+//
+// ------------------------------------------------------------
+
+static js_map *js_map_this (js_environ *env,
+                            js_val this_val, int which) {
+
+    // 'this' must be a map or set object of the kind
+    // specified by 'which', see also js_map_create ()
+    js_priv *priv = js_isprivobj(this_val, js_map_kind(which));
+    if (!priv)
+        js_callthrow("TypeError_incompatible_object");
+    return priv->val_or_ptr.ptr;
+}
+
+// ------------------------------------------------------------
+//
+// js_map_weak_deref
+//
+// returns the target of a WeakRef, i.e. the only key in its
+// map, or undefined if the target was collected
+//
+// ------------------------------------------------------------
+
+static js_val js_map_weak_deref (js_environ *env, js_map *map) {
+
+    js_val key, val;
+    int index = 0;
+    if (intmap_get_next(map->key2val_map,
+                        &index, &key.raw, &val.raw)
+            && (!js_is_object(key) || js_gc_weak_alive(env, key)))
+        return key;
+    return js_undefined;
+}
+
+// ------------------------------------------------------------
+//
+// js_map_weak_take
+//
+// deletes and returns the value of the first entry pending
+// finalization, see js_map_weak_purge (), or undefined
+//
+// ------------------------------------------------------------
+
+static js_val js_map_weak_take (js_environ *env, js_map *map) {
+
+    for (int index = 0;;) {
+
+        js_val key, val;
+        if (!intmap_get_next(map->key2val_map,
+                        &index, &key.raw, &val.raw))
             break;
+
+        // a pending entry has a number key, while
+        // the key of a registered target may be an
+        // object or a symbol
+        if (js_is_number(key)) {
+            intmap_get_or_del(map->key2val_map,
+                              key.raw, NULL, true);
+            map->elem_count--;
+            js_map_compact(env, map);
+            return val;
         }
+    }
 
-        // second parameter is the map/set object,
-        // which must match the specified 'kind'
-        js_priv *priv =
-                    js_isprivobj(arg_ptr->value, kind);
-        if (!priv)
-            js_callthrow("TypeError_incompatible_object");
-        js_map *map = priv->val_or_ptr.ptr;
+    return js_undefined;
+}
 
-        if (cmd == /* 0x53 */ 'S') {
-            // command is 'S' for Set
-            js_map_set(env, map, arg_ptr);
+// ------------------------------------------------------------
+//
+// Map and Set methods
+//
+// the prototype methods call into C directly, see mapset.js.
+// 'which' is the kind of map, and 'cmd' is the operation:
+// 'G'et, 'H'as, 'R'emove, 'S'et, 'A'dd to set, 'E'mpty,
+// or 'N'umber of elements.  and for the weak collections,
+// 'D'eref the target of a WeakRef, or 'T'ake the value of
+// an entry pending finalization in a FinalizationRegistry
+//
+// ------------------------------------------------------------
 
-        } else if (cmd == /* 0x49 */ 'I') {
-            ret = js_map_iter(env, map, arg_ptr);
+static js_val js_map_method (js_environ *env, js_val this_val,
+                             js_link *arg_ptr, int which, int cmd) {
 
-        } else if (cmd != /* 0x45 */ 'E') {
-            // command is not 'S' or 'I' or 'E'
-            ret = js_map_get(env, map, arg_ptr, cmd);
+    js_map *map = js_map_this(env, this_val, which);
 
-        } else
-            js_map_clear(map);
+    js_val arg1 = js_undefined;
+    js_val arg2 = js_undefined;
+    if ((arg_ptr = arg_ptr->next) != js_stk_top) {
+        arg1 = arg_ptr->value;
+        if ((arg_ptr = arg_ptr->next) != js_stk_top)
+            arg2 = arg_ptr->value;
+    }
 
-    } while (0);
-    js_return(ret);
+    if (map->weak_keys && !js_map_can_be_weak_key(arg1)
+                       && cmd != 'D' && cmd != 'T' && cmd != 'N') {
+
+        // the key of a weak collection must be an object,
+        // or a symbol, see js_map_can_be_weak_key ()
+        if (cmd == 'S' || cmd == 'A')
+            js_callthrow("TypeError_invalid_weak_key");
+        return (cmd == 'G') ? js_undefined : js_false;
+    }
+
+    switch (cmd) {
+
+        case /* 0x53 */ 'S':
+            js_map_set(env, map, arg1, arg2);
+            return this_val;
+
+        case /* 0x44 */ 'D':
+            return js_map_weak_deref(env, map);
+
+        case /* 0x54 */ 'T':
+            return js_map_weak_take(env, map);
+
+        case /* 0x41 */ 'A':
+            // the value of a set element is the element
+            // itself, see forEach () and entries ()
+            if (js_is_number(arg1) && arg1.num == 0)
+                arg1.num = 0; // canonical zero
+            js_map_set(env, map, arg1, arg1);
+            return this_val;
+
+        case /* 0x45 */ 'E':
+            js_map_clear(env, map);
+            return js_undefined;
+
+        case /* 0x4E */ 'N':
+            return js_make_number((double)map->elem_count);
+
+        default:
+            return js_map_get(env, map, arg1, cmd);
+    }
+}
+
+#define js_map_method_func(func_name,which,cmd)             \
+    static js_val func_name (js_c_func_args) {              \
+        js_prolog_stack_frame();                            \
+        const js_val ret_val = js_map_method(               \
+                env, this_val, stk_args, (which), (cmd));   \
+        js_return(ret_val);                                 \
+    }
+
+js_map_method_func(js_map_get_v,    '1', 'G')
+js_map_method_func(js_map_set_v,    '1', 'S')
+js_map_method_func(js_map_has_v,    '1', 'H')
+js_map_method_func(js_map_delete_v, '1', 'R')
+js_map_method_func(js_map_clear_v,  '1', 'E')
+js_map_method_func(js_map_size_v,   '1', 'N')
+js_map_method_func(js_set_add_v,    '2', 'A')
+js_map_method_func(js_set_has_v,    '2', 'H')
+js_map_method_func(js_set_delete_v, '2', 'R')
+js_map_method_func(js_set_clear_v,  '2', 'E')
+js_map_method_func(js_set_size_v,   '2', 'N')
+js_map_method_func(js_weakmap_get_v,    '3', 'G')
+js_map_method_func(js_weakmap_set_v,    '3', 'S')
+js_map_method_func(js_weakmap_has_v,    '3', 'H')
+js_map_method_func(js_weakmap_delete_v, '3', 'R')
+js_map_method_func(js_weakset_add_v,    '4', 'A')
+js_map_method_func(js_weakset_has_v,    '4', 'H')
+js_map_method_func(js_weakset_delete_v, '4', 'R')
+js_map_method_func(js_weakref_init_v,   '5', 'A')
+js_map_method_func(js_weakref_deref_v,  '5', 'D')
+js_map_method_func(js_finreg_get_v,     '6', 'G')
+js_map_method_func(js_finreg_set_v,     '6', 'S')
+js_map_method_func(js_finreg_take_v,    '6', 'T')
+js_map_method_func(js_finreg_size_v,    '6', 'N')
+
+#undef js_map_method_func
+
+// ------------------------------------------------------------
+//
+// Map and Set iterators
+//
+// an iterator walks the entries of the intmap directly, see
+// intmap_iterate ().  if the intmap is replaced, because it
+// was resized or cleared, the iterator finds its position in
+// the new intmap by the sequence number of the last entry.
+//
+// ------------------------------------------------------------
+
+typedef struct js_map_iter {
+
+    js_map *map;        // NULL once iteration is done
+    js_val map_val;     // keeps the map alive
+    js_val pair;        // entry array, see js_map_iter_value ()
+    uint32_t generation;
+    uint32_t seq;
+    int index;
+    int mode;           // 'K'eys, 'V'alues, or 'E'ntries
+    bool reuse_pair;
+
+} js_map_iter;
+
+#define js_map_iter_kind ((js_val){ .raw = 0x4D654900 /* MeI0 */ })
+
+// ------------------------------------------------------------
+//
+// js_map_iter_step
+//
+// ------------------------------------------------------------
+
+static bool js_map_iter_step (js_environ *env, js_map_iter *it,
+                              js_val *key, js_val *val) {
+
+    js_map *map = it->map;
+    if (!map)
+        return false;
+
+    if (unlikely(it->generation != map->generation)) {
+
+        // if the map was cleared since the last step, any
+        // entries start at the top of the new intmap,
+        // otherwise continue after the last entry seen
+        if ((int32_t)(map->clear_generation
+                            - it->generation) > 0)
+            it->index = 0;
+        else {
+            it->index = intmap_seek(
+                            map->key2val_map, it->seq);
+        }
+        it->generation = map->generation;
+    }
+
+    if (!intmap_iterate(map->key2val_map, &it->index,
+                        &it->seq, &key->raw, &val->raw)) {
+
+        // once done, an iterator stays done
+        it->map = NULL;
+        it->map_val = js_undefined;
+        return false;
+    }
+
+    if (js_is_primitive(*key)) {
+        // a string key is returned as is, but a bigint
+        // key is a copy that belongs to the map
+        if (js_get_primitive_type(*key) == js_prim_is_bigint)
+            *key = js_map_bigint(env, NULL, *key, 0);
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------
+//
+// js_map_iter_value
+//
+// ------------------------------------------------------------
+
+static bool js_map_iter_value (js_environ *env,
+                    js_map_iter *it, js_val *ret_val) {
+
+    js_val key, val;
+    if (!js_map_iter_step(env, it, &key, &val)) {
+        *ret_val = js_undefined;
+        return false;
+    }
+
+    if (it->mode == /* 0x4B */ 'K')
+        *ret_val = key;
+
+    else if (it->mode == /* 0x56 */ 'V')
+        *ret_val = val;
+
+    else if (!it->reuse_pair)
+        *ret_val = js_newarr(env, 2, key, val);
+
+    else {
+        // the caller promised to only read the entry array
+        // before the next step, see js_map_iter_reuse ()
+        if (!it->pair.raw) {
+            it->pair = js_newarr(env, 2, key, val);
+            js_gc_notify(env, it->pair);
+        } else {
+            // the gc may have already scanned the array,
+            // see also js_setprop ()
+            if (js_is_object_or_primitive(key))
+                js_gc_notify(env, key);
+            if (js_is_object_or_primitive(val))
+                js_gc_notify(env, val);
+            js_arr_set(env, it->pair, (0U + 1U), key);
+            js_arr_set(env, it->pair, (1U + 1U), val);
+        }
+        *ret_val = it->pair;
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------
+//
+// js_map_iter_this
+//
+// ------------------------------------------------------------
+
+static js_map_iter *js_map_iter_this (js_environ *env,
+                                      js_val this_val) {
+
+    js_priv *priv = js_isprivobj(this_val, js_map_iter_kind);
+    if (!priv)
+        js_callthrow("TypeError_incompatible_object");
+    return priv->val_or_ptr.ptr;
+}
+
+// ------------------------------------------------------------
+//
+// js_map_iter_create_v
+//
+// creates an iterator for a map or set, called from mapset.js
+// with the map or set object, a command which has the 'mode'
+// in the high byte, and the kind of map in the low byte, and
+// the prototype for the new iterator object
+//
+// ------------------------------------------------------------
+
+static js_val js_map_iter_create_v (js_c_func_args) {
+    js_prolog_stack_frame();
+
+    js_val args[3] = { js_undefined, js_undefined, js_undefined };
+    js_link *arg_ptr = stk_args;
+    for (int i = 0; i < 3; i++) {
+        if ((arg_ptr = arg_ptr->next) == js_stk_top)
+            break;
+        args[i] = arg_ptr->value;
+    }
+
+    const int cmd = (int)js_get_number(args[1]);
+    js_map *map = js_map_this(env, args[0], cmd & 0xFF);
+
+    js_map_iter *it = js_malloc(sizeof(js_map_iter));
+    it->map = map;
+    it->map_val = args[0];
+    it->pair.raw = 0;
+    it->generation = map->generation;
+    it->seq = 0;
+    it->index = 0;
+    it->mode = cmd >> 8;
+    it->reuse_pair = false;
+
+    js_priv *priv = js_newprivobj(env, js_map_iter_kind);
+    if (js_is_object(args[2])) {
+        uintptr_t proto = args[2].raw & js_pointer_mask;
+        proto |= ((uintptr_t)priv->super.proto) & 7;
+        priv->super.proto = (void *)proto;
+    }
+    priv->val_or_ptr.ptr = it;
+    priv->gc_callback = js_map_iter_gc_callback;
+    js_return(js_gc_manage(env, js_make_object(priv)));
+}
+
+// ------------------------------------------------------------
+//
+// js_map_iter_next_v
+//
+// the next () method of a map or set iterator.  note that
+// js_nextiter1 () in iter.c recognizes this function, and
+// calls js_map_iter_fast () instead, see below
+//
+// ------------------------------------------------------------
+
+static js_val js_map_iter_next_v (js_c_func_args) {
+    js_prolog_stack_frame();
+
+    js_map_iter *it = js_map_iter_this(env, this_val);
+
+    // an entry array returned to the caller must be new
+    const bool reuse_pair = it->reuse_pair;
+    it->reuse_pair = false;
+
+    js_val value;
+    const bool more = js_map_iter_value(env, it, &value);
+    it->reuse_pair = reuse_pair;
+
+    js_return(js_newobj(env, env->shape_value_done,
+                        value, more ? js_false : js_true));
+}
+
+// ------------------------------------------------------------
+//
+// js_map_iter_entry_v
+//
+// steps an iterator, and stores the key and the value in
+// the specified array, for forEach () in mapset.js.
+// returns false when iteration is done.
+//
+// ------------------------------------------------------------
+
+static js_val js_map_iter_entry_v (js_c_func_args) {
+    js_prolog_stack_frame();
+
+    js_val iter_val = js_undefined, pair_val = js_undefined;
+    js_link *arg_ptr = stk_args;
+    if ((arg_ptr = arg_ptr->next) != js_stk_top) {
+        iter_val = arg_ptr->value;
+        if ((arg_ptr = arg_ptr->next) != js_stk_top)
+            pair_val = arg_ptr->value;
+    }
+
+    js_map_iter *it = js_map_iter_this(env, iter_val);
+    js_val key, val;
+    if (!js_map_iter_step(env, it, &key, &val))
+        js_return(js_false);
+
+    js_setprop(env, pair_val, js_make_number(0), key,
+               &env->dummy_shape_cache);
+    js_setprop(env, pair_val, js_make_number(1), val,
+               &env->dummy_shape_cache);
+    js_return(js_true);
+}
+
+// ------------------------------------------------------------
+//
+// js_map_iter_fast
+//
+// steps a map or set iterator for js_nextiter1 () in iter.c,
+// without creating a result object
+//
+// ------------------------------------------------------------
+
+static void js_map_iter_fast (js_environ *env, js_val *iter) {
+
+    js_map_iter *it = js_map_iter_this(env, iter[1]);
+    if (!js_map_iter_value(env, it, &iter[2]))
+        iter[0].raw = 0; // terminate iteration
+}
+
+// ------------------------------------------------------------
+//
+// js_map_iter_reuse
+//
+// called by js_newiter () in iter.c, with true if the loop
+// destructures each entry array, and does not keep it, so
+// the iterator can reuse a single entry array
+//
+// ------------------------------------------------------------
+
+static void js_map_iter_reuse (js_environ *env, js_val iter_val,
+                               bool reuse_pair) {
+
+    js_map_iter_this(env, iter_val)->reuse_pair = reuse_pair;
+}
+
+// ------------------------------------------------------------
+//
+// js_map_iter_gc_callback
+//
+// ------------------------------------------------------------
+
+static void js_map_iter_gc_callback (
+                js_gc_env *gc, js_priv *priv, int why) {
+
+    js_map_iter *it = priv->val_or_ptr.ptr;
+
+    if (why == 0) {
+        // if notified about collection, free iterator
+        js_free(it);
+        return;
+    }
+
+    js_gc_mark_val(gc, it->map_val);
+    if (it->pair.raw)
+        js_gc_mark_val(gc, it->pair);
 }
 
 // ------------------------------------------------------------
@@ -548,4 +1149,51 @@ void js_map_init (js_environ *env) {
     js_newprop(env, env->shadow_obj,
         js_str_c(env, "js_map_util")) =
             js_unnamed_func(js_map_util, 4);
+
+    // _shadow.map_sup
+    js_val map_sup = js_emptyobj(env);
+    js_newprop(env, env->shadow_obj,
+            js_str_c(env, "map_sup")) = map_sup;
+
+    static const struct {
+        const char *key, *name;
+        js_c_func c_func;
+        int num_args;
+    } methods[] = {
+        { "map_get",    "get",      js_map_get_v,    1 },
+        { "map_set",    "set",      js_map_set_v,    2 },
+        { "map_has",    "has",      js_map_has_v,    1 },
+        { "map_delete", "delete",   js_map_delete_v, 1 },
+        { "map_clear",  "clear",    js_map_clear_v,  0 },
+        { "map_size",   "get size", js_map_size_v,   0 },
+        { "set_add",    "add",      js_set_add_v,    1 },
+        { "set_has",    "has",      js_set_has_v,    1 },
+        { "set_delete", "delete",   js_set_delete_v, 1 },
+        { "set_clear",  "clear",    js_set_clear_v,  0 },
+        { "set_size",   "get size", js_set_size_v,   0 },
+        { "weakmap_get",    "get",    js_weakmap_get_v,    1 },
+        { "weakmap_set",    "set",    js_weakmap_set_v,    2 },
+        { "weakmap_has",    "has",    js_weakmap_has_v,    1 },
+        { "weakmap_delete", "delete", js_weakmap_delete_v, 1 },
+        { "weakset_add",    "add",    js_weakset_add_v,    1 },
+        { "weakset_has",    "has",    js_weakset_has_v,    1 },
+        { "weakset_delete", "delete", js_weakset_delete_v, 1 },
+        { "weakref_init",   "init",   js_weakref_init_v,   1 },
+        { "weakref_deref",  "deref",  js_weakref_deref_v,  0 },
+        { "finreg_get",     "get",    js_finreg_get_v,     1 },
+        { "finreg_set",     "set",    js_finreg_set_v,     2 },
+        { "finreg_take",    "take",   js_finreg_take_v,    0 },
+        { "finreg_size",    "size",   js_finreg_size_v,    0 },
+        { "iterator",   "iterator", js_map_iter_create_v, 3 },
+        { "iter_next",  "next",     js_map_iter_next_v,  0 },
+        { "iter_entry", "entry",    js_map_iter_entry_v, 2 },
+    };
+
+    for (int i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+        js_newprop(env, map_sup, js_str_c(env, methods[i].key)) =
+            js_newfunc(env, methods[i].c_func,
+                       js_str_c(env, methods[i].name), NULL,
+                       js_strict_mode | methods[i].num_args,
+                       /* closures */ 0);
+    }
 }
@@ -332,7 +332,7 @@ bool js_less_than (js_environ *env, int flags,
             // compare lexicographiclly.
             //
 
-            cmp = (js_str_compare(left, right) < 0);
+            cmp = (js_str_compare(env, left, right) < 0);
 
         } else if (js_is_primitive_bigint(right)) {
 
@@ -169,16 +169,22 @@ static void js_newobj2_spread (js_environ *env,
     js_obj *src_ptr = js_get_pointer(src);
     int index = 0;
 
+    // integer keys come first, either array elements, or
+    // from the element store of any other object, in which
+    // case we collect the indexes in advance, as a getter
+    // may modify the source object, see also elem.c
+    uint32_t *elem_indexes = NULL;
     uint32_t arr_length = 0;
     if (js_obj_is_exotic(src_ptr, js_obj_is_array)) {
         int64_t int_len =
             ((js_arr *)src_ptr)->length_descr[0].num;
         if (int_len > 0)
             arr_length = int_len;
-    }
+    } else
+        arr_length = js_elems_indexes(env, src_ptr, &elem_indexes);
 
     for (;;) {
-        js_val prop, src_value;
+        js_val prop, src_value, skip_prop;
 
         if (likely(arr_length == 0)) {
 
@@ -186,23 +192,34 @@ static void js_newobj2_spread (js_environ *env,
             if (!js_shape_get_next(src_ptr->shape,
                            &index, &prop_key, &idx_or_ptr))
                 break;
-            if (idx_or_ptr >= 0)
+            if (idx_or_ptr >= 0 || prop_key == env->elems_key)
                 continue;
             src_value = src_ptr->values[~idx_or_ptr];
             if (src_value.raw == js_deleted.raw)
                 continue;
-            prop = js_make_primitive(
+            skip_prop = prop = js_make_primitive(
                         prop_key, js_prim_is_string);
 
         } else {
 
             uint32_t prop_idx = ((uint32_t)index) + 1;
-            src_value = js_arr_get(src, prop_idx);
+            if (elem_indexes) {
+                prop_idx = elem_indexes[index] + 1;
+                src_value = js_elems_get(env, src_ptr, prop_idx);
+            } else
+                src_value = js_arr_get(src, prop_idx);
             if (++index == arr_length) {
                 index = 0;
                 arr_length = 0;
+                if (elem_indexes) {
+                    js_free(elem_indexes);
+                    elem_indexes = NULL;
+                }
             }
-            prop = js_str_index(env, prop_idx);
+            if (src_value.raw == js_deleted.raw)
+                continue;
+            prop = js_make_number(prop_idx - 1);
+            skip_prop = js_make_number(prop_idx);
         }
 
         //
@@ -233,7 +250,7 @@ static void js_newobj2_spread (js_environ *env,
                 const js_val prop2 = skip_list[i];
                 if (!prop2.raw)
                     break;
-                if (prop2.raw == prop.raw) {
+                if (prop2.raw == skip_prop.raw) {
                     i = -1;
                     break;
                 }
@@ -326,7 +343,7 @@ js_val js_newobj2 (js_environ *env, js_val obj, js_val proto,
 js_val js_restobj (js_environ *env, js_val from_obj,
                    int skip_count, ...) {
 
-    js_val skip_list[skip_count];
+    js_val skip_list[skip_count + 1];
     js_val *skip_list_ptr;
     if (!skip_count)
         skip_list_ptr = NULL;
@@ -334,11 +351,19 @@ js_val js_restobj (js_environ *env, js_val from_obj,
         va_list args;
         va_start(args, skip_count);
         for (int i = 0; i < skip_count; ++i) {
-            // make sure the property is interned,
-            // for comparison in js_newobj2_spread ()
-            skip_list[i] = js_make_primitive(
-                js_shape_key(env, va_arg(args, js_val)),
-                js_prim_is_string);
+            // make sure the property is interned, or for an
+            // integer key, is a number one beyond the index,
+            // so it is never zero, for comparison in
+            // js_newobj2_spread ()
+            js_val prop = va_arg(args, js_val);
+            if (js_is_object(prop))
+                prop = js_obj_to_primitive_string(env, prop);
+            const uint32_t prop_idx =
+                        js_str_is_length_or_number(env, prop);
+            skip_list[i] = prop_idx < js_len_index
+                ? js_make_number(prop_idx)
+                : js_make_primitive(js_shape_key(env, prop),
+                                    js_prim_is_string);
         }
         va_end(args);
         skip_list[skip_count].raw = 0;
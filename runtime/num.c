@@ -8,100 +8,154 @@ static char *js_num_digits =
 
 static uint64_t MAX_SAFE_INTEGER = 9007199254740991ULL;
 
+// the full product of two 64-bit integers, see numparse.c
+// and numfmt.c.
+// the type is a gcc extension, so mark it as such, to keep
+// -pedantic quiet
+__extension__ typedef unsigned __int128 js_num_u128;
+
+#include "numparse.c"
+
 // ------------------------------------------------------------
 //
-// js_tonumber_integer
+// js_num_scan_integer
+//
+// parses the digits in the given base, at the start of the
+// range between 'ptr' and 'end', and stores the value at
+// 'out'.  returns a pointer past the last digit, or NULL
+// if the range does not start with a digit
 //
 // ------------------------------------------------------------
 
-static js_val js_tonumber_integer (const char *ptr) {
+static const wchar_t *js_num_scan_integer (
+                    const wchar_t *ptr, const wchar_t *end,
+                    int base, double *out) {
+
+    const wchar_t *start = ptr;
+    uint64_t val = 0;
+    long double num = 0;    // extra precision past 64 bits
+    bool overflow = false;
+
+    // for a base which is not 10 or a power of two, we
+    // follow v8, which collects digits in 32-bit chunks,
+    // and adds each chunk to a double, so the rounding
+    // of long inputs matches
+    const bool chunked = base != 10 && (base & (base - 1));
+    uint32_t part = 0, mult = 1;
+    double chunks = 0;
+
+    for (; ptr < end; ptr++) {
+
+        wchar_t ch = *ptr;
+        uint32_t digit;
+        if (ch >= L'0' && ch <= L'9')
+            digit = ch - L'0';
+        else if ((ch |= 0x20) >= L'a' && ch <= L'z')
+            digit = ch - L'a' + 10;
+        else
+            break;
+        if (digit >= base)
+            break;
 
-    int base;
-    switch (*ptr) {
-        case 'b': case 'B':             base = 2;  break;
-        case 'o': case 'O': case '0':   base = 8;  break;
-        case 'x': case 'X':             base = 16; break;
-        case '\0':              return js_make_number(0);
-        default:                return js_nan;
+        if (chunked) {
+            if (mult * base > 0xFFFFFFFFU / 36) {
+                chunks = chunks * mult + part;
+                part = 0;
+                mult = 1;
+            }
+            part = part * base + digit;
+            mult *= base;
+
+        } else if (!overflow) {
+            if (val <= (UINT64_MAX - digit) / base)
+                val = val * base + digit;
+            else {
+                overflow = true;
+                num = (long double)val * base + digit;
+            }
+        } else
+            num = num * base + digit;
     }
-    char *stop;
-    uint64_t val = strtoull(++ptr, &stop, base);
-    if (*stop != '\0')
-        return js_nan;
-    return js_make_number(val);
+
+    if (ptr == start)
+        return NULL;
+
+    if (chunked)
+        *out = chunks * mult + part;
+    else if (!overflow)
+        *out = (double)val;
+    else if (base == 10) {
+        // get the correctly rounded result for long
+        // decimal integers, see js_num_scan_decimal ()
+        js_num_scan_decimal(start, ptr, out);
+    } else
+        *out = (double)num;
+
+    return ptr;
 }
 
 // ------------------------------------------------------------
 //
-// js_tonumber_decimal
+// js_tonumber_str
+//
+// converts a string to a number, as described for the
+// StringNumericLiteral grammar:  surrounding whitespace
+// is ignored, an empty string is zero, and otherwise the
+// entire string must be a decimal number with optional
+// sign, or Infinity, or an unsigned 0x/0o/0b integer
 //
 // ------------------------------------------------------------
 
-static js_val js_tonumber_decimal (
-                    const char *ptr, bool parse) {
+static js_val js_tonumber_str (js_environ *env, js_val val) {
+
+    const wchar_t *ptr = js_str_data(env, val);
+    const wchar_t *end = (const wchar_t *)((const char *)ptr
+                        + ((objset_id *)js_get_pointer(val))->len);
+
+    while (ptr < end && js_str_is_white_space(*ptr))
+        ptr++;
+    while (end > ptr && js_str_is_white_space(end[-1]))
+        end--;
+
+    if (ptr == end)
+        return js_make_number(0.0);
+
+    double num;
+
+    if (end - ptr > 2 && ptr[0] == L'0') {
+
+        int base = 0;
+        switch (ptr[1] | 0x20) {
+            case L'b':  base = 2;   break;
+            case L'o':  base = 8;   break;
+            case L'x':  base = 16;  break;
+        }
+        if (base) {
+            if (js_num_scan_integer(ptr + 2, end, base, &num) != end)
+                return js_nan;
+            return js_make_number(num);
+        }
+    }
 
-    js_val val;
     bool neg = false;
-    if (*ptr == '+')
+    if (*ptr == L'+')
         ptr++;
-    else if (*ptr == '-') {
+    else if (*ptr == L'-') {
         ptr++;
         neg = true;
     }
 
-    if (strcmp(ptr, "Infinity") == 0)
-        val.num = INFINITY;
-
-    else if (*ptr >= '0' && *ptr <= '9') {
-        char *stop;
-        val.num = strtod(ptr, &stop);
-        if (*stop != '\0' && !parse)
-            return js_nan;
-    } else
+    if (end - ptr == 8 && !memcmp(ptr, L"Infinity", 8 * sizeof(wchar_t)))
+        num = INFINITY;
+    else if (js_num_scan_decimal(ptr, end, &num) != end)
         return js_nan;
 
+    val.num = num;
     if (neg)
         val.raw |= 1ULL << 63;
-
     return val;
 }
 
-// ------------------------------------------------------------
-//
-// js_tonumber_toascii
-//
-// ------------------------------------------------------------
-
-static bool js_tonumber_toascii (js_val val, char *dst) {
-
-    const objset_id *id = js_get_pointer(val);
-    int len = id->len >> 1; // byte length to char count
-
-    // skip leading whitespace
-    const wchar_t *src = id->data;
-    while (len && js_str_is_white_space(*src)) {
-        len--;
-        src++;
-    }
-
-    if (!len)
-        return false;
-
-    // copy js string into null-terminated ascii buffer
-    if (len >= num_string_buffer_size - 4)
-        len  = num_string_buffer_size - 4;
-    for (;;) {
-        *dst++ = *src++;
-        if (!(--len))
-            break;
-        if (js_str_is_white_space(*src))
-            break;
-    }
-    *dst = '\0';
-
-    return true;
-}
-
 // ------------------------------------------------------------
 //
 // js_tonumber
@@ -135,26 +189,7 @@ static js_val js_tonumber (js_environ *env, js_val val) {
         js_callthrow("TypeError_expected_number");
     }
 
-    //
-    // convert a string to a number.  if starts with 0x,
-    // 0o, 0b, parse as hex, octal or binary, resepctively.
-    // if starts with 0., parse as number with fraction.
-    // otherwise parse as a decimal integer.
-    //
-
-    char *str = env->num_string_buffer;
-    if (!js_tonumber_toascii(val, str))
-        return js_make_number(0.0);
-
-    // parse ascii string as a number in one of two ways
-    if (str[0] == '0') {
-        const char ch = str[1];
-        const bool is_decimal_point_or_digit =
-                (ch == '.' || (ch >= '0' && ch <= '9'));
-        if (!is_decimal_point_or_digit)
-            return js_tonumber_integer(str + 1);
-    }
-    return js_tonumber_decimal(str, false);
+    return js_tonumber_str(env, val);
 }
 
 // ------------------------------------------------------------
@@ -275,6 +310,8 @@ static char *js_num_tostring_1 (
     return ch;
 }
 
+#include "numfmt.c"
+
 // ------------------------------------------------------------
 //
 // js_num_tostring_2
@@ -289,27 +326,72 @@ static char *js_num_tostring_2 (char *ch, double input) {
         return ch + 8;
     }
 
-    // the best way to approximate the output from
-    // v8 is to do exponential-format printf with
-    // 15 digits of precision, then edit the output
-    // string to discard extra zeroes
-    sprintf(ch, "%.15e", input);
-
-    // ch points at the last non-zero digit found,
-    // while ch2 advances forward to look for 'e'
+    // get the shortest digits that read back as the
+    // same number, see js_num_shortest () in numfmt.c,
+    // then place the decimal point as in the ecmascript
+    // Number::toString, where 'point' is the position
+    // of the decimal point relative to the first digit
+
+    int32_t exp10;
+    uint64_t output = js_num_shortest(input, &exp10);
+
+    char digits[24];
+    char *dig = digits + sizeof(digits);
+    do {
+        *--dig = '0' + (int)(output % 10);
+        output /= 10;
+    } while (output);
+
+    const int num_digits = (digits + sizeof(digits)) - dig;
+    const int point = exp10 + num_digits;
+
+    if (point >= num_digits && point <= 21) {
+        // integer, padded with zeroes:  1e20 --> 1000...
+        memcpy(ch, dig, num_digits);
+        ch += num_digits;
+        for (int i = num_digits; i < point; i++)
+            *ch++ = '0';
+
+    } else if (point > 0 && point <= 21) {
+        // decimal point within the digits:  123.456
+        memcpy(ch, dig, point);
+        ch += point;
+        *ch++ = '.';
+        memcpy(ch, dig + point, num_digits - point);
+        ch += num_digits - point;
 
-    char *ch2 = ++ch;
-    if (*ch2 == '.')
-        ch2++;
+    } else if (point > -6 && point <= 0) {
+        // leading zeroes:  0.000123
+        *ch++ = '0';
+        *ch++ = '.';
+        for (int i = point; i < 0; i++)
+            *ch++ = '0';
+        memcpy(ch, dig, num_digits);
+        ch += num_digits;
 
-    for (;;) {
-        if (*ch2 == 'e')
-            break;
-        if (*ch2++ != '0')
-            ch = ch2;
+    } else {
+        // exponential notation:  1.5e+300 or 5e-324
+        *ch++ = *dig;
+        if (num_digits > 1) {
+            *ch++ = '.';
+            memcpy(ch, dig + 1, num_digits - 1);
+            ch += num_digits - 1;
+        }
+        int exponent = point - 1;
+        *ch++ = 'e';
+        if (exponent < 0) {
+            *ch++ = '-';
+            exponent = -exponent;
+        } else
+            *ch++ = '+';
+        if (exponent >= 100)
+            *ch++ = '0' + exponent / 100;
+        if (exponent >= 10)
+            *ch++ = '0' + exponent / 10 % 10;
+        *ch++ = '0' + exponent % 10;
     }
 
-    return js_num_edit_exponent(ch, ch2);
+    return ch;
 }
 
 // ------------------------------------------------------------
@@ -321,6 +403,22 @@ static char *js_num_tostring_2 (char *ch, double input) {
 static js_val js_num_tostring (
                     js_environ *env, js_val val, int radix) {
 
+    // small integers are often converted to strings for
+    // use as property keys, so keep them as interned
+    // strings, created on first use
+    if (val.num < js_num_small_strings && radix == 10
+                && !(val.raw & (1ULL << 63))) {
+        const int idx = (int)val.num;
+        if (idx == val.num) {
+            js_val *str = &env->num_small_strings[idx];
+            if (unlikely(!str->raw)) {
+                // note that js_str_index () expects idx + 1
+                *str = js_str_index(env, idx + 1);
+            }
+            return *str;
+        }
+    }
+
     // if a number is not equal to itself, it is a NaN
     if (val.num != val.num)
         return env->str_nan;
@@ -333,16 +431,20 @@ static js_val js_num_tostring (
     }
 
     char *end;
-    if ((uint64_t)num == num) {
-        end = js_num_tostring_0(
-                    buf, (int)radix, (uint64_t)num);
-    } else {
-        double scale = (radix != 10) ? 0 : log10(num);
-        if (scale >= -6.0 && scale <= 21.0)
-            end = js_num_tostring_1(buf, radix, num);
+    if (radix == 10) {
+        // integers below 2^53 are exact, and are printed
+        // without a fraction or exponent, while anything
+        // else gets the shortest round-trip digits
+        if (num <= MAX_SAFE_INTEGER && (uint64_t)num == num)
+            end = js_num_tostring_0(buf, 10, (uint64_t)num);
         else
             end = js_num_tostring_2(buf, num);
-    }
+
+    } else if ((uint64_t)num == num) {
+        end = js_num_tostring_0(
+                    buf, (int)radix, (uint64_t)num);
+    } else
+        end = js_num_tostring_1(buf, radix, num);
 
     buf = env->num_string_buffer;
     return js_str_c2(env, buf, end - buf);
@@ -420,72 +522,77 @@ static js_val js_num_parse (js_environ *env,
                             js_val val, js_val radix) {
 
     // the operation of js parseInt () / parseFloat ()
-    // is a bit different than js_tonumber (), but also
-    // starts with stripping leading whitespace
+    // is a bit different than js_tonumber ():  leading
+    // whitespace is skipped, and then the longest prefix
+    // which is a valid number is parsed
 
-    char *str = env->num_string_buffer;
-    if (!js_tonumber_toascii(val, str))
-        return js_nan;
+    const wchar_t *ptr = js_str_data(env, val);
+    const wchar_t *end = (const wchar_t *)((const char *)ptr
+                        + ((objset_id *)js_get_pointer(val))->len);
+
+    while (ptr < end && js_str_is_white_space(*ptr))
+        ptr++;
+
+    // strip optional sign (+ or -)
+    bool neg = false;
+    if (ptr < end && *ptr == L'+')
+        ptr++;
+    else if (ptr < end && *ptr == L'-') {
+        ptr++;
+        neg = true;
+    }
+
+    double num;
 
     //
     // if radix was not specified, our caller
     // is parseFloat () in runtime2/number.js.
     //
 
-    if (js_is_undefined(radix))
-        return js_tonumber_decimal(str, true);
+    if (js_is_undefined(radix)) {
 
-    //
-    // otherwise we are called from parseInt ()
-    // which we implement here
-    //
+        if (end - ptr >= 8
+        &&  !memcmp(ptr, L"Infinity", 8 * sizeof(wchar_t)))
+            num = INFINITY;
+        else if (!js_num_scan_decimal(ptr, end, &num))
+            return js_nan;
 
-    if (!js_is_number(radix)) {
-        radix = js_tonumber(env, radix);
-        if (!js_is_number(radix))
-            js_callthrow("TypeError_invalid_argument");
-    }
+    } else {
 
-    // strip optional sign (+ or -)
-    bool neg = false;
-    if (*str == '+')
-        str++;
-    else if (*str == '-') {
-        str++;
-        neg = true;
-    }
+        //
+        // otherwise we are called from parseInt ()
+        // which we implement here
+        //
 
-    int base;
-    if (radix.num == radix.num && radix.num) {
-        // input radix is not zero and not NaN
-        base = radix.num;
-        if (base < 2 || base > 36)
-            return js_nan;
+        if (!js_is_number(radix)) {
+            radix = js_tonumber(env, radix);
+            if (!js_is_number(radix))
+                js_callthrow("TypeError_invalid_argument");
+        }
 
-    } else {
-        // if no radix specified, then strip leading
-        // zeroes, and an optional 0x prefix.  but
-        // if base 16, we let strtoull () handle it.
-        base = 10;
-        while (*str == '0') {
-            str++;
-            if (*str == 'x' || *str == 'X') {
-                str++;
-                base = 16;
-                break;
-            } else if (*str > '9')
+        int base;
+        bool strip_prefix = true;
+        if (radix.num == radix.num && radix.num) {
+            // input radix is not zero and not NaN
+            base = radix.num;
+            if (base < 2 || base > 36)
                 return js_nan;
-        }
-    }
+            strip_prefix = (base == 16);
 
-    //
-    // parse the integer and return it
-    //
+        } else
+            base = 10;
 
-    char *stop;
-    uint64_t num = strtoull(str, &stop, base);
-    if (stop == str)
-        return js_nan;
+        // if no radix specified, or radix 16,
+        // then strip an optional 0x prefix
+        if (strip_prefix && end - ptr >= 2 && ptr[0] == L'0'
+                         && (ptr[1] | 0x20) == L'x') {
+            ptr += 2;
+            base = 16;
+        }
+
+        if (!js_num_scan_integer(ptr, end, base, &num))
+            return js_nan;
+    }
 
     val.num = num;
     if (neg)
@@ -525,9 +632,10 @@ static js_val js_num_util (js_c_func_args) {
     }
 
     // second parameter is 'R' for paRse
-    if (which.num == /* 0x52 */ (double)'R'
-            && js_is_primitive_string(input)) {
+    if (which.num == /* 0x52 */ (double)'R') {
 
+        if (!js_is_primitive_string(input))
+            input = js_tostring(env, input);
         ret_val = js_num_parse(env, input, extra);
         js_return(ret_val);
     }
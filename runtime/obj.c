@@ -216,9 +216,46 @@ static js_val *js_ownprop (
     if (!js_is_object(obj))
         return NULL;
 
-    int64_t prop_key = js_shape_key(env, prop);
+    if (js_is_object(prop))
+        prop = js_obj_to_primitive_string(env, prop);
 
     js_obj *obj_ptr = js_get_pointer(obj);
+
+    // an integer index is never kept in the shape, it is
+    // either an array element, or in the element store of
+    // any other kind of object, see elem.c
+
+    const uint32_t prop_idx =
+                js_str_is_length_or_number(env, prop);
+
+    if (prop_idx < js_len_index) {
+
+        if (js_obj_is_exotic(obj_ptr, js_obj_is_array)) {
+
+            js_arr *arr = (js_arr *)obj_ptr;
+            if (js_arr_get(obj, prop_idx).raw == js_deleted.raw) {
+                if (!can_add)
+                    return NULL;
+                // grow the array, if necessary
+                js_arr_set(env, obj, prop_idx, js_deleted);
+            }
+            return &arr->values[prop_idx - 1];
+        }
+
+        if (!can_add) {
+            const js_elems *elems = js_elems_of(env, obj_ptr);
+            js_val *slot = elems
+                         ? js_elems_slot(elems, prop_idx) : NULL;
+            if (slot && slot->raw == js_deleted.raw)
+                slot = NULL;
+            return slot;
+        }
+
+        return js_elems_add(env, obj, prop_idx);
+    }
+
+    int64_t prop_key = js_shape_key(env, prop);
+
     js_shape *old_shape = obj_ptr->shape;
     js_shape *new_shape;
 
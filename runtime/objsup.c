@@ -118,6 +118,7 @@ static js_val js_getOrSetPrototype (js_c_func_args) {
                 // low 3 bits of obj->proto determine obj type
                 proto |= ((uintptr_t)obj_ptr->proto & 7);
                 obj_ptr->proto = (js_obj *)proto;
+                js_shape_epoch_bump(env);
 
                 // note that if the prototype of an array object
                 // is not equal Array.prototype, then indexing
@@ -155,6 +156,7 @@ static js_val js_preventExtensions (js_c_func_args) {
                             obj_ptr, js_obj_is_array)) {
                 // disable fast-path on this array
                 ((js_arr *)obj_ptr)->length = -1U;
+                js_shape_epoch_bump(env);
             }
         }
     }
@@ -208,8 +210,34 @@ static js_val js_keys_in_object (js_c_func_args) {
     js_val dst_arr = js_newarr(env, 0);
     uint32_t dst_idx = 0;
 
-    js_shape *shape =
-            ((js_obj *)js_get_pointer(obj_val))->shape;
+    // integer keys in the element store come first, in
+    // ascending order, see elem.c.  note that the keys
+    // are not interned, as they are not in the shape.
+    const js_obj *obj_ptr = js_get_pointer(obj_val);
+    if (!js_obj_is_exotic(obj_ptr, js_obj_is_array)) {
+
+        uint32_t *indexes;
+        const uint32_t num_indexes =
+                js_elems_indexes(env, obj_ptr, &indexes);
+        for (uint32_t i = 0; i < num_indexes; i++) {
+            // the gc may have already scanned the array,
+            // see also js_setprop ()
+            const js_val key = js_num_tostring(
+                        env, js_make_number(indexes[i]), 10);
+            js_gc_notify(env, key);
+            js_arr_set(env, dst_arr, ++dst_idx, key);
+        }
+        if (indexes)
+            js_free(indexes);
+    }
+
+    // integer keys which are too large for the element store
+    // come next, and are skipped below, see js_shape_get_keys ()
+    js_shape *shape = obj_ptr->shape;
+    const js_shape_keys *keys = js_shape_get_keys(shape);
+    for (uint32_t i = 0; i < keys->num_indexes; i++)
+        js_arr_set(env, dst_arr, ++dst_idx, keys->keys[i].key);
+
     int src_idx = 0;
 
     for (;;) {
@@ -223,9 +251,12 @@ static js_val js_keys_in_object (js_c_func_args) {
             continue;
 
         int kind = ((const objset_id *)prop_key)->flags;
-        if (kind & js_str_is_string)
+        if (kind & js_str_is_string) {
+            if (keys->num_indexes && js_shape_index_key(
+                            (const objset_id *)prop_key))
+                continue;
             kind = js_prim_is_string;
-        else if (kind & js_str_is_symbol)
+        } else if (kind & js_str_is_symbol)
             kind = js_prim_is_symbol;
         else
             continue;
@@ -237,6 +268,144 @@ static js_val js_keys_in_object (js_c_func_args) {
     js_return(dst_arr);
 }
 
+// ------------------------------------------------------------
+//
+// js_obj_is_enum_value
+//
+// returns true if a value slot holds a property which is
+// enumerable, i.e. it is neither deleted, nor a descriptor
+// without the enumerable flag
+//
+// ------------------------------------------------------------
+
+static bool js_obj_is_enum_value (js_val val) {
+
+    if (val.raw == js_deleted.raw)
+        return false;
+    return !js_is_descriptor(val)
+        || (js_descr_flags_without_setter(
+                (js_descriptor *)js_get_pointer(val))
+                                    & js_descr_enum);
+}
+
+// ------------------------------------------------------------
+//
+// js_obj_keys
+//
+// implements Object.keys (), Object.values () and
+// Object.entries ().  the first parameter is the object,
+// and the second is 'K', 'V' or 'E'.  integer keys come
+// first, then the string keys in the order of the list that
+// is cached in the shape, see js_shape_get_keys (), so each
+// value is read directly from its slot, without a lookup.
+// the slot is read again after each getter call, which may
+// delete properties, or make them non-enumerable.
+//
+// ------------------------------------------------------------
+
+static void js_obj_keys_push (js_environ *env, js_val dst_arr,
+                              uint32_t *dst_idx, int cmd,
+                              js_val obj, js_val key, js_val val) {
+
+    if (js_is_number(key))
+        key = js_num_tostring(env, key, 10);
+
+    if (cmd != 'K' && js_is_descriptor(val)) {
+        int64_t dummy_shape_cache;
+        val = js_getprop(env, obj, key, &dummy_shape_cache);
+    }
+
+    // the gc may have already scanned the array, and the
+    // key string, the getter result, or the entry array
+    // may be new, see also js_setprop ()
+    const js_val new_val = cmd == 'K' ? key
+                         : cmd == 'V' ? val
+                         : js_newarr(env, 2, key, val);
+    if (js_is_object_or_primitive(new_val))
+        js_gc_notify(env, new_val);
+    js_arr_set(env, dst_arr, ++*dst_idx, new_val);
+}
+
+static js_val js_obj_keys (js_c_func_args) {
+    js_prolog_stack_frame();
+
+    js_val obj_val = js_undefined;
+    int cmd = 'K';
+    js_link *arg_ptr = stk_args->next;
+    if (arg_ptr != js_stk_top) {
+        obj_val = arg_ptr->value;
+        if ((arg_ptr = arg_ptr->next) != js_stk_top)
+            cmd = (int)arg_ptr->value.num;
+    }
+
+    js_val dst_arr = js_newarr(env, 0);
+    uint32_t dst_idx = 0;
+
+    if (!js_is_object(obj_val)) {
+
+        // a string has an enumerable property for each
+        // character, other primitives have no properties
+        if (js_is_undefined_or_null(obj_val))
+            js_callthrow("TypeError_convert_null_to_object");
+        if (js_is_primitive_string(obj_val)) {
+            const uint32_t length =
+                ((objset_id *)js_get_pointer(obj_val))->len >> 1;
+            for (uint32_t index = 0; index < length; index++) {
+                js_obj_keys_push(env, dst_arr, &dst_idx, cmd,
+                    obj_val, js_make_number(index), js_str_char(
+                        env, js_str_data(env, obj_val)[index]));
+            }
+        }
+        js_return(dst_arr);
+    }
+
+    const js_obj *obj_ptr = js_get_pointer(obj_val);
+    if (js_obj_is_exotic(obj_ptr, js_obj_is_array)) {
+
+        // the length is checked on every step, as a getter
+        // may add or remove elements
+        const js_arr *arr = (const js_arr *)obj_ptr;
+        for (uint32_t index = 0;
+                index < (uint32_t)arr->length_descr[0].num
+             && index < arr->capacity; index++) {
+
+            const js_val val = arr->values[index];
+            if (js_obj_is_enum_value(val)) {
+                js_obj_keys_push(env, dst_arr, &dst_idx, cmd,
+                    obj_val, js_make_number(index), val);
+            }
+        }
+
+    } else {
+
+        uint32_t *indexes;
+        const uint32_t num_indexes =
+                js_elems_indexes(env, obj_ptr, &indexes);
+        for (uint32_t i = 0; i < num_indexes; i++) {
+            const js_val val =
+                    js_elems_get(env, obj_ptr, indexes[i] + 1);
+            if (js_obj_is_enum_value(val)) {
+                js_obj_keys_push(env, dst_arr, &dst_idx, cmd,
+                    obj_val, js_make_number(indexes[i]), val);
+            }
+        }
+        if (indexes)
+            js_free(indexes);
+    }
+
+    const js_shape_keys *keys = js_shape_get_keys(obj_ptr->shape);
+    for (uint32_t i = 0; i < keys->count; i++) {
+
+        const js_val val = obj_ptr->values[keys->keys[i].index];
+        if (js_obj_is_enum_value(val)) {
+            js_obj_keys_push(env, dst_arr, &dst_idx, cmd,
+                             obj_val, keys->keys[i].key, val);
+        }
+    }
+
+    js_return(dst_arr);
+}
+
 // ------------------------------------------------------------
 //
 // js_obj_init_2
@@ -297,6 +466,11 @@ static void js_obj_init_2 (js_environ *env) {
         js_str_c(env, "js_keys_in_object")) =
             js_unnamed_func(js_keys_in_object, 1);
 
+    // shadow.js_obj_keys
+    js_newprop(env, shadow,
+        js_str_c(env, "js_obj_keys")) =
+            js_unnamed_func(js_obj_keys, 2);
+
     // shadow.js_property_flags
     js_newprop(env, shadow,
         js_str_c(env, "js_property_flags")) =
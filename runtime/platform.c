@@ -91,6 +91,75 @@ void js_gc_walkstack2 (js_environ *env) {
 //
 // coroutines - Windows x64
 //
+// each coroutine runs in a fiber, which is recorded in a
+// js_coroutine_stack.  when a coroutine terminates, its
+// fiber does not exit, and can be reused for the next
+// coroutine, see js_coroutine_fiber ().  fibers are created
+// with the stack size configured in the pool, and Windows
+// reserves this size, but commits pages only as needed,
+// with a guard page below the committed part of the stack.
+//
+// ------------------------------------------------------------
+
+typedef struct js_coroutine_stack {
+
+    void *fiber;
+    js_coroutine_context *ctx;
+    js_coroutine_pool *pool;
+    struct js_coroutine_stack *next;
+    int size;
+    bool ended;
+
+} js_coroutine_stack;
+
+// ------------------------------------------------------------
+
+static void js_coroutine_stack_used (js_coroutine_stack *stk) {
+
+    // the committed part of the current stack is an upper
+    // bound on the stack used, which we record in the pool
+    NT_TIB *tib = (NT_TIB *)__readgsqword(0x30);
+    int used = (int)((char *)tib->StackBase
+                   - (char *)tib->StackLimit);
+    if (used > stk->pool->max_stack_used)
+        stk->pool->max_stack_used = used;
+}
+
+// ------------------------------------------------------------
+
+static void WINAPI js_coroutine_fiber (void *_stk) {
+
+    js_coroutine_stack *stk = _stk;
+    for (;;) {
+
+        js_coroutine_context *ctx = stk->ctx;
+        js_environ *env = ctx->env;
+        js_coroutine_init3(ctx);
+        js_coroutine_stack_used(stk);
+
+        // last switch out of terminating coroutine
+        stk->ended = true;
+        void *other_fiber = (void *)ctx->internal;
+        ctx->internal = (uintptr_t)GetCurrentFiber();
+        SwitchToFiber(other_fiber);
+
+        // until the coroutine is killed, we may still be
+        // called by js_gc_stackwalk2 (), but there is
+        // nothing left on this stack, so just switch back
+        for (;;) {
+            void *fiber_of_gc_caller = (void *)
+                env->coroutine_contexts->internal;
+            if (!fiber_of_gc_caller)
+                break;
+            SwitchToFiber(fiber_of_gc_caller);
+        }
+
+        // if we reach here, js_coroutine_init2 () has
+        // taken this stack from the pool, and set stk->ctx
+        stk->ended = false;
+    }
+}
+
 // ------------------------------------------------------------
 
 void js_coroutine_init2 (
@@ -109,25 +178,99 @@ void js_coroutine_init2 (
         env->coroutine_contexts->internal2 = old_fiber;
     }
 
-    void *new_fiber =
-                CreateFiber(0, js_coroutine_init3, ctx);
+    // take a stack from the pool, if there is one
+    js_coroutine_pool *pool = js_coroutine_get_pool(env);
+    js_mutex_enter(pool->mutex);
+    js_coroutine_stack *stk = pool->free_list;
+    if (stk) {
+        pool->free_list = stk->next;
+        pool->num_free--;
+        pool->num_reused++;
+    } else
+        pool->num_created++;
+    if (++pool->num_active > pool->max_active)
+        pool->max_active = pool->num_active;
+    js_mutex_leave(pool->mutex);
+
+    if (!stk) {
+        stk = malloc(sizeof(js_coroutine_stack));
+        if (stk) {
+            stk->pool = pool;
+            stk->size = pool->stack_size;
+            stk->fiber = CreateFiberEx(0, stk->size, 0,
+                                       js_coroutine_fiber, stk);
+        }
+    }
 
-    if (!old_fiber || !new_fiber) {
+    if (!old_fiber || !stk || !stk->fiber) {
         fprintf(stderr, "Fiber error!\n");
         exit(1);
     }
 
+    stk->ctx = ctx;
+    stk->ended = false;
+    ctx->stack = stk;
     ctx->internal = (uintptr_t)old_fiber;
-    ctx->internal2 = new_fiber;
-    SwitchToFiber(new_fiber);
+    ctx->internal2 = stk->fiber;
+    SwitchToFiber(stk->fiber);
 }
 
 // ------------------------------------------------------------
 
 void js_coroutine_kill2 (js_coroutine_context *ctx) {
 
-    DeleteFiber(ctx->internal2);
+    // the stack of a coroutine which has terminated
+    // can be reused, but a coroutine which is killed
+    // while suspended still has frames on its stack.
+    // note that we may be called from the gc thread
+    js_coroutine_stack *stk = ctx->stack;
+    js_coroutine_pool *pool = stk->pool;
+
+    js_mutex_enter(pool->mutex);
+    pool->num_active--;
+    const bool reuse = stk->ended
+                    && stk->size == pool->stack_size
+                    && pool->num_free < pool->max_free;
+    if (reuse) {
+        stk->ctx = NULL;
+        stk->next = pool->free_list;
+        pool->free_list = stk;
+        pool->num_free++;
+    }
+    js_mutex_leave(pool->mutex);
+
+    if (!reuse) {
+        DeleteFiber(stk->fiber);
+        free(stk);
+    }
     ctx->internal2 = NULL;
+    ctx->stack = NULL;
+}
+
+// ------------------------------------------------------------
+
+void js_coroutine_config2 (js_coroutine_pool *pool,
+                           int stack_size, int max_free) {
+
+    // delete pooled stacks which no longer fit the
+    // configuration, see also js_coroutine_kill2 ()
+    js_mutex_enter(pool->mutex);
+    pool->stack_size = stack_size;
+    pool->max_free = max_free;
+    js_coroutine_stack **p_stk = &pool->free_list;
+    while (*p_stk) {
+        js_coroutine_stack *stk = *p_stk;
+        if (stk->size == stack_size && max_free > 0) {
+            max_free--;
+            p_stk = &stk->next;
+        } else {
+            *p_stk = stk->next;
+            pool->num_free--;
+            DeleteFiber(stk->fiber);
+            free(stk);
+        }
+    }
+    js_mutex_leave(pool->mutex);
 }
 
 // ------------------------------------------------------------
@@ -135,8 +278,12 @@ void js_coroutine_kill2 (js_coroutine_context *ctx) {
 void js_coroutine_switch2 (
         js_coroutine_context *ctx, int *state, js_val *val) {
 
-    if (!ctx)
-        ctx = GetFiberData();
+    if (!ctx) {
+        // called in the coroutine, see js_yield ()
+        js_coroutine_stack *stk = GetFiberData();
+        js_coroutine_stack_used(stk);
+        ctx = stk->ctx;
+    }
 
     ctx->value = *val;
     ctx->state = *state;
@@ -206,6 +353,25 @@ uint64_t js_current_time () {
     return u.u64 * 10;
 }
 
+// ------------------------------------------------------------
+//
+// js_stdout_init - Windows x64
+//
+// prepares the console for the utf-8 output written by
+// js_str_output () in strsup.c, and returns true if
+// stdout is the console, rather than a file or pipe
+//
+// ------------------------------------------------------------
+
+bool js_stdout_init () {
+
+    HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (GetFileType(handle) != FILE_TYPE_CHAR)
+        return false;
+    SetConsoleOutputCP(CP_UTF8);
+    return true;
+}
+
 // ------------------------------------------------------------
 //
 // js_elapsed_time - Windows x64
@@ -11,6 +11,9 @@ static js_val js_getprop_proxy (
 static bool js_delprop_proxy (
                 js_environ *env, js_val obj, js_val prop);
 
+static js_val js_delprop_value (
+            js_environ *env, js_val *old_ptr, js_val prop);
+
 static int js_hasprop_proxy (
                 js_environ *env, js_val obj, js_val prop);
 
@@ -72,10 +75,16 @@ js_val js_getprop (js_environ *env, js_val obj, js_val prop,
     }
 
     //
-    // main loop for getprop
+    // main loop for getprop.  an integer index is never
+    // kept in the shape, but as an array element, or in
+    // the element store of other objects, see elem.c
     //
 
-    uint32_t prop_idx = 0;
+    if (js_is_object(prop))
+        prop = js_obj_to_primitive_string(env, prop);
+
+    const uint32_t prop_idx =
+                js_str_is_length_or_number(env, prop);
     int64_t prop_key = 0;
 
     for (;;) {
@@ -86,26 +95,28 @@ js_val js_getprop (js_environ *env, js_val obj, js_val prop,
 
         if ((proto & 7) == js_obj_is_array) {
 
-            if (!prop_idx) {
-                prop_idx = js_str_is_length_or_number(
-                                env, prop);
-            }
-
             if (prop_idx < js_len_index) {
                 // returns js_deleted if no such element,
                 // so we continue on the prototype chain.
                 // this should be the case with any 'hole'
                 // index in the array, whether below or
                 // beyond the actual length of the array
-                get_val = js_arr_get(obj, prop_idx);
+                get_val = js_arr_get(
+                        js_make_object(obj_ptr), prop_idx);
             }
 
-        } else if ((proto & 7) == js_obj_is_proxy) {
+        } else {
+
+            if ((proto & 7) == js_obj_is_proxy)
+                get_val = js_getprop_proxy(env, obj, prop);
 
-            get_val = js_getprop_proxy(env, obj, prop);
+            if (get_val.raw == js_deleted.raw
+                            && prop_idx < js_len_index)
+                get_val = js_elems_get(env, obj_ptr, prop_idx);
         }
 
-        if (get_val.raw == js_deleted.raw) {
+        if (get_val.raw == js_deleted.raw
+                            && prop_idx >= js_len_index) {
 
             if (!prop_key)
                 prop_key = js_shape_key(env, prop);
@@ -253,55 +264,12 @@ js_val js_delprop (
     // be an array or a proxy, otherwise a plain object
     //
 
-    js_obj *obj_ptr = js_get_pointer(obj);
-    uintptr_t proto = (uintptr_t)obj_ptr->proto;
-
-    if ((proto & 7) == js_obj_is_array) {
-
-        // delete an integer index on an array object:
-        // disallowed only if the array index exists
-        // and is a non-configurable descriptor.
-
-        uint32_t prop_idx =
-                js_str_is_length_or_number(env, prop);
-
-        if (prop_idx < js_len_index) {
-
-            js_val old_val = js_arr_get(obj, prop_idx);
-
-            if (old_val.raw == js_deleted.raw) {
-                // delete non-existent element is ok
-                return js_true;
-            }
-
-            if (!js_is_descriptor(old_val)) {
-                // delete a plain, non-descriptor element
-                js_arr_set(env, obj, prop_idx, js_deleted);
-                return js_true;
-            }
-
-            // configurable descriptor must be freed
-            // in addition to marking the array element
+    if (js_is_object(prop))
+        prop = js_obj_to_primitive_string(env, prop);
 
-            js_descriptor *descr =
-                                js_get_pointer(old_val);
-            const int flags =
-                    js_descr_flags_without_setter(descr);
-
-            if (flags & js_descr_config) {
-                // ok to delete non-configurable element
-                js_arr_set(env, obj, prop_idx, js_deleted);
-                js_gc_free(env, descr);
-                return js_true;
-            }
-
-            // cannot delete a non-configurable property
-            js_throw_if_strict_1(
-                        "TypeError_deleteProperty", prop);
-            return js_false;
-        }
+    js_obj *obj_ptr = js_get_pointer(obj);
 
-    } else if ((proto & 7) == js_obj_is_proxy) {
+    if (js_obj_is_exotic(obj_ptr, js_obj_is_proxy)) {
 
         // proxy deletion.  if proxy implements the delete
         // trap, and the delete trap returns false, then
@@ -312,6 +280,20 @@ js_val js_delprop (
             return js_false;
     }
 
+    if (js_str_is_length_or_number(env, prop) < js_len_index) {
+
+        // delete an integer index, which is an array
+        // element, or is in the element store of any
+        // other object, see js_ownprop ().  returns
+        // NULL if the element does not exist.
+
+        js_val *old_ptr = js_ownprop(env, obj, prop, false);
+        if (!old_ptr)
+            return js_true;
+
+        return js_delprop_value(env, old_ptr, prop);
+    }
+
     //
     // look for the property on a plain object.  we also
     // reach here for a 'length' property on an array,
@@ -325,44 +307,57 @@ js_val js_delprop (
             obj_ptr->shape, prop_key, &idx_or_ptr)
                                     && idx_or_ptr < 0) {
 
-        js_val old_val = obj_ptr->values[~idx_or_ptr];
-
         // invalidate any shape cached for this object,
         // see js_defineProperty_object () in descr2.c
         obj_ptr->shape_id = ++env->next_unique_id;
+        js_shape_epoch_bump(env);
 
-        if (old_val.raw != js_deleted.raw) {
+        return js_delprop_value(
+                    env, &obj_ptr->values[~idx_or_ptr], prop);
+    }
 
-            if (!js_is_descriptor(old_val)) {
-                // delete a plain, non-descriptor element
-                obj_ptr->values[~idx_or_ptr] = js_deleted;
-                return js_true;
-            }
+    // property was not found on the object, ok to delete
+    return js_true;
+}
 
-            // configurable descriptor must be freed
-            // in addition to marking the array element
+// ------------------------------------------------------------
+//
+// js_delprop_value
+//
+// ------------------------------------------------------------
 
-            js_descriptor *descr =
-                                js_get_pointer(old_val);
-            const int flags =
-                    js_descr_flags_without_setter(descr);
+static js_val js_delprop_value (
+            js_environ *env, js_val *old_ptr, js_val prop) {
 
-            if (flags & js_descr_config) {
-                // ok to delete non-configurable element
-                obj_ptr->values[~idx_or_ptr] = js_deleted;
-                js_gc_free(env, descr);
-                return js_true;
-            }
+    js_val old_val = *old_ptr;
 
-            // cannot delete a non-configurable property
-            js_throw_if_strict_1(
-                        "TypeError_deleteProperty", prop);
-            return js_false;
-        }
+    if (old_val.raw == js_deleted.raw) {
+        // delete non-existent element is ok
+        return js_true;
     }
 
-    // property was not found on the object, ok to delete
-    return js_true;
+    if (!js_is_descriptor(old_val)) {
+        // delete a plain, non-descriptor element
+        *old_ptr = js_deleted;
+        return js_true;
+    }
+
+    // configurable descriptor must be freed
+    // in addition to marking the element
+
+    js_descriptor *descr = js_get_pointer(old_val);
+    const int flags = js_descr_flags_without_setter(descr);
+
+    if (flags & js_descr_config) {
+        // ok to delete a configurable element
+        *old_ptr = js_deleted;
+        js_gc_free(env, descr);
+        return js_true;
+    }
+
+    // cannot delete a non-configurable property
+    js_throw_if_strict_1("TypeError_deleteProperty", prop);
+    return js_false;
 }
 
 // ------------------------------------------------------------
@@ -391,10 +386,14 @@ bool js_hasprop (js_environ *env, js_val obj, js_val prop) {
     js_obj *obj_ptr = js_get_pointer(obj);
 
     //
-    // main loop for hasprop
+    // main loop for hasprop, see also js_getprop ()
     //
 
-    uint32_t prop_idx = 0;
+    if (js_is_object(prop))
+        prop = js_obj_to_primitive_string(env, prop);
+
+    const uint32_t prop_idx =
+                js_str_is_length_or_number(env, prop);
     int64_t prop_key = 0;
 
     for (;;) {
@@ -404,28 +403,31 @@ bool js_hasprop (js_environ *env, js_val obj, js_val prop) {
 
         if ((proto & 7) == js_obj_is_array) {
 
-            if (!prop_idx) {
-                prop_idx = js_str_is_length_or_number(
-                                env, prop);
-            }
-
             if (prop_idx < js_len_index) {
                 // returns js_deleted if no such element,
                 // so we continue on the prototype chain.
                 // this should be the case with any 'hole'
                 // index in the array, whether below or
                 // beyond the actual length of the array
-                get_val = js_arr_get(obj, prop_idx);
+                get_val = js_arr_get(
+                        js_make_object(obj_ptr), prop_idx);
             }
 
-        } else if ((proto & 7) == js_obj_is_proxy) {
+        } else {
+
+            if ((proto & 7) == js_obj_is_proxy) {
+
+                int proxy_has = js_hasprop_proxy(env, obj, prop);
+                if (proxy_has != -1)
+                    return proxy_has;
+            }
 
-            int proxy_has = js_hasprop_proxy(env, obj, prop);
-            if (proxy_has != -1)
-                return proxy_has;
+            if (prop_idx < js_len_index)
+                get_val = js_elems_get(env, obj_ptr, prop_idx);
         }
 
-        if (get_val.raw == js_deleted.raw) {
+        if (get_val.raw == js_deleted.raw
+                            && prop_idx >= js_len_index) {
 
             if (!prop_key)
                 prop_key = js_shape_key(env, prop);
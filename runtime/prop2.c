@@ -14,12 +14,18 @@ static void js_setprop_array (js_environ *env, js_val obj,
                             js_val prop, uint32_t prop_idx,
                             js_val value);
 
+static void js_setprop_elems (js_environ *env,
+                            js_val obj, js_obj *obj_ptr,
+                            js_val prop, uint32_t prop_idx,
+                            js_val value);
+
 static bool js_setprop_proxy (js_environ *env, js_val obj,
                             js_val prop, js_val value);
 
 static bool js_setprop_prototype (js_environ *env,
                             js_val obj, js_obj *obj_ptr,
-                            int64_t prop_key, js_val value,
+                            int64_t prop_key, uint32_t prop_idx,
+                            js_val value,
                         js_val prop_name_in_case_of_error);
 
 static void js_throw_if_primitive (js_environ *env, js_val obj);
@@ -100,13 +106,16 @@ js_val js_setprop (js_environ *env, js_val obj, js_val prop,
     // via either a fast-path or slow-path function.
     //
 
+    if (js_is_object(prop))
+        prop = js_obj_to_primitive_string(env, prop);
+
+    const uint32_t prop_idx =
+                js_str_is_length_or_number(env, prop);
+
     uintptr_t proto = (uintptr_t)obj_ptr->proto;
 
     if ((proto & 7) == js_obj_is_array) {
 
-        uint32_t prop_idx =
-                    js_str_is_length_or_number(env, prop);
-
         if (prop_idx != js_not_index) {
 
             if (unlikely(prop_idx == js_len_index)) {
@@ -148,24 +157,34 @@ js_val js_setprop (js_environ *env, js_val obj, js_val prop,
     }
 
     //
-    // otherwise the property name is a string or symbol
-    // primitive values which is set via the object shape.
+    // an integer index on any other object is set in the
+    // element store, see elem.c.  otherwise the property
+    // name is a string or symbol primitive value which
+    // is set via the object shape.
     //
 
-    js_setprop_object(
-            env, obj, obj_ptr, prop, value, shape_cache);
+    if (prop_idx < js_len_index) {
+
+        js_setprop_elems(
+                env, obj, obj_ptr, prop, prop_idx, value);
+
+    } else {
+
+        js_setprop_object(
+                env, obj, obj_ptr, prop, value, shape_cache);
+    }
 
     if (   (obj_ptr == env->obj_proto
          || obj_ptr == env->arr_proto)) {
 
-        if (js_str_is_length_or_number(env, prop)
-                                        != js_not_index) {
+        if (prop_idx != js_not_index) {
             //
             // if an integer property is added on
             // Object.prototype or Array.prototype,
             // then disable the array fast-path
             //
             env->fast_arr_proto = NULL;
+            js_shape_epoch_bump(env);
         }
     }
 
@@ -233,7 +252,7 @@ static void js_setprop_object (js_environ *env,
                 // to prevent setting property on this object.
                 if (!js_setprop_prototype(
                                 env, obj, obj_ptr, prop_key,
-                                value, prop))
+                                js_not_index, value, prop))
                     return;
             }
 
@@ -257,8 +276,8 @@ static void js_setprop_object (js_environ *env,
     // was called.  otherwise returns true and we can add
     // the new property to the initial object
 
-    if (!js_setprop_prototype(
-                env, obj, obj_ptr, prop_key, value, prop))
+    if (!js_setprop_prototype(env, obj, obj_ptr,
+                prop_key, js_not_index, value, prop))
         return;
 
     if (obj.raw == env->global_obj.raw) {
@@ -339,10 +358,9 @@ static void js_setprop_array (js_environ *env, js_val obj,
                 // not a writable value, or if a setter function
                 // was called.  returns true if there is nothing
                 // to prevent setting property on this object.
-                const int64_t prop_key = js_shape_key(env, prop);
                 if (!js_setprop_prototype(
-                            env, obj, &arr->super, prop_key,
-                            value, prop))
+                            env, obj, &arr->super, 0,
+                            prop_idx, value, prop))
                     return;
             }
         }
@@ -357,9 +375,8 @@ static void js_setprop_array (js_environ *env, js_val obj,
         // returns false if not writable, or a setter function
         // was called.  otherwise returns true and we can add
         // the new property to the initial object
-        const int64_t prop_key = js_shape_key(env, prop);
-        if (!js_setprop_prototype(
-                env, obj, &arr->super, prop_key, value, prop))
+        if (!js_setprop_prototype(env, obj, &arr->super,
+                                  0, prop_idx, value, prop))
             return;
     }
 
@@ -376,6 +393,65 @@ static void js_setprop_array (js_environ *env, js_val obj,
     js_arr_set(env, obj, prop_idx, value);
 }
 
+// ------------------------------------------------------------
+//
+// js_setprop_elems
+//
+// sets an integer index on an object which is not an array,
+// in the element store of the object, see also elem.c
+//
+// ------------------------------------------------------------
+
+static void js_setprop_elems (js_environ *env,
+                            js_val obj, js_obj *obj_ptr,
+                            js_val prop, uint32_t prop_idx,
+                            js_val value) {
+
+    js_elems *elems = js_elems_of(env, obj_ptr);
+    js_val *old_ptr = elems ? js_elems_slot(elems, prop_idx)
+                            : NULL;
+
+    if (old_ptr && old_ptr->raw != js_deleted.raw) {
+
+        if (js_is_descriptor(*old_ptr)) {
+            // valid descriptor;  check if property can
+            // be updated, by updating a writable value,
+            // or calling a setter function
+            if (js_descr_check_writable(
+                            env, *old_ptr, obj, value,
+                            js_is_object(obj), prop)) {
+                js_throw_if_primitive(env, obj);
+            }
+
+            return;
+        }
+
+        // with a primitive value, obj_ptr points to the
+        // prototype, which should not be modified here
+        js_throw_if_primitive(env, obj);
+        if (js_is_object(obj))
+            *old_ptr = value;
+        return;
+    }
+
+    // check if prototype chain permits setting the value.
+    // returns false if not writable, or a setter function
+    // was called.  otherwise returns true and we can add
+    // the new property to the initial object
+
+    if (!js_setprop_prototype(env, obj, obj_ptr,
+                              0, prop_idx, value, prop))
+        return;
+
+    js_throw_if_primitive(env, obj);
+    if (!js_is_object(obj))
+        return; // not strict mode, just silently ignore
+    if (js_throw_if_not_extensible(env, obj, prop, false))
+        return; // not strict mode, just silently ignore
+
+    *js_elems_add(env, obj, prop_idx) = value;
+}
+
 // ------------------------------------------------------------
 //
 // js_setprop_array_length
@@ -490,7 +566,8 @@ static bool js_setprop_proxy (js_environ *env, js_val obj,
 
 static bool js_setprop_prototype (js_environ *env,
                             js_val obj, js_obj *obj_ptr,
-                            int64_t prop_key, js_val value,
+                            int64_t prop_key, uint32_t prop_idx,
+                            js_val value,
                         js_val prop_name_in_case_of_error) {
 
     if (!obj_ptr) {
@@ -506,29 +583,29 @@ static bool js_setprop_prototype (js_environ *env,
 
         if ((proto & 7) == js_obj_is_array) {
 
-            const uint32_t prop_idx =
-                js_str_is_length_or_number(env,
-                    js_make_primitive(
-                        prop_key, js_prim_is_string));
-
             if (prop_idx < js_len_index) {
                 // returns js_deleted if no such element
-                old_val = js_arr_get(obj, prop_idx);
+                old_val = js_arr_get(
+                        js_make_object(obj_ptr), prop_idx);
             }
 
-        } else if ((proto & 7) == js_obj_is_proxy) {
+        } else {
 
-            const js_val prop =
-                    js_make_primitive(
-                        prop_key, js_prim_is_string);
+            if ((proto & 7) == js_obj_is_proxy) {
 
-            if (js_setprop_proxy(env, obj, prop, value)) {
-                // proxy trap was called
-                return false;
+                if (js_setprop_proxy(env, obj,
+                        prop_name_in_case_of_error, value)) {
+                    // proxy trap was called
+                    return false;
+                }
             }
+
+            if (prop_idx < js_len_index)
+                old_val = js_elems_get(env, obj_ptr, prop_idx);
         }
 
-        if (old_val.raw == js_deleted.raw) {
+        if (old_val.raw == js_deleted.raw
+                            && prop_idx >= js_len_index) {
 
             int64_t idx_or_ptr;
             if (js_shape_value(
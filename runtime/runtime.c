@@ -11,6 +11,9 @@
 #include <string.h>
 #include <math.h>
 #include <float.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #undef environ // defined in stdlib.h
 
 #include "include/intmap.h"
@@ -37,10 +40,19 @@
 // add in advance when shape changes in js_shape_switch ()
 #define js_obj_grow_factor 3
 
+// number of small integers for which js_num_tostring ()
+// keeps an interned string in env->num_small_strings
+#define js_num_small_strings 1024
+
 // get the prototype of an object
 #define js_obj_get_proto(obj_ptr) \
     ((js_obj *)((uintptr_t)(obj_ptr)->proto & ~7))
 
+// invalidate guards checked once before a loop, rather
+// than on every iteration.  zero is never a valid epoch
+#define js_shape_epoch_bump(env)                    \
+    ((void)(++(env)->shape_epoch || ++(env)->shape_epoch))
+
 // create an anonymous function with no closures
 #define js_unnamed_func(c_func,num_args)            \
     js_newfunc(env, (c_func), env->str_empty, NULL, \
@@ -55,12 +67,15 @@
 // bit 31 - reserved for js_obj_not_extensible
 // bit 30 - value was seen by the garbage collector.
 // bit 29 - js_setprop () notifying value reference.
+// bit 28 - object is a key in a weak collection, and
+// is only freed by the main thread, see js_gc_purge_weak ()
 // used in js_obj->max_values for objects.
 // used in the length (i.e. first) word for bigints.
 // used in objset_id->flags for strings and symbols,
 // a 16-bit field, so right-shifted to bits
 #define js_gc_marked_bit 0x40000000U
 #define js_gc_notify_bit 0x20000000U
+#define js_gc_weak_bit   0x10000000U
 
 // ------------------------------------------------------------
 //
@@ -68,9 +83,17 @@
 //
 // ------------------------------------------------------------
 
-typedef struct js_try js_try;
 typedef struct js_gc_env js_gc_env;
 
+// the location of an own property, which is valid while
+// the object keeps the same shape, see js_iter_slot_holds ()
+typedef struct js_iter_slot {
+
+    js_shape *shape;
+    int index;
+
+} js_iter_slot;
+
 struct js_environ {
 
     // what we declare below is the public part at the start
@@ -89,6 +112,11 @@ struct js_environ {
     // dummy shape cache field, if no shape cache variable
     int64_t dummy_shape_cache;
 
+    // incremented whenever a cached property slot or the
+    // array fast-path may have become invalid, so a loop
+    // can check guards once, see loop_guard_scanner.js
+    uint64_t shape_epoch;
+
     // current value of the new.target meta property
     js_val new_target;
 
@@ -115,12 +143,20 @@ struct js_environ {
     int internal_flags;  // various jsf_xxx flags
 
     int next_unique_id;
+    int64_t elems_key;      // see js_elems_init ()
     uint64_t math_random_state;
     js_gc_env *gc;
 
     js_try *try_handler;
     js_val shadow_obj;
     objset *strings_set;
+    js_val str_chars[256];  // see js_str_char ()
+
+    // console output, see js_str_output ()
+    char *out_buffer;
+    int out_length;
+    bool out_interactive;
+
     js_val obj_constructor; // Object constructor
 
     js_obj *obj_proto;      // Object.prototype
@@ -152,15 +188,28 @@ struct js_environ {
     js_val sym_hasInstance;
     js_val sym_toPrimitive;
     js_val sym_unscopables;
+    js_val sym_match;
 
     // number
     char *num_string_buffer;
+    js_val num_small_strings[js_num_small_strings];
 
     // iterator
-    js_val for_in_iterator;
+    js_val arr_iterator;        // see js_iter_pristine ()
+    js_val arr_iterator_next;
+    js_val arr_iterator_proto;
+    js_val str_iterator;
+    js_val str_iterator_next;
+    js_val str_iterator_proto;
+    js_iter_slot arr_iterator_slot;
+    js_iter_slot arr_iterator_next_slot;
+    js_iter_slot str_iterator_slot;
+    js_iter_slot str_iterator_next_slot;
 
     // coroutines
     struct js_coroutine_context *coroutine_contexts;
+    struct js_coroutine_pool *coroutine_pool;
+    js_genframe *genframe;  // see js_genenter ()
 };
 
 // ------------------------------------------------------------
@@ -207,6 +256,7 @@ struct js_priv {
 #include "coroutine.c"
 #include "func.c"
 #include "arr.c"
+#include "elem.c"
 #include "big1.c"
 #include "big2.c"
 #include "mix.c"
@@ -78,9 +78,10 @@ typedef union js_val { double num; uint64_t raw; } js_val;
 #define js_bool_test_value      (js_dynamic_type_mask | 0x0100L)
 #define js_is_boolean(v)        ((((v).raw) & js_bool_test_mask) == js_bool_test_value)
 
-// this flag may be passed to js_newfunc in the arity parameter
+// these flags may be passed to js_newfunc in the arity parameter
 #define js_strict_mode          0x80000000U
 #define js_not_constructor      0x40000000U
+#define js_legacy_arguments     0x20000000U
 
 // these special values may be passed to js_newobj2 ()
 #define js_next_is_getter       ((js_val){ .raw = js_dynamic_type_mask | 0x1111 })
@@ -158,15 +159,18 @@ typedef struct js_link js_link;
 #define js_str_is_static   8
 
 // define a string from a const memory layout declared as:
-// static wchar_t [] { len, len, flg, char, char, ... }
+// static wchar_t [] { len, len, flg, 0, hash, hash, char, ... }
 // this precisely matches the memory layout of objset_id.
 // the runtime assumes ownership of the passed string.
 js_val js_newstr (js_environ *env, const wchar_t *ptr);
 
-#define js_newstr_prefix(len,intern) \
+// the hash is calculated by the compiler, because the
+// memory is const, and must match objset_hash ()
+#define js_newstr_prefix(len,intern,hash) \
         (wchar_t)(len << 1), (wchar_t)(len >> 15), \
         (js_str_is_string | js_str_is_static | \
-            ((intern) * js_str_in_objset))
+            ((intern) * js_str_in_objset)), 0, \
+        (wchar_t)(hash), (wchar_t)(hash >> 16)
 
 //
 // object
@@ -230,15 +234,41 @@ js_val js_restarr_iter (js_environ *env, js_val *iterator);
 js_val js_newbig (js_environ *env, int len, uint32_t *ptr);
 
 //
-//  'try' exception handler
+//  'try' exception handler.  the js_try record is allocated
+//  by the caller, typically as a local in the function with
+//  the try block, see also try_statement () in file
+//  statement_writer.js
 //
 
-jmp_buf *js_entertry (js_environ *env);
+#ifdef __GNUC__
+// the gcc builtins only save the few registers that are
+// needed to resume, and skip the unwind logic of setjmp ()
+typedef void *js_jmp_buf[5];
+#define js_setjmp(buf) __builtin_setjmp(buf)
+#define js_longjmp(buf) __builtin_longjmp(buf,1)
+#else
+typedef jmp_buf js_jmp_buf;
+#define js_setjmp(buf) setjmp(buf)
+#define js_longjmp(buf) longjmp(buf,1)
+#endif
+
+typedef struct js_try js_try;
+struct js_try {
+
+    js_try *parent_try;
+    js_link *stack_top;
+    js_val throw_val;
+    js_jmp_buf jmp_buf;
+};
+
+js_jmp_buf *js_entertry (js_environ *env, js_try *try);
 
 js_val js_leavetry (js_environ *env);
 
 #ifdef __GNUC__
-__attribute__((noreturn))
+// noinline because __builtin_longjmp () must not be
+// inlined into the function which called js_setjmp ()
+__attribute__((noreturn,noinline))
 #endif
 js_val js_throw (js_environ *env, js_val throw_val);
 
@@ -277,19 +307,30 @@ void js_growstack (js_environ *env, js_link *stk, int needed);
     (js_stk_top = stk_args)->value = js_undefined;  \
     return js_return_tmp; }
 
-js_val js_arguments (js_environ *env,
-                     js_val func_val, js_link *stk_args);
+js_val js_arguments (js_environ *env, js_val func_val,
+                     js_link *stk_args, js_link *stk_end);
+
+// a reference to the 'arguments' object, which is created
+// on first use, if it was not already created on entry to
+// the function, see variable_declaration_special_node ()
+// in statement_writer.js.  the result is an lvalue.
+#define js_lazyargs(var,callee,stk_end)                     \
+    (*(likely((var).raw != js_deleted.raw) ? &(var)         \
+        : ((var) = js_arguments(env, (callee),              \
+                            stk_args, (stk_end)), &(var))))
 
 void js_arguments2 (js_environ *env, js_val func_val,
                     js_val args_val, js_link *stk_args);
 
-void js_spreadargs (js_environ *env, js_val iterable);
+void js_spreadargs (js_environ *env, js_val iterable, int room);
 
 void js_newiter (js_environ *env, js_val *new_iter,
                  int kind, js_val iterable_expr);
 
 void js_nextiter1 (js_environ *env, js_val *iter);
 
+bool js_arr_iter_unmodified (js_environ *env);
+
 bool js_nextiter2 (js_environ *env, js_val *iter,
                    int cmd, js_val arg);
 
@@ -309,7 +350,7 @@ struct js_func {
     js_c_func c_func;
     int64_t *shape_cache;
     js_val **closure_array;
-    js_val *closure_temps;
+    struct js_closure_rec *closure_temps;
     union {
         js_shape *new_shape;
         js_link *with_scope;
@@ -328,10 +369,10 @@ js_val js_callnew (js_environ *env, js_val func_val,
 
 js_val js_callfunc (js_c_func_args);
 
-js_val *js_newclosure (js_val func_val, js_val *old_val);
+js_val *js_newclosure (js_val func_val, int count,
+                       const js_val *old_values);
 
-js_val *js_closureval (js_environ *env,
-                       js_val func_val, int closure_index);
+js_val *js_closureval (js_environ *env, js_val *val_ptr);
 
 js_val js_newcoroutine (js_environ *env,
                         int kind, js_val func);
@@ -340,6 +381,19 @@ js_val js_yield (js_environ *env, js_val val);
 
 js_val js_yield_star (js_environ *env, js_val iterable_val);
 
+// a generator compiled as a state machine keeps its
+// local variables in this frame while suspended, see
+// generator_scanner.js and js_genenter () in coroutine.c
+typedef struct js_genframe js_genframe;
+struct js_genframe {
+
+    js_val *vars;       // locals saved across a yield
+    js_val value;       // value yielded, or value sent
+    int state;          // resume point, or zero if new
+};
+
+js_genframe *js_genenter (js_environ *env, int num_vars);
+
 //
 // object/array
 //
@@ -466,6 +520,11 @@ struct js_environ {
     // dummy shape cache field, if no shape cache variable
     int64_t dummy_shape_cache;
 
+    // incremented whenever a cached property slot or the
+    // array fast-path may have become invalid, so a loop
+    // can check guards once, see loop_guard_scanner.js
+    uint64_t shape_epoch;
+
     // current value of the new.target meta property
     js_val new_target;
 
@@ -534,3 +593,32 @@ __forceinline double js_sign (double x) {
 #define likely(x) (x)
 #define unlikely(x) (x)
 #endif
+
+//
+// for-of loop step, for statement_writer.js.  an array
+// with the original iterator is stepped in place, and in
+// any other case, including an array-like object, this
+// calls js_nextiter1 () in iter.c
+//
+
+__forceinline void js_nextiter (js_environ *env, js_val *iter) {
+
+    if (js_is_number(iter[0]) && iter[0].num > 0
+                              && js_is_object(iter[1])) {
+
+        const js_arr *arr = (const js_arr *)js_get_pointer(iter[1]);
+        const uint32_t index = (uint32_t)iter[0].num - 1;
+        if (likely(((uintptr_t)arr->super.proto & 7)
+                                        == js_obj_is_array
+                && index < arr->length && index < arr->capacity
+                && arr->length != -1U
+                && arr->values[index].raw != js_deleted.raw)) {
+
+            iter[2] = arr->values[index];
+            iter[0].num += 1;
+            return;
+        }
+    }
+
+    js_nextiter1(env, iter);
+}
@@ -23,14 +23,27 @@ struct js_shape {
     intmap *props;
     int unique_id;
     int num_values;
+    struct js_shape_keys *keys; // see js_shape_get_keys ()
 };
 
+// the string keys of a shape, in order, see js_shape_get_keys ()
+typedef struct js_shape_keys {
+
+    uint32_t count;
+    uint32_t num_indexes; // integer keys first, see there
+    struct js_shape_key {
+        js_val key;     // interned string
+        int index;      // index in js_obj->values
+    } keys[];
+
+} js_shape_keys;
+
 // object is not extensible if
 // bit 31 is set in js_obj->max_values
 #define js_obj_not_extensible 0x80000000U
-// bits 30 and 29 are used for the gc mark
+// bits 30 to 28 are used by the gc
 #define js_obj_flags_mask (js_obj_not_extensible \
-    | js_gc_marked_bit | js_gc_notify_bit)
+    | js_gc_marked_bit | js_gc_notify_bit | js_gc_weak_bit)
 
 // return size of exotic object structure
 #define js_obj_struct_size(exotic_ty) (                 \
@@ -93,10 +106,11 @@ static uint64_t js_shape_key (js_environ *env, js_val prop) {
 
     } while (false);
 
-    // intern the string
+    // intern the string, or the flat copy of a rope, as a
+    // weak string, until it becomes a key in some shape
 
-    objset_id *id = js_get_pointer(prop);
-    js_str_intern(id);
+    objset_id *id = js_get_pointer(js_str_flat(env, prop));
+    js_str_intern_weak(id);
     return (uint64_t)id;
 }
 
@@ -131,12 +145,17 @@ static js_shape *js_shape_new (js_environ *env,
         }
     }
 
+    // a weak string is pinned once it is a key in a shape,
+    // as shapes are never collected, see js_shape_key ()
+    js_str_pin((objset_id *)new_key);
+
     intmap_set(&new_map, new_key, ~old_count);
 
     js_shape *new_shape = js_malloc(sizeof(js_shape));
     new_shape->props = new_map;
     new_shape->unique_id = ++env->next_unique_id;
     new_shape->num_values = old_count + 1;
+    new_shape->keys = NULL;
 
     intmap_set(&old_map, new_key, (int64_t)new_shape);
     old_shape->props = old_map;
@@ -292,6 +311,105 @@ int js_shape_index (js_environ *env, js_shape *shape, js_val prop) {
                     (uint64_t *)(prop_key),     \
                     (uint64_t *)(idx_or_ptr))
 
+// ------------------------------------------------------------
+//
+// js_shape_index_key
+//
+// an integer index, up to 2^32 - 2, is normally kept in the
+// element store, see elem.c, but an index which is larger
+// than js_max_index is kept in the shape as a string key.
+// returns that index plus one, if the key is such a string,
+// or zero otherwise.  see also js_str_is_length_or_number ()
+//
+// ------------------------------------------------------------
+
+static uint32_t js_shape_index_key (const objset_id *id) {
+
+    // an index larger than js_max_index has ten digits
+    if (id->len != 10 * sizeof(wchar_t))
+        return 0;
+
+    uint64_t num = 0;
+    for (int i = 0; i < 10; i++) {
+        const uint32_t digit = id->data[i] - L'0';
+        if (digit > 9)
+            return 0;
+        num = num * 10 + digit;
+    }
+
+    if (num <= js_max_index || num > 0xFFFFFFFEU)
+        return 0;
+    return (uint32_t)(num + 1);
+}
+
+// ------------------------------------------------------------
+//
+// js_shape_get_keys
+//
+// returns the string keys of a shape, in the order in which
+// they were added, with the index of the value of each key.
+// but the integer keys which are kept in the shape, see
+// js_shape_index_key (), come first, in ascending order,
+// and 'num_indexes' counts them.
+// symbol keys, and the hidden key of the element store, see
+// js_elems_init (), are not included.  the list is built on
+// first use, for for-in and Object.keys (), see js_forin_new ()
+// and js_obj_keys (), and is kept in the shape.  the keys of
+// a shape never change, as an object that gets a new property
+// switches to another shape, so the list remains valid.
+// a deleted property is still in the shape, but its value
+// is js_deleted, so the caller must check the values.
+//
+// ------------------------------------------------------------
+
+static const js_shape_keys *js_shape_get_keys (js_shape *shape) {
+
+    js_shape_keys *keys = shape->keys;
+    if (likely(keys != NULL))
+        return keys;
+
+    keys = js_malloc(sizeof(js_shape_keys)
+            + shape->num_values * sizeof(struct js_shape_key));
+    keys->count = 0;
+    keys->num_indexes = 0;
+
+    int64_t prop_key, idx_or_ptr;
+    int index = 0;
+    while (js_shape_get_next(shape, &index,
+                             &prop_key, &idx_or_ptr)) {
+
+        if (idx_or_ptr < 0 && (((const objset_id *)prop_key)
+                                ->flags & js_str_is_string)) {
+
+            // insert an integer key after any smaller integer
+            // key, and shift the keys which follow it
+            const uint32_t prop_idx =
+                    js_shape_index_key((const objset_id *)prop_key);
+            uint32_t i = keys->count++;
+            if (prop_idx) {
+                while (i > keys->num_indexes) {
+                    keys->keys[i] = keys->keys[i - 1];
+                    i--;
+                }
+                while (i > 0 && js_shape_index_key(js_get_pointer(
+                                keys->keys[i - 1].key)) > prop_idx) {
+                    keys->keys[i] = keys->keys[i - 1];
+                    i--;
+                }
+                keys->num_indexes++;
+            }
+
+            struct js_shape_key *key = &keys->keys[i];
+            key->key = js_make_primitive(
+                            prop_key, js_prim_is_string);
+            key->index = ~idx_or_ptr;
+        }
+    }
+
+    shape->keys = keys;
+    return keys;
+}
+
 // ------------------------------------------------------------
 //
 // js_shape_init
@@ -307,5 +425,6 @@ static void js_shape_init (js_environ *env) {
     shape->props = js_check_alloc(intmap_create());
     shape->unique_id = ++env->next_unique_id;
     shape->num_values = 0;
+    shape->keys = NULL;
     env->shape_empty = shape;
 }
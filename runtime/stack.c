@@ -157,20 +157,37 @@ int js_copystack (js_link **p_first, js_link **p_last) {
 //
 // ------------------------------------------------------------
 
-js_val js_arguments (js_environ *env,
-                     js_val func_val, js_link *stk_args) {
+js_val js_arguments (js_environ *env, js_val func_val,
+                     js_link *stk_args, js_link *stk_end) {
 
     js_link *save_stk_top = js_stk_top;
 
     // collect all the parameters passed to the function,
-    // between 'stk_args' and the stack top pointer,
-    // into a temporary array
-    js_val args_obj = js_restarr_stk(env, stk_args->next);
+    // between 'stk_args' and 'stk_end', into a temporary
+    // array.  'stk_end' is the stack top pointer on entry
+    // to the function, which may differ from the current
+    // stack top, if the 'arguments' object is created
+    // lazily, see js_lazyargs () in runtime.h
+    js_val args_obj = js_restarr_range(
+                            env, stk_args->next, stk_end);
 
     // if function is in non-strict mode, then 'func_val'
-    // was passed, and we have to update its properties
-    if (unlikely(!js_is_undefined_or_null(func_val)))
-        js_arguments2(env, func_val, args_obj, stk_args);
+    // was passed, and we point the 'callee' property of
+    // the 'arguments' object to the function just entered
+    if (unlikely(!js_is_undefined_or_null(func_val))) {
+
+        *js_ownprop(env, args_obj,
+                    env->str_callee, true) = func_val;
+        js_gc_notify(env, func_val);
+
+        // if the program may observe the 'arguments' and
+        // 'caller' properties of a function object, then
+        // we also have to update these properties, see
+        // observes_function_arguments () in the compiler
+        const js_func *func = js_get_pointer(func_val);
+        if (func->flags & js_legacy_arguments)
+            js_arguments2(env, func_val, args_obj, stk_args);
+    }
 
     // we continue processing in the function js_arguments
     // in the javascript portion of the runtime, reachable
@@ -243,15 +260,7 @@ void js_arguments2 (js_environ *env, js_val func_val,
         // otherwise we are called from js_arguments ()
         // above, upon entry to a non-strict function.
         //
-        // first, we point the 'callee' property in the
-        // the newly-created 'arguments' object to the
-        // function that was just entered
-        *js_ownprop(env, args_val,
-                    env->str_callee, true) = func_val;
-
-        js_gc_notify(env, func_val);
-
-        // next, we want to set the 'caller' property
+        // we want to set the 'caller' property
         // on the function that was just entered, to the
         // function that called it.  we scan the stack
         // backwards, looking for a flagged pointer
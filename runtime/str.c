@@ -37,8 +37,24 @@ static bool js_str_is_white_space (wchar_t ch) {
 // js_str_is_interned
 // js_str_intern
 //
+// an interned string is normally never collected, but a
+// string which is interned only because it was used to look
+// up a property, see js_shape_key (), is flagged as weak.
+// the gc may collect a weak string that is not referenced
+// by any value, and remove it from env->strings_set, see
+// js_gc_purge_strings ().  a weak string is pinned, i.e.
+// becomes a normal interned string, when it becomes a key
+// in a shape, or is found by some other intern function,
+// as such a string may be kept in the environment.
+//
 // ------------------------------------------------------------
 
+#define js_str_is_weak 64
+
+// a symbol created by Symbol.for (), which can't be the key
+// of a weak collection, see js_sym_util () and map.c
+#define js_sym_is_registered 128
+
 #define js_str_is_interned(id)              \
     ((id)->flags & js_str_in_objset)
 
@@ -46,15 +62,41 @@ static bool js_str_is_white_space (wchar_t ch) {
     js_compare_and_swap_16(&(id)->flags,    \
             (uint16_t)-1, js_str_in_objset)
 
+#define js_str_pin(id)                      \
+    if (unlikely((id)->flags & js_str_is_weak)) \
+        js_compare_and_swap_16(&(id)->flags,    \
+            (uint16_t)~js_str_is_weak, 0)
+
+// a weak string found in env->strings_set is marked, as
+// it may have been found unreferenced by a sweep, which
+// is still in progress, see also js_gc_purge_strings ()
+#define js_str_touch(id)                    \
+    if (((id)->flags & (js_str_is_weak |    \
+            (js_gc_marked_bit >> 16))) == js_str_is_weak) \
+        js_compare_and_swap_16(&(id)->flags,    \
+            (uint16_t)-1, js_gc_marked_bit >> 16)
+
 #define js_str_intern(id) {                 \
     objset_id *id2 = objset_intern(         \
             &env->strings_set, (id), NULL); \
     if (likely(id2 != (id))) {              \
         js_check_alloc(id2);                \
         (id) = id2;                         \
+        js_str_pin(id);                     \
     } else if (!js_str_is_interned(id))     \
         js_str_flag_as_interned(id); }
 
+#define js_str_intern_weak(id) {            \
+    objset_id *id2 = objset_intern(         \
+            &env->strings_set, (id), NULL); \
+    if (likely(id2 != (id))) {              \
+        js_check_alloc(id2);                \
+        (id) = id2;                         \
+        js_str_touch(id);                   \
+    } else                                  \
+        js_compare_and_swap_16(&(id)->flags,    \
+            (uint16_t)-1, js_str_in_objset | js_str_is_weak); }
+
 // ------------------------------------------------------------
 //
 // js_newstr
@@ -105,6 +147,7 @@ static js_val js_str_c2 (js_environ *env,
     objset_id *id = js_malloc(sizeof(objset_id) + wlen);
     id->len = wlen;
     id->flags = js_str_is_string;
+    id->hash = 0;
 
     wchar_t *ptr_wch = id->data;
     while (num_chars-- > 0)
@@ -143,6 +186,7 @@ static js_val js_str_c (js_environ *env,
     } else {
         // we received an id that was already interned
         js_check_alloc(id2);
+        js_str_pin(id2);
         str = js_make_primitive_string(id2);
     }
 
@@ -160,12 +204,15 @@ static js_val js_str_search_or_intern (
 
     objset_id *id = objset_search(
                         env->strings_set, data, wlen);
-    if (id)
+    if (id) {
+        js_str_pin(id);
         return js_make_primitive_string(id);
+    }
 
     id = js_malloc(sizeof(objset_id) + wlen);
     id->len = wlen;
     id->flags = js_str_is_string | js_str_in_objset;
+    id->hash = 0;
     memcpy(id->data, data, wlen);
 
     objset_id *id2 =
@@ -182,12 +229,296 @@ static js_val js_str_search_or_intern (
                 js_make_primitive_string(id));
 }
 
+// ------------------------------------------------------------
+//
+// js_rope
+//
+// a rope is a string which is the concatenation of two
+// other strings, created by js_str_concat () instead of
+// copying both strings.  it has the same 'len' and 'flags'
+// fields as objset_id, but instead of characters, it keeps
+// the two pieces.  the characters are copied into a flat
+// string on first access, see js_str_flatten (), which is
+// then kept in 'left', while 'right' is cleared.
+//
+// a rope is never interned, and is never shorter than
+// js_str_rope_min_len bytes.  'depth' counts the nesting
+// of ropes along the right side of the pieces, and is
+// limited by js_str_rope_max_depth, so that functions
+// which walk a rope only recurse on the right side, and
+// loop on the left side, where 's += x' grows the rope.
+//
+// a slice is a rope with the js_str_is_slice flag, which
+// is created by js_str_sub () for a substring, instead of
+// copying the characters.  'left' is the flat parent, and
+// 'right' is the offset in the parent, as a number.  the
+// characters can be read without flattening the slice,
+// see js_str_data (), and a slice is flattened the same
+// as a rope, only when interned or passed to functions
+// which need an objset_id, see js_str_flat ().  a slice
+// is never shorter than js_str_slice_min_len bytes.
+//
+// ------------------------------------------------------------
+
+typedef struct js_rope {
+
+    uint32_t len;
+    uint16_t flags;
+    uint16_t depth;
+    js_val left;
+    js_val right;
+
+} js_rope;
+
+#define js_str_is_rope          16
+#define js_str_is_slice         32
+#define js_str_rope_min_len     (32 * sizeof(wchar_t))
+#define js_str_rope_max_depth   256
+#define js_str_slice_min_len    (16 * sizeof(wchar_t))
+
+#define js_str_is_flat_rope(rope)                       \
+    ((rope)->right.raw == js_uninitialized.raw)
+
+#define js_str_flat(env,str)                            \
+    (unlikely(((objset_id *)js_get_pointer(str))        \
+                ->flags & js_str_is_rope)               \
+        ? js_str_flatten((env), (str)) : (str))
+
+// ------------------------------------------------------------
+//
+// js_str_flatten
+//
+// returns the flat string for a rope, see also the macro
+// js_str_flat () above, which should be used before any
+// access to the characters of a string which may be a rope
+//
+// ------------------------------------------------------------
+
+#define js_str_slice_data(rope)                         \
+    (((rope)->flags & js_str_is_slice)                  \
+  && !js_str_is_flat_rope(rope)                         \
+        ? ((const objset_id *)js_get_pointer(           \
+                    (rope)->left))->data                \
+                        + (uint32_t)(rope)->right.num   \
+        : NULL)
+
+static char *js_str_rope_copy (char *dst, js_val str) {
+
+    // copy the pieces in reverse order, starting at
+    // the end of the destination.  returns the start
+    for (;;) {
+
+        const js_rope *rope = js_get_pointer(str);
+        if ((rope->flags & js_str_is_rope)
+        &&  !(rope->flags & js_str_is_slice)
+        &&  !js_str_is_flat_rope(rope)) {
+
+            dst = js_str_rope_copy(dst, rope->right);
+            str = rope->left;
+            continue;
+        }
+
+        const wchar_t *data = js_str_slice_data(rope);
+        if (!data) {
+            if (rope->flags & js_str_is_rope)
+                str = rope->left;
+            data = ((const objset_id *)js_get_pointer(str))->data;
+        }
+
+        dst -= rope->len;
+        memcpy(dst, data, rope->len);
+        return dst;
+    }
+}
+
+static js_val js_str_flatten (js_environ *env, js_val str) {
+
+    js_rope *rope = js_get_pointer(str);
+    if (js_str_is_flat_rope(rope))
+        return rope->left;
+
+    objset_id *id = js_malloc(sizeof(objset_id) + rope->len);
+    id->len = rope->len;
+    id->flags = js_str_is_string;
+    id->hash = 0;
+    js_str_rope_copy((char *)id->data + id->len, str);
+
+    // keep the flat string in the rope, and let go of
+    // the pieces.  the gc may be scanning the rope at
+    // the same time, so notify it of the new reference
+    js_val flat = js_gc_manage(env,
+                        js_make_primitive_string(id));
+    rope->left = flat;
+    rope->right = js_uninitialized;
+    js_gc_notify(env, flat);
+
+    return flat;
+}
+
+// ------------------------------------------------------------
+//
+// js_str_rope
+//
+// ------------------------------------------------------------
+
+static int js_str_rope_depth (js_val *str) {
+
+    // returns the depth of a rope, or zero if the string
+    // is flat.  a rope which was already flattened is
+    // replaced by its flat string
+    js_rope *rope = js_get_pointer(*str);
+    if (!(rope->flags & js_str_is_rope))
+        return 0;
+    if (js_str_is_flat_rope(rope)) {
+        *str = rope->left;
+        return 0;
+    }
+    return rope->depth;
+}
+
+static js_val js_str_rope (js_environ *env, js_val left,
+                           js_val right, int len) {
+
+    int depth = js_str_rope_depth(&left);
+    int right_depth = js_str_rope_depth(&right) + 1;
+
+    // a rope which keeps growing on the right side, as
+    // in 's = x + s', is flattened at some depth, see
+    // also js_str_rope_copy () and js_gc_mark_val ()
+    if (right_depth > js_str_rope_max_depth) {
+        right = js_str_flatten(env, right);
+        right_depth = 1;
+    }
+    if (depth < right_depth)
+        depth = right_depth;
+
+    js_rope *rope = js_malloc(sizeof(js_rope));
+    rope->len = len;
+    rope->flags = js_str_is_string | js_str_is_rope;
+    rope->depth = depth;
+    rope->left = left;
+    rope->right = right;
+
+    js_val str = js_gc_manage(env,
+                        js_make_primitive_string(rope));
+
+    // as with the values in a new object, see js_newobj2 ()
+    js_gc_notify(env, left);
+    js_gc_notify(env, right);
+
+    return str;
+}
+
+// ------------------------------------------------------------
+//
+// js_str_data
+//
+// returns a pointer to the characters of a string, which
+// may be a slice, without flattening the slice, and while
+// the string is kept alive.  a rope is flattened.
+//
+// ------------------------------------------------------------
+
+static const wchar_t *js_str_data (js_environ *env, js_val str) {
+
+    const js_rope *rope = js_get_pointer(str);
+    if (likely(!(rope->flags & js_str_is_rope)))
+        return ((const objset_id *)rope)->data;
+
+    const wchar_t *data = js_str_slice_data(rope);
+    if (data)
+        return data;
+
+    return ((const objset_id *)js_get_pointer(
+                    js_str_flatten(env, str)))->data;
+}
+
+// ------------------------------------------------------------
+//
+// js_str_char
+//
+// returns an interned string for a single code unit, from
+// the table of latin-1 characters allocated in js_str_init ()
+//
+// ------------------------------------------------------------
+
+static js_val js_str_char (js_environ *env, wchar_t ch) {
+
+    if (likely(ch < 256))
+        return env->str_chars[ch];
+    return js_str_search_or_intern(env, &ch, sizeof(wchar_t));
+}
+
+// ------------------------------------------------------------
+//
+// js_str_sub
+//
+// returns a substring of 'num_chars' characters, starting
+// at index 'start' in string 'str'.  a long substring is
+// created as a slice, see js_rope above, while a short
+// substring is copied, and a single character is returned
+// from the table of one-char strings, see js_str_char ()
+//
+// ------------------------------------------------------------
+
+static js_val js_str_sub (js_environ *env, js_val str,
+                          uint32_t start, uint32_t num_chars) {
+
+    js_rope *rope = js_get_pointer(str);
+    if (num_chars == rope->len >> 1)
+        return str;
+
+    if (!num_chars)
+        return env->str_empty;
+
+    const wchar_t *data = js_str_data(env, str);
+    if (num_chars == 1)
+        return js_str_char(env, data[start]);
+
+    const uint32_t new_len = num_chars << 1;
+    if (new_len < js_str_slice_min_len) {
+
+        objset_id *id = js_malloc(sizeof(objset_id) + new_len);
+        id->len = new_len;
+        id->flags = js_str_is_string;
+        id->hash = 0;
+        memcpy(id->data, data + start, new_len);
+
+        return js_gc_manage(env,
+                    js_make_primitive_string(id));
+    }
+
+    // the parent of a slice is always a flat string, so
+    // a slice of a slice refers to the same parent.  any
+    // other rope was flattened by js_str_data () above
+    if (rope->flags & js_str_is_rope) {
+        if (js_str_slice_data(rope))
+            start += (uint32_t)rope->right.num;
+        str = rope->left;
+    }
+
+    js_rope *slice = js_malloc(sizeof(js_rope));
+    slice->len = new_len;
+    slice->flags = js_str_is_string | js_str_is_rope
+                                    | js_str_is_slice;
+    slice->depth = 0;
+    slice->left = str;
+    slice->right = js_make_number(start);
+
+    js_val result = js_gc_manage(env,
+                        js_make_primitive_string(slice));
+    js_gc_notify(env, str);
+
+    return result;
+}
+
 // ------------------------------------------------------------
 //
 // js_str_concat
 //
 // concatenates two input strings into a new string.
-// the new string is not interned.
+// the new string is not interned.  if the result is
+// long enough, creates a rope, see js_rope above.
 //
 // ------------------------------------------------------------
 
@@ -206,19 +537,147 @@ static js_val js_str_concat (js_environ *env,
         return left;
 
     int len = left_id->len + right_id->len;
+    if (len >= js_str_rope_min_len)
+        return js_str_rope(env, left, right, len);
+
+    // if the result is shorter than a rope, then neither
+    // of the inputs is a rope, but either may be a slice
     objset_id *new_id = js_malloc(
                             sizeof(objset_id) + len);
     new_id->len = len;
     new_id->flags = js_str_is_string;
+    new_id->hash = 0;
 
-    memcpy(new_id->data, left_id->data, left_id->len);
+    memcpy(new_id->data, js_str_data(env, left), left_id->len);
     memcpy((char *)new_id->data + left_id->len,
-           right_id->data, right_id->len);
+           js_str_data(env, right), right_id->len);
 
     return js_gc_manage(env,
                 js_make_primitive_string(new_id));
 }
 
+// ------------------------------------------------------------
+//
+// js_str_mismatch
+//
+// returns the index of the first code unit which differs
+// between the two arrays, or 'len' if all are the same.
+// compares eight code units at a time, if SSE2 is available
+//
+// ------------------------------------------------------------
+
+static uint32_t js_str_mismatch (const wchar_t *left,
+                                 const wchar_t *right,
+                                 uint32_t len) {
+
+    uint32_t index = 0;
+
+#ifdef __SSE2__
+    for (; index + 8 <= len; index += 8) {
+        const __m128i cmp = _mm_cmpeq_epi16(
+            _mm_loadu_si128((const __m128i *)(left + index)),
+            _mm_loadu_si128((const __m128i *)(right + index)));
+        const uint32_t mask = _mm_movemask_epi8(cmp) ^ 0xFFFF;
+        if (mask)
+            return index + (__builtin_ctz(mask) >> 1);
+    }
+#endif
+
+    for (; index < len; index++) {
+        if (left[index] != right[index])
+            break;
+    }
+    return index;
+}
+
+// ------------------------------------------------------------
+//
+// js_str_index_of
+//
+// returns the index of the first occurrence of 'pat' in
+// 'str', starting at index 'from', or -1 if not found.
+// with SSE2, we compare the first and last code units of
+// the pattern against eight positions at a time, and only
+// verify the middle part of the pattern on a match, see
+// http://0x80.pl/articles/simd-strfind.html
+//
+// ------------------------------------------------------------
+
+static int32_t js_str_index_of (
+                    const wchar_t *str, uint32_t str_len,
+                    const wchar_t *pat, uint32_t pat_len,
+                    uint32_t from) {
+
+    if (pat_len > str_len)
+        return -1;
+    if (!pat_len)
+        return from <= str_len ? from : -1;
+
+    const uint32_t last = pat_len - 1;
+    const uint32_t end = str_len - last;
+    uint32_t index = from;
+
+#ifdef __SSE2__
+    const __m128i first_ch = _mm_set1_epi16(pat[0]);
+    const __m128i last_ch = _mm_set1_epi16(pat[last]);
+
+    for (; index + 8 <= end; index += 8) {
+
+        const __m128i cmp = _mm_and_si128(
+            _mm_cmpeq_epi16(first_ch, _mm_loadu_si128(
+                        (const __m128i *)(str + index))),
+            _mm_cmpeq_epi16(last_ch, _mm_loadu_si128(
+                        (const __m128i *)(str + index + last))));
+
+        uint32_t mask = _mm_movemask_epi8(cmp);
+        while (mask) {
+            const uint32_t bit = __builtin_ctz(mask);
+            const uint32_t found = index + (bit >> 1);
+            if (last < 2 || memcmp(str + found + 1, pat + 1,
+                                   (last - 1) * sizeof(wchar_t)) == 0)
+                return found;
+            mask &= ~(3U << bit);
+        }
+    }
+#endif
+
+    for (; index < end; index++) {
+        if (str[index] == pat[0] && str[index + last] == pat[last]
+        &&  memcmp(str + index, pat, pat_len * sizeof(wchar_t)) == 0)
+            return index;
+    }
+    return -1;
+}
+
+// ------------------------------------------------------------
+//
+// js_str_last_index_of
+//
+// returns the index of the last occurrence of 'pat' in
+// 'str', starting at or before index 'from', or -1
+//
+// ------------------------------------------------------------
+
+static int32_t js_str_last_index_of (
+                    const wchar_t *str, uint32_t str_len,
+                    const wchar_t *pat, uint32_t pat_len,
+                    uint32_t from) {
+
+    if (pat_len > str_len)
+        return -1;
+    if (from > str_len - pat_len)
+        from = str_len - pat_len;
+    if (!pat_len)
+        return from;
+
+    for (int32_t index = from; index >= 0; index--) {
+        if (str[index] == pat[0]
+        &&  memcmp(str + index, pat, pat_len * sizeof(wchar_t)) == 0)
+            return index;
+    }
+    return -1;
+}
+
 // ------------------------------------------------------------
 //
 // js_str_equals
@@ -247,15 +706,9 @@ static bool js_str_equals (js_environ *env,
         return false;
 
     // check if any character is different
-    const wchar_t *left_ch = left_id->data;
-    const wchar_t *right_ch = right_id->data;
-    while (len) {
-        if (*left_ch++ != *right_ch++)
-            return false;
-        len -= 2;
-    }
-
-    return true; // strings equal by value
+    return (js_str_mismatch(js_str_data(env, left),
+                            js_str_data(env, right),
+                            len >> 1) == (len >> 1));
 }
 
 // ------------------------------------------------------------
@@ -264,13 +717,16 @@ static bool js_str_equals (js_environ *env,
 //
 // ------------------------------------------------------------
 
-static int js_str_compare (js_val left, js_val right) {
+static int js_str_compare (js_environ *env,
+                           js_val left, js_val right) {
+
+    if (left.raw == right.raw)
+        return 0;
 
     const objset_id *left_id = js_get_pointer(left);
     const objset_id *right_id = js_get_pointer(right);
-
-    if (left_id == right_id)
-        return 0;
+    const wchar_t *left_ch = js_str_data(env, left);
+    const wchar_t *right_ch = js_str_data(env, right);
 
     // check if string lengths are different
     int len = left_id->len;
@@ -278,14 +734,10 @@ static int js_str_compare (js_val left, js_val right) {
         len = right_id->len;
 
     // check if any character is different
-    const wchar_t *left_ch = left_id->data;
-    const wchar_t *right_ch = right_id->data;
-    while (len) {
-        int cmp = *left_ch++ - *right_ch++;
-        if (cmp != 0)
-            return cmp;
-        len -= 2;
-    }
+    const uint32_t index = js_str_mismatch(
+                            left_ch, right_ch, len >> 1);
+    if (index != (len >> 1))
+        return left_ch[index] - right_ch[index];
 
     return (left_id->len - right_id->len);
 }
@@ -326,8 +778,9 @@ static uint32_t js_str_is_length_or_number (
 
     if (js_is_number(prop)) {
 
+        // compare as doubles, so -0 is also index '0'
         const uint32_t num = js_get_number(prop);
-        if (js_make_number(num).raw == prop.raw
+        if ((double)num == js_get_number(prop)
                              && num <= js_max_index)
             return (num + 1);
 
@@ -354,6 +807,10 @@ static uint32_t js_str_is_length_or_number (
 
         id = js_get_pointer(prop);
 
+        // a rope is longer than 'length' or any index
+        if (id->flags & js_str_is_rope)
+            return js_not_index;
+
     } else
         return js_not_index;
 
@@ -526,12 +983,8 @@ static js_val js_str_getprop (js_environ *env,
     if (prop_idx == js_len_index)
         return js_make_number(str_len);
 
-    if (prop_idx <= str_len) {
-
-        const wchar_t *the_char = &str_ptr->data[prop_idx - 1];
-        return js_str_search_or_intern(
-                            env, the_char, sizeof(wchar_t));
-    }
+    if (prop_idx <= str_len)
+        return js_str_char(env, js_str_data(env, obj)[prop_idx - 1]);
 
     // property index is not 'length', and is not an integer
     // index between 0 and the actual length of the string,
@@ -603,6 +1056,7 @@ static void js_str_init (js_environ *env) {
 
     objset_id *empty = js_malloc(sizeof(objset_id));
     empty->len = 0;
+    empty->hash = 0;
     empty->flags = js_str_is_string
                  | js_str_in_objset
                  | js_str_is_static;
@@ -611,6 +1065,16 @@ static void js_str_init (js_environ *env) {
 
     env->str_empty = js_make_primitive_string(empty);
 
+    //
+    // define the one-char strings, see js_str_char ()
+    //
+
+    for (int i = 0; i < 256; i++) {
+        wchar_t ch = i;
+        env->str_chars[i] = js_str_search_or_intern(
+                                env, &ch, sizeof(wchar_t));
+    }
+
     //
     // define rest of the well-known strings
     //
@@ -1,4 +1,83 @@
 
+// ------------------------------------------------------------
+//
+// js_str_output
+//
+// console output is encoded as utf-8 into a buffer in the
+// env, which is written to stdout when it fills up, or at
+// the end of a line, if the buffer is past a threshold, or
+// if stdout is interactive.  see also js_str_output_flush ()
+//
+// ------------------------------------------------------------
+
+#define js_str_out_buffer_size      16384
+#define js_str_out_flush_threshold  (js_str_out_buffer_size / 2)
+
+static void js_str_output_flush (js_environ *env) {
+
+    if (env->out_length) {
+        fwrite(env->out_buffer, 1, env->out_length, stdout);
+        fflush(stdout);
+        env->out_length = 0;
+    }
+}
+
+static void js_str_output (js_environ *env,
+                           const wchar_t *ptr, int len) {
+
+    const wchar_t *end = ptr + len;
+    bool newline = false;
+
+    while (ptr < end) {
+
+        // a code unit takes at most three bytes, and a
+        // surrogate pair takes four, so stop short of the
+        // end of the buffer
+        unsigned char *out = (unsigned char *)
+                            env->out_buffer + env->out_length;
+        unsigned char *out_end = (unsigned char *)
+                env->out_buffer + js_str_out_buffer_size - 4;
+
+        while (ptr < end && out < out_end) {
+
+            uint32_t ch = *ptr++;
+            if (ch < 0x80) {
+                newline |= (ch == L'\n');
+                *out++ = ch;
+
+            } else if (ch < 0x800) {
+                *out++ = 0xC0 | (ch >> 6);
+                *out++ = 0x80 | (ch & 0x3F);
+
+            } else if (ch >= 0xD800 && ch <= 0xDBFF && ptr < end
+                   &&  *ptr >= 0xDC00 && *ptr <= 0xDFFF) {
+                ch = 0x10000 + ((ch - 0xD800) << 10)
+                             + (*ptr++ - 0xDC00);
+                *out++ = 0xF0 | (ch >> 18);
+                *out++ = 0x80 | ((ch >> 12) & 0x3F);
+                *out++ = 0x80 | ((ch >> 6) & 0x3F);
+                *out++ = 0x80 | (ch & 0x3F);
+
+            } else {
+                // an unpaired surrogate can't be encoded
+                if (ch >= 0xD800 && ch <= 0xDFFF)
+                    ch = 0xFFFD;
+                *out++ = 0xE0 | (ch >> 12);
+                *out++ = 0x80 | ((ch >> 6) & 0x3F);
+                *out++ = 0x80 | (ch & 0x3F);
+            }
+        }
+
+        env->out_length = (char *)out - env->out_buffer;
+        if (ptr < end)
+            js_str_output_flush(env);
+    }
+
+    if (newline && (env->out_interactive
+                ||  env->out_length >= js_str_out_flush_threshold))
+        js_str_output_flush(env);
+}
+
 // ------------------------------------------------------------
 //
 // js_str_print
@@ -16,20 +95,21 @@ static js_val js_str_print (js_c_func_args) {
         js_val arg_val = arg_ptr->value;
         if (js_is_primitive_string(arg_val)) {
 
-            const objset_id *id = js_get_pointer(arg_val);
-            txt_ptr = id->data;
-            txt_len = id->len >> 1;
+            txt_ptr = js_str_data(env, arg_val);
+            txt_len = ((objset_id *)
+                        js_get_pointer(arg_val))->len >> 1;
 
         // while the primary purpose is to print strings,
         // it also serves as a general debug-print utility
         } else {
+            js_str_output_flush(env);
             printf("<dbg>");
             js_print(env, arg_val);
             js_return(js_undefined);
         }
     }
 
-    printf("%*.*ls", txt_len, txt_len, txt_ptr);
+    js_str_output(env, txt_ptr, txt_len);
     js_return(js_undefined);
 }
 
@@ -37,8 +117,9 @@ static js_val js_str_print (js_c_func_args) {
 //
 // js_sym_util - utility function for managing Symbols.
 // if first argument is a string, creates a new symbol value
-// with that string description.  if the first argument is
-// a symbol, returns the description string for the symbol.
+// with that string description, which is flagged as from
+// Symbol.for () if the second argument is true.  if the first
+// argument is a symbol, returns its description string.
 //
 // ------------------------------------------------------------
 
@@ -62,17 +143,23 @@ static js_val js_sym_util (js_c_func_args) {
         &&  prim_type != js_prim_is_symbol)
             break;
 
+        if (prim_type == js_prim_is_string)
+            arg_val = js_str_flat(env, arg_val);
         objset_id *id = js_get_pointer(arg_val);
 
         objset_id *id2 = js_malloc(
                             sizeof(objset_id) + id->len);
         memcpy(id2->data, id->data,
                             (id2->len = id->len));
+        id2->hash = id->hash;
 
         // return a symbol for a descr string,
         // return a descr string for a symbol
         if (prim_type == js_prim_is_string) {
             id2->flags = js_str_is_symbol;
+            if ((arg_ptr = arg_ptr->next) != js_stk_top
+            &&  arg_ptr->value.raw == js_true.raw)
+                id2->flags |= js_sym_is_registered;
             ret_val = js_make_primitive_symbol(id2);
         } else {
             id2->flags = js_str_is_string;
@@ -104,7 +191,7 @@ static js_val js_str_utf16 (js_c_func_args) {
 
     if (js_is_primitive_string(arg_val)) {
 
-        objset_id *id = js_get_pointer(arg_val);
+        objset_id *id = js_get_pointer(js_str_flat(env, arg_val));
         if (id->len >= sizeof(wchar_t))
             ret_val.num = (uint16_t)id->data[0];
         else
@@ -134,6 +221,7 @@ static js_val js_str_utf16 (js_c_func_args) {
         }
 
         id->flags = js_str_is_string;
+        id->hash = 0;
         ret_val = js_gc_manage(env,
                     js_make_primitive_string(id));
 
@@ -148,6 +236,7 @@ static js_val js_str_utf16 (js_c_func_args) {
                                   + len * sizeof(wchar_t));
                 id->len = len * sizeof(wchar_t);
                 id->flags = js_str_is_string;
+                id->hash = 0;
 
                 uint16_t *data = id->data;
                 js_val *val = arr->values;
@@ -196,14 +285,14 @@ static js_val js_str_trim (js_c_func_args) {
         if (!js_is_number(cmd_val))
             break;
 
-        objset_id *id = js_get_pointer(str_val);
-        wchar_t *txt_ptr = id->data;
+        const objset_id *id = js_get_pointer(str_val);
+        const wchar_t *data = js_str_data(env, str_val);
+        const wchar_t *txt_ptr = data;
         int txt_len = id->len >> 1;
-        int txt_len_0 = txt_len;
 
         if (cmd_val.num <= 0) {
             while (txt_len) {
-                const char ch = *txt_ptr;
+                const wchar_t ch = *txt_ptr;
                 if (!js_str_is_white_space(ch))
                     break;
                 ++txt_ptr;
@@ -212,32 +301,18 @@ static js_val js_str_trim (js_c_func_args) {
         }
 
         if (cmd_val.num >= 0) {
-            wchar_t *end_ptr = txt_ptr + txt_len;
+            const wchar_t *end_ptr = txt_ptr + txt_len;
             while (txt_len) {
-                const char ch = *(--end_ptr);
+                const wchar_t ch = *(--end_ptr);
                 if (!js_str_is_white_space(ch))
                     break;
                 --txt_len;
             }
         }
 
-        if (txt_len == txt_len_0)
-            ret_val = str_val; // same as input
-
-        else if (!txt_len)
-            ret_val = env->str_empty;
-
-        else {
-            // create a new sub-string
-            id = js_malloc(sizeof(objset_id)
-                            + (txt_len <<= 1));
-            id->len = txt_len;
-            id->flags = js_str_is_string;
-            memcpy(id->data, txt_ptr, txt_len);
-
-            ret_val = js_gc_manage(env,
-                js_make_primitive_string(id));
-        }
+        // returns the input string if nothing was trimmed
+        ret_val = js_str_sub(env, str_val,
+                             txt_ptr - data, txt_len);
 
     } while (0);
     js_return(ret_val);
@@ -260,7 +335,7 @@ static js_val js_str_sub_helper (
         str_val = js_tostring(env, str_val);
     }
 
-    objset_id *id = js_get_pointer(str_val);
+    const objset_id *id = js_get_pointer(str_val);
     int32_t str_len = id->len >> 1;
 
     // use doubles in comparison (see below) to
@@ -363,16 +438,8 @@ static js_val js_str_sub_helper (
     // create and return a new substring
     //
 
-    const wchar_t *str_txt = id->data + index[0];
-    uint32_t new_len = (index[1] - index[0]) << 1;
-
-    id = js_malloc(sizeof(objset_id) + new_len);
-    id->len = new_len;
-    id->flags = js_str_is_string;
-    memcpy(id->data, str_txt, new_len);
-
-    return js_gc_manage(env,
-                js_make_primitive_string(id));
+    return js_str_sub(env, str_val, index[0],
+                      index[1] - index[0]);
 }
 
 // ------------------------------------------------------------
@@ -454,6 +521,7 @@ static js_val js_str_concat_v (js_c_func_args) {
         js_throw_if_nullobj(env, this_val);
         this_val = js_tostring(env, this_val);
     }
+    this_val = js_str_flat(env, this_val);
     // add its length to the combined count
     objset_id *src_id = js_get_pointer(this_val);
     uint32_t dst_len = src_id->len;
@@ -466,10 +534,9 @@ static js_val js_str_concat_v (js_c_func_args) {
         if (arg_ptr == js_stk_top)
             break;
         js_val arg_val = arg_ptr->value;
-        if (!js_is_primitive_string(arg_val)) {
+        if (!js_is_primitive_string(arg_val))
             arg_val = js_tostring(env, arg_val);
-            arg_ptr->value = arg_val;
-        }
+        arg_ptr->value = arg_val = js_str_flat(env, arg_val);
         // add its length to the combined count
         src_id = js_get_pointer(arg_val);
         dst_len += src_id->len;
@@ -486,6 +553,7 @@ static js_val js_str_concat_v (js_c_func_args) {
         js_malloc(sizeof(objset_id) + dst_len);
     dst_id->len = dst_len;
     dst_id->flags = js_str_is_string;
+    dst_id->hash = 0;
     char *dst_ptr = (char *)dst_id->data;
 
     // append the (possibly stringified) 'this',
@@ -504,6 +572,688 @@ static js_val js_str_concat_v (js_c_func_args) {
                 js_make_primitive_string(dst_id)));
 }
 
+// ------------------------------------------------------------
+//
+// js_strbuf
+//
+// a growable buffer of utf-16 code units, for building a
+// string from many pieces, without allocating a string for
+// each intermediate result.  the buffer is kept with a
+// string header, so the final string is the buffer itself,
+// trimmed to size, see js_strbuf_finish ().
+//
+// a buffer used by javascript code is kept in a private
+// object, so it is freed by the gc even if an exception
+// is thrown while building, see js_str_builder ()
+//
+// ------------------------------------------------------------
+
+// limit on string length in bytes, as in v8, about 2^29
+// code units
+#define js_str_max_bytes (((1U << 29) - 24) * sizeof(wchar_t))
+
+typedef struct js_strbuf {
+
+    objset_id *id;      // 'len' is the number of bytes used
+    uint32_t capacity;  // number of bytes allocated
+
+} js_strbuf;
+
+static void js_strbuf_reserve (js_environ *env,
+                               js_strbuf *buf, uint64_t more) {
+
+    const uint32_t used = buf->id ? buf->id->len : 0;
+    const uint64_t need = used + more;
+    if (need <= buf->capacity)
+        return;
+    if (need > js_str_max_bytes)
+        js_callthrow("RangeError_string_length");
+
+    uint64_t capacity = (uint64_t)buf->capacity * 2;
+    if (capacity < need)
+        capacity = need;
+    if (capacity < 64)
+        capacity = 64;
+    if (capacity > js_str_max_bytes)
+        capacity = js_str_max_bytes;
+
+    buf->id = js_check_alloc(realloc(
+                    buf->id, sizeof(objset_id) + capacity));
+    buf->id->len = used;
+    buf->capacity = capacity;
+}
+
+static void js_strbuf_append (js_environ *env,
+                              js_strbuf *buf, js_val str) {
+
+    // 'str' must be a primitive string
+    const uint32_t len = ((objset_id *)js_get_pointer(str))->len;
+    if (len) {
+        js_strbuf_reserve(env, buf, len);
+        memcpy((char *)buf->id->data + buf->id->len,
+               js_str_data(env, str), len);
+        buf->id->len += len;
+    }
+}
+
+static js_val js_strbuf_finish (js_environ *env, js_strbuf *buf) {
+
+    // returns the contents of the buffer as a string,
+    // and resets the buffer to empty
+    objset_id *id = buf->id;
+    if (!id || !id->len)
+        return env->str_empty;
+
+    if (buf->capacity != id->len) {
+        id = js_check_alloc(realloc(
+                    id, sizeof(objset_id) + id->len));
+    }
+    id->flags = js_str_is_string;
+    id->hash = 0;
+
+    buf->id = NULL;
+    buf->capacity = 0;
+    return js_gc_manage(env, js_make_primitive_string(id));
+}
+
+// ------------------------------------------------------------
+//
+// js_str_builder
+// js_str_builder_append
+// js_str_builder_finish
+//
+// a string builder for javascript code:
+//
+//      const sb = str_sup.builder();
+//      str_sup.append(sb, 'a', 1, 'b');
+//      str_sup.finish(sb)              // 'a1b'
+//
+// ------------------------------------------------------------
+
+#define js_str_builder_kind \
+            ((js_val){ .raw = 0x53744200 /* StB0 */ })
+
+static void js_str_builder_gc_callback (
+                js_gc_env *gc, js_priv *priv, int why) {
+
+    // the buffer holds characters, not values, so there
+    // is nothing to mark, but it is freed on collection
+    if (why == 0) {
+        js_strbuf *buf = priv->val_or_ptr.ptr;
+        js_free(buf->id);
+        js_free(buf);
+    }
+}
+
+static js_val js_str_builder_new (js_environ *env) {
+
+    js_strbuf *buf = js_malloc(sizeof(js_strbuf));
+    buf->id = NULL;
+    buf->capacity = 0;
+
+    js_priv *priv = js_newprivobj(env, js_str_builder_kind);
+    priv->val_or_ptr.ptr = buf;
+    priv->gc_callback = js_str_builder_gc_callback;
+    return js_gc_manage(env, js_make_object(priv));
+}
+
+static js_strbuf *js_str_builder_check (
+                    js_environ *env, js_link *arg_ptr) {
+
+    js_priv *priv = NULL;
+    if (arg_ptr != js_stk_top)
+        priv = js_isprivobj(arg_ptr->value, js_str_builder_kind);
+    if (!priv)
+        js_callthrow("TypeError_incompatible_object");
+    return priv->val_or_ptr.ptr;
+}
+
+static js_val js_str_builder (js_c_func_args) {
+    js_prolog_stack_frame();
+    js_return(js_str_builder_new(env));
+}
+
+static js_val js_str_builder_append (js_c_func_args) {
+    js_prolog_stack_frame();
+
+    // appends ToString () of each argument after the first
+    js_link *arg_ptr = stk_args->next;
+    js_strbuf *buf = js_str_builder_check(env, arg_ptr);
+    for (;;) {
+        arg_ptr = arg_ptr->next;
+        if (arg_ptr == js_stk_top)
+            break;
+        js_val arg_val = arg_ptr->value;
+        if (!js_is_primitive_string(arg_val))
+            arg_val = js_tostring(env, arg_val);
+        js_strbuf_append(env, buf, arg_val);
+    }
+    js_return(js_undefined);
+}
+
+static js_val js_str_builder_finish (js_c_func_args) {
+    js_prolog_stack_frame();
+    js_strbuf *buf = js_str_builder_check(env, stk_args->next);
+    js_return(js_strbuf_finish(env, buf));
+}
+
+// ------------------------------------------------------------
+//
+// js_str_search_helper
+//
+// implements indexOf, lastIndexOf, includes, startsWith and
+// endsWith, which take a search string and an optional
+// position, using the kernels js_str_index_of () and
+// js_str_last_index_of () in str.c
+//
+// ------------------------------------------------------------
+
+static js_val js_str_search_helper (
+                        js_environ *env, js_val str_val,
+                        js_link *arg_ptr, int which) {
+
+    // convert input 'this' value to string
+    if (!js_is_primitive_string(str_val)) {
+        js_throw_if_nullobj(env, str_val);
+        str_val = js_tostring(env, str_val);
+    }
+
+    // convert the search argument to string
+    js_val pat_val = js_undefined;
+    arg_ptr = arg_ptr->next;
+    if (arg_ptr != js_stk_top)
+        pat_val = arg_ptr->value;
+
+    // includes, startsWith and endsWith do not accept
+    // a regexp, i.e. an object with a truthy Symbol.match
+    // property, see IsRegExp in the spec
+    if (which != 'i' && which != 'l' && js_is_object(pat_val)) {
+        int64_t dummy_shape_cache;
+        if (js_is_truthy(js_getprop(env, pat_val, env->sym_match,
+                                    &dummy_shape_cache))) {
+            js_callshadow(env, "TypeError_regexp_argument",
+                          js_str_c(env, which == 'c' ? "includes"
+                                      : which == 's' ? "startsWith"
+                                                     : "endsWith"));
+        }
+    }
+
+    if (!js_is_primitive_string(pat_val))
+        pat_val = js_tostring(env, pat_val);
+
+    const uint32_t str_len =
+                ((objset_id *)js_get_pointer(str_val))->len >> 1;
+    const uint32_t pat_len =
+                ((objset_id *)js_get_pointer(pat_val))->len >> 1;
+
+    // get the optional position parameter, clamped between
+    // zero and length.  the default is zero, except for
+    // lastIndexOf and endsWith, where it is the length
+    uint32_t pos = (which == 'l' || which == 'e') ? str_len : 0;
+    if (arg_ptr != js_stk_top
+    &&  (arg_ptr = arg_ptr->next) != js_stk_top) {
+        js_val arg_val = arg_ptr->value;
+        if (which != 'e' || !js_is_undefined(arg_val)) {
+            if (!js_is_number(arg_val))
+                arg_val = js_tonumber(env, arg_val);
+            if (arg_val.num >= (double)str_len)
+                pos = str_len;
+            else if (arg_val.num >= 1)
+                pos = arg_val.num;
+            else if (which != 'l' || !isnan(arg_val.num))
+                pos = 0;
+            // for lastIndexOf, NaN means the length
+        }
+    }
+
+    const wchar_t *str = js_str_data(env, str_val);
+    const wchar_t *pat = js_str_data(env, pat_val);
+
+    switch (which) {
+
+        // indexOf
+        case 'i':
+            return js_make_number(js_str_index_of(
+                    str, str_len, pat, pat_len, pos));
+
+        // lastIndexOf
+        case 'l':
+            return js_make_number(js_str_last_index_of(
+                    str, str_len, pat, pat_len, pos));
+
+        // includes
+        case 'c':
+            return js_str_index_of(str, str_len,
+                                   pat, pat_len, pos) >= 0
+                 ? js_true : js_false;
+
+        // startsWith
+        case 's':
+            return (pat_len <= str_len - pos
+                &&  js_str_mismatch(str + pos, pat,
+                                    pat_len) == pat_len)
+                 ? js_true : js_false;
+
+        // endsWith, pos is the end position
+        case 'e':
+            return (pat_len <= pos
+                &&  js_str_mismatch(str + pos - pat_len,
+                                    pat, pat_len) == pat_len)
+                 ? js_true : js_false;
+
+        default:
+            fprintf(stderr, "Search!\n");
+            exit(1);
+    }
+}
+
+// ------------------------------------------------------------
+//
+// js_str_indexOf
+// js_str_lastIndexOf
+// js_str_includes
+// js_str_startsWith
+// js_str_endsWith
+//
+// ------------------------------------------------------------
+
+#define js_str_search_func(func_name,which)                 \
+    static js_val func_name (js_c_func_args) {              \
+        js_prolog_stack_frame();                            \
+        const js_val ret_val = js_str_search_helper(        \
+                        env, this_val, stk_args, (which));  \
+        js_return(ret_val);                                 \
+    }
+
+js_str_search_func(js_str_indexOf,     'i')
+js_str_search_func(js_str_lastIndexOf, 'l')
+js_str_search_func(js_str_includes,    'c')
+js_str_search_func(js_str_startsWith,  's')
+js_str_search_func(js_str_endsWith,    'e')
+
+#undef js_str_search_func
+
+// ------------------------------------------------------------
+//
+// js_str_split
+//
+// split with a string separator.  a separator object with
+// a Symbol.split method is handled in split () in string.js
+//
+// ------------------------------------------------------------
+
+static js_val js_str_split (js_c_func_args) {
+    js_prolog_stack_frame();
+
+    // convert input 'this' value to string
+    if (!js_is_primitive_string(this_val)) {
+        js_throw_if_nullobj(env, this_val);
+        this_val = js_tostring(env, this_val);
+    }
+
+    js_val sep_val = js_undefined;
+    js_val lim_val = js_undefined;
+    js_link *arg_ptr = stk_args->next;
+    if (arg_ptr != js_stk_top) {
+        sep_val = arg_ptr->value;
+        arg_ptr = arg_ptr->next;
+        if (arg_ptr != js_stk_top)
+            lim_val = arg_ptr->value;
+    }
+
+    // the limit is converted as uint32, default is 2^32-1
+    uint32_t limit = -1U;
+    if (!js_is_undefined(lim_val)) {
+        if (!js_is_number(lim_val))
+            lim_val = js_tonumber(env, lim_val);
+        limit = (isfinite(lim_val.num)
+              ?  (uint32_t)(int64_t)fmod(trunc(lim_val.num),
+                                         4294967296.0) : 0);
+    }
+
+    const bool no_sep = js_is_undefined(sep_val);
+    if (!no_sep && !js_is_primitive_string(sep_val))
+        sep_val = js_tostring(env, sep_val);
+
+    js_val arr_val = js_newarr(env, 0);
+    if (!limit)
+        js_return(arr_val);
+
+    uint32_t arr_idx = 0;
+    if (no_sep) {
+        js_arr_set(env, arr_val, ++arr_idx, this_val);
+        js_return(arr_val);
+    }
+
+    const uint32_t str_len =
+                ((objset_id *)js_get_pointer(this_val))->len >> 1;
+    const uint32_t sep_len =
+                ((objset_id *)js_get_pointer(sep_val))->len >> 1;
+    const wchar_t *str = js_str_data(env, this_val);
+    const wchar_t *sep = js_str_data(env, sep_val);
+
+    if (!sep_len) {
+        // split into single code units
+        for (uint32_t i = 0; i < str_len && arr_idx < limit; i++) {
+            js_arr_set(env, arr_val, ++arr_idx,
+                       js_str_char(env, str[i]));
+        }
+        js_return(arr_val);
+    }
+
+    uint32_t start = 0;
+    for (;;) {
+        int32_t found = js_str_index_of(
+                str, str_len, sep, sep_len, start);
+        if (found < 0)
+            break;
+        js_arr_set(env, arr_val, ++arr_idx,
+                   js_str_sub(env, this_val, start, found - start));
+        if (arr_idx == limit)
+            js_return(arr_val);
+        start = found + sep_len;
+    }
+
+    js_arr_set(env, arr_val, ++arr_idx,
+               js_str_sub(env, this_val, start, str_len - start));
+    js_return(arr_val);
+}
+
+// ------------------------------------------------------------
+//
+// js_str_join
+//
+// implements Array.prototype.join, called with an object
+// as 'this', see join () in array.js.  if the object is a
+// fast-path array which holds only strings and empty
+// values, the length of the result is computed first, and
+// the result is allocated once.  otherwise, the elements
+// are converted one at a time into a string builder.
+//
+// ------------------------------------------------------------
+
+static js_val js_str_join (js_c_func_args) {
+    js_prolog_stack_frame();
+
+    js_val arr_val = this_val;
+    js_val sep_val = js_undefined;
+    js_link *arg_ptr = stk_args->next;
+    if (arg_ptr != js_stk_top)
+        sep_val = arg_ptr->value;
+
+    int64_t dummy_shape_cache;
+    js_val len_val = js_getprop(env, arr_val, env->str_length,
+                               &dummy_shape_cache);
+    if (!js_is_number(len_val))
+        len_val = js_tonumber(env, len_val);
+    uint32_t len = 0;
+    if (len_val.num >= 1)
+        len = (len_val.num < 4294967295.0)
+            ? (uint32_t)len_val.num : 4294967295U;
+
+    if (js_is_undefined(sep_val))
+        sep_val = js_str_char(env, L',');
+    else if (!js_is_primitive_string(sep_val))
+        sep_val = js_tostring(env, sep_val);
+    const uint32_t sep_len =
+                ((objset_id *)js_get_pointer(sep_val))->len;
+
+    if (!len)
+        js_return(env->str_empty);
+
+    js_arr *arr = js_get_pointer(arr_val);
+    #define is_fast_array()                                 \
+        (arr->super.proto == env->fast_arr_proto            \
+            && arr->length != -1U)
+    #define get_fast_element(idx)                           \
+        (((idx) < arr->length && (idx) < arr->capacity)     \
+            ? arr->values[(idx)] : js_deleted)
+    #define is_empty_element(val)                           \
+        (js_is_undefined(val) || (val).raw == js_null.raw   \
+                              || (val).raw == js_deleted.raw)
+
+    if (is_fast_array()) {
+
+        uint64_t total = (uint64_t)sep_len * (len - 1);
+        uint32_t idx;
+        for (idx = 0; idx < len; idx++) {
+            const js_val val = get_fast_element(idx);
+            if (js_is_primitive_string(val))
+                total += ((objset_id *)js_get_pointer(val))->len;
+            else if (!is_empty_element(val))
+                break;
+        }
+
+        if (idx == len) {
+
+            if (total > js_str_max_bytes)
+                js_callthrow("RangeError_string_length");
+            if (!total)
+                js_return(env->str_empty);
+
+            objset_id *id = js_malloc(sizeof(objset_id) + total);
+            id->len = total;
+            id->flags = js_str_is_string;
+            id->hash = 0;
+
+            const wchar_t *sep = js_str_data(env, sep_val);
+            char *dst = (char *)id->data;
+            for (idx = 0; idx < len; idx++) {
+                if (idx && sep_len) {
+                    memcpy(dst, sep, sep_len);
+                    dst += sep_len;
+                }
+                const js_val val = get_fast_element(idx);
+                if (js_is_primitive_string(val)) {
+                    const uint32_t n =
+                        ((objset_id *)js_get_pointer(val))->len;
+                    memcpy(dst, js_str_data(env, val), n);
+                    dst += n;
+                }
+            }
+
+            js_return(js_gc_manage(env,
+                        js_make_primitive_string(id)));
+        }
+    }
+
+    // the general case.  note that converting an element
+    // to a string may call back into javascript, which may
+    // modify the array, so check the fast path every time.
+    // the builder owns the buffer, and such javascript code
+    // may also trigger the gc, so keep the builder on the
+    // stack until the end, see also js_callfunc1 () in func.c
+    js_val builder = js_str_builder_new(env);
+    js_strbuf *buf = ((js_priv *)js_get_pointer(builder))
+                                            ->val_or_ptr.ptr;
+    js_ensure_stack_at_least(1);
+    js_stk_top->value = builder;
+    js_stk_top = js_stk_top->next;
+
+    for (uint32_t idx = 0; idx < len; idx++) {
+
+        if (idx)
+            js_strbuf_append(env, buf, sep_val);
+
+        js_val val;
+        if (is_fast_array())
+            val = get_fast_element(idx);
+        else {
+            val = js_getprop(env, arr_val,
+                             js_make_number(idx),
+                            &dummy_shape_cache);
+        }
+        if (is_empty_element(val))
+            continue;
+        if (!js_is_primitive_string(val))
+            val = js_tostring(env, val);
+        js_strbuf_append(env, buf, val);
+    }
+
+    #undef is_fast_array
+    #undef get_fast_element
+    #undef is_empty_element
+
+    js_val ret_val = js_strbuf_finish(env, buf);
+    js_return(ret_val);
+}
+
+// ------------------------------------------------------------
+//
+// js_str_repeat
+//
+// ------------------------------------------------------------
+
+static js_val js_str_repeat (js_c_func_args) {
+    js_prolog_stack_frame();
+
+    // convert input 'this' value to string
+    if (!js_is_primitive_string(this_val)) {
+        js_throw_if_nullobj(env, this_val);
+        this_val = js_tostring(env, this_val);
+    }
+
+    js_val cnt_val = js_undefined;
+    js_link *arg_ptr = stk_args->next;
+    if (arg_ptr != js_stk_top)
+        cnt_val = arg_ptr->value;
+    if (!js_is_number(cnt_val))
+        cnt_val = js_tonumber(env, cnt_val);
+
+    double count = trunc(cnt_val.num);
+    if (count != count)
+        count = 0;
+    if (count < 0 || count == INFINITY)
+        js_callthrow("RangeError_invalid_argument");
+
+    const uint32_t len =
+                ((objset_id *)js_get_pointer(this_val))->len;
+    if (!len || !count)
+        js_return(env->str_empty);
+    if (count == 1)
+        js_return(this_val);
+
+    if (count * len > js_str_max_bytes)
+        js_callthrow("RangeError_string_length");
+    const uint32_t total = (uint32_t)count * len;
+
+    objset_id *id = js_malloc(sizeof(objset_id) + total);
+    id->len = total;
+    id->flags = js_str_is_string;
+    id->hash = 0;
+
+    // copy the string once, then keep doubling the part
+    // that was already filled
+    char *dst = (char *)id->data;
+    memcpy(dst, js_str_data(env, this_val), len);
+    for (uint32_t done = len; done < total; ) {
+        const uint32_t n = (done <= total - done)
+                         ? done : total - done;
+        memcpy(dst + done, dst, n);
+        done += n;
+    }
+
+    js_return(js_gc_manage(env,
+                js_make_primitive_string(id)));
+}
+
+// ------------------------------------------------------------
+//
+// js_str_pad_helper
+//
+// implements padStart and padEnd
+//
+// ------------------------------------------------------------
+
+static js_val js_str_pad_helper (js_environ *env, js_val str_val,
+                                 js_link *arg_ptr, bool at_start) {
+
+    // convert input 'this' value to string
+    if (!js_is_primitive_string(str_val)) {
+        js_throw_if_nullobj(env, str_val);
+        str_val = js_tostring(env, str_val);
+    }
+
+    js_val max_val = js_undefined;
+    js_val fill_val = js_undefined;
+    arg_ptr = arg_ptr->next;
+    if (arg_ptr != js_stk_top) {
+        max_val = arg_ptr->value;
+        arg_ptr = arg_ptr->next;
+        if (arg_ptr != js_stk_top)
+            fill_val = arg_ptr->value;
+    }
+
+    if (!js_is_number(max_val))
+        max_val = js_tonumber(env, max_val);
+    const uint32_t len =
+                ((objset_id *)js_get_pointer(str_val))->len;
+    if (!(max_val.num * sizeof(wchar_t) > len))
+        return str_val;
+
+    if (js_is_undefined(fill_val))
+        fill_val = js_str_char(env, L' ');
+    else if (!js_is_primitive_string(fill_val))
+        fill_val = js_tostring(env, fill_val);
+    const uint32_t fill_len =
+                ((objset_id *)js_get_pointer(fill_val))->len;
+    if (!fill_len)
+        return str_val;
+
+    if (trunc(max_val.num) * sizeof(wchar_t) > js_str_max_bytes)
+        js_callthrow("RangeError_string_length");
+    const uint32_t total =
+                (uint32_t)trunc(max_val.num) * sizeof(wchar_t);
+    if (total <= len)
+        return str_val;
+
+    objset_id *id = js_malloc(sizeof(objset_id) + total);
+    id->len = total;
+    id->flags = js_str_is_string;
+    id->hash = 0;
+
+    char *dst = (char *)id->data;
+    char *pad = dst;
+    if (at_start)
+        memcpy(dst + total - len, js_str_data(env, str_val), len);
+    else {
+        memcpy(dst, js_str_data(env, str_val), len);
+        pad += len;
+    }
+
+    // repeat the fill string, truncated at the end
+    const char *fill = (const char *)js_str_data(env, fill_val);
+    for (uint32_t left = total - len; left; ) {
+        const uint32_t n = (left < fill_len) ? left : fill_len;
+        memcpy(pad, fill, n);
+        pad += n;
+        left -= n;
+    }
+
+    return js_gc_manage(env, js_make_primitive_string(id));
+}
+
+// ------------------------------------------------------------
+//
+// js_str_padStart
+// js_str_padEnd
+//
+// ------------------------------------------------------------
+
+static js_val js_str_padStart (js_c_func_args) {
+    js_prolog_stack_frame();
+    const js_val ret_val = js_str_pad_helper(
+                    env, this_val, stk_args, true);
+    js_return(ret_val);
+}
+
+static js_val js_str_padEnd (js_c_func_args) {
+    js_prolog_stack_frame();
+    const js_val ret_val = js_str_pad_helper(
+                    env, this_val, stk_args, false);
+    js_return(ret_val);
+}
+
 // ------------------------------------------------------------
 //
 // js_str_init_sup
@@ -514,6 +1264,10 @@ static void js_str_init_sup (js_environ *env) {
 
     js_val name;
 
+    // buffer for console output, see js_str_output ()
+    env->out_buffer = js_malloc(js_str_out_buffer_size);
+    env->out_interactive = js_stdout_init();
+
     // shadow.js_str_print function
     js_newprop(env, env->shadow_obj,
             js_str_c(env, "js_str_print")) =
@@ -574,4 +1328,72 @@ static void js_str_init_sup (js_environ *env) {
     js_newprop(env, str_sup, name) =
         js_newfunc(env, js_str_concat_v, name, NULL,
                js_strict_mode | 1, /* closures */ 0);
+
+    // shadow.js_str_indexOf function
+    name = js_str_c(env, "indexOf");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_indexOf, name, NULL,
+               js_strict_mode | 1, /* closures */ 0);
+
+    // shadow.js_str_lastIndexOf function
+    name = js_str_c(env, "lastIndexOf");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_lastIndexOf, name, NULL,
+               js_strict_mode | 1, /* closures */ 0);
+
+    // shadow.js_str_includes function
+    name = js_str_c(env, "includes");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_includes, name, NULL,
+               js_strict_mode | 1, /* closures */ 0);
+
+    // shadow.js_str_startsWith function
+    name = js_str_c(env, "startsWith");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_startsWith, name, NULL,
+               js_strict_mode | 1, /* closures */ 0);
+
+    // shadow.js_str_endsWith function
+    name = js_str_c(env, "endsWith");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_endsWith, name, NULL,
+               js_strict_mode | 1, /* closures */ 0);
+
+    // shadow.js_str_split function
+    name = js_str_c(env, "split");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_split, name, NULL,
+               js_strict_mode | 2, /* closures */ 0);
+
+    // shadow.js_str_join function
+    name = js_str_c(env, "join");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_join, name, NULL,
+               js_strict_mode | 1, /* closures */ 0);
+
+    // shadow.js_str_repeat function
+    name = js_str_c(env, "repeat");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_repeat, name, NULL,
+               js_strict_mode | 1, /* closures */ 0);
+
+    // shadow.js_str_padStart function
+    name = js_str_c(env, "padStart");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_padStart, name, NULL,
+               js_strict_mode | 2, /* closures */ 0);
+
+    // shadow.js_str_padEnd function
+    name = js_str_c(env, "padEnd");
+    js_newprop(env, str_sup, name) =
+        js_newfunc(env, js_str_padEnd, name, NULL,
+               js_strict_mode | 2, /* closures */ 0);
+
+    // string builder functions, see js_str_builder ()
+    js_newprop(env, str_sup, js_str_c(env, "builder")) =
+                js_unnamed_func(js_str_builder, 0);
+    js_newprop(env, str_sup, js_str_c(env, "append")) =
+                js_unnamed_func(js_str_builder_append, 2);
+    js_newprop(env, str_sup, js_str_c(env, "finish")) =
+                js_unnamed_func(js_str_builder_finish, 1);
 }
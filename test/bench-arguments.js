@@ -0,0 +1,43 @@
+
+//
+// benchmark for calls to non-strict functions, which need
+// not create an 'arguments' object on every call, nor set
+// the 'arguments' and 'caller' properties of the function,
+// unless the program may observe them, see also js_arguments ()
+// in stack.c.  this file is deliberately not in strict mode.
+// build with 'make test/bench-arguments.js' and time the
+// executable.
+//
+
+function add (a, b) { return a + b; }
+
+function sum_of () {
+    // 'arguments' is only created on this path
+    if (typeof arguments[0] !== 'number')
+        return 0;
+    let sum = 0;
+    for (let i = 0; i < arguments.length; i++)
+        sum += arguments[i];
+    return sum;
+}
+
+function maybe_args (x, y) {
+    // 'arguments' is referenced but rarely created
+    return (x < 0) ? sum_of(...arguments) : x + y;
+}
+
+function plain_calls (count) {
+    let sum = 0;
+    for (let n = 0; n < count; n++)
+        sum = add(sum, n & 7);
+    return sum;
+}
+
+function lazy_calls (count) {
+    let sum = 0;
+    for (let n = 0; n < count; n++)
+        sum += maybe_args(n & 7, 1);
+    return sum + maybe_args(-1, 2) + sum_of(1, 2, 3);
+}
+
+console.log('checksum', plain_calls(50000000), lazy_calls(20000000));
@@ -0,0 +1,82 @@
+'use strict';
+
+//
+// benchmark for Map and Set with many deletes, which leave
+// deleted entries in the intmap and objset, until these are
+// compacted, see intmap_compact () and objset_delete ().
+// the memory use should stay flat while the loops run.
+// build with 'make test/bench-churn.js' and time the
+// executable, and watch its memory use.
+//
+
+function map_as_queue (count) {
+
+    // keep a window of 1000 keys, adding the newest and
+    // deleting the oldest, and iterate the whole window
+    // now and then, which should not get slower over time
+    const map = new Map();
+    let sum = 0;
+    for (let n = 0; n < count; n++) {
+        map.set(n, n & 255);
+        if (n >= 1000)
+            map.delete(n - 1000);
+        if ((n & 65535) === 0) {
+            for (const v of map.values())
+                sum += v;
+        }
+    }
+    return sum + map.size;
+}
+
+function map_as_lru (count) {
+
+    // string keys also go through the objset of the map.
+    // a key which is used again is moved to the end
+    const map = new Map();
+    const keys = [];
+    for (let i = 0; i < 4096; i++)
+        keys.push('key_' + i);
+
+    let hits = 0;
+    for (let n = 0; n < count; n++) {
+        const key = keys[(n * 40503) & ((n & 1) ? 255 : 4095)];
+        const val = map.get(key);
+        if (val !== undefined) {
+            map.delete(key);
+            hits++;
+        } else if (map.size >= 512) {
+            for (const oldest of map.keys()) {
+                map.delete(oldest);
+                break;
+            }
+        }
+        map.set(key, n);
+    }
+    return hits + map.size;
+}
+
+function set_grow_shrink (rounds) {
+
+    // fill a set, then delete most of it, and iterate the
+    // few entries left many times, which should not have
+    // to skip over the deleted entries
+    let sum = 0;
+    for (let r = 0; r < rounds; r++) {
+        const set = new Set();
+        for (let i = 0; i < 200000; i++)
+            set.add(i);
+        for (let i = 10; i < 200000; i++)
+            set.delete(i);
+        for (let k = 0; k < 10000; k++) {
+            for (const v of set)
+                sum += v;
+        }
+        set.clear();
+        sum += set.size;
+    }
+    return sum;
+}
+
+console.log('checksum', map_as_queue(20000000),
+                        map_as_lru(5000000),
+                        set_grow_shrink(10));
@@ -0,0 +1,60 @@
+'use strict';
+
+//
+// benchmark for creating closures inside loops, where each
+// function object captures the variables of its scope, see
+// js_newclosure () and js_newfunc () in func.c.  the variables
+// of one scope share a single closure record, and accesses
+// skip the check for a reference before initialization, when
+// the variable is known to be initialized.
+// build with 'make test/bench-closures.js' and time the
+// executable.
+//
+
+function make_counters (count) {
+
+    // sibling closures which share the variables of a scope
+    let sum = 0;
+    for (let n = 0; n < count; n++) {
+        let value = n & 255;
+        const step = 3;
+        const inc = () => (value += step);
+        const get = () => value;
+        inc();
+        sum += get();
+    }
+    return sum;
+}
+
+function per_iteration (count) {
+
+    // a closure captures the loop variables, which are
+    // copied on every iteration, and also variables
+    // declared outside the loop, which are forwarded
+    const scale = 2;
+    let sum = 0;
+    for (let i = 0; i < count; i++) {
+        const f = (x) => x * scale + (i & 7);
+        sum += f(1);
+    }
+    return sum;
+}
+
+function nested (count) {
+
+    // the inner arrow function reaches the outer variables
+    // through the closure array of the function in between
+    let total = 0;
+    const base = 1;
+    function middle (k) {
+        const add = (x) => x + base + k;
+        return add(total & 15);
+    }
+    for (let n = 0; n < count; n++)
+        total += middle(n & 3);
+    return total;
+}
+
+console.log('checksum', make_counters(1000000),
+                        per_iteration(1000000),
+                        nested(1000000));
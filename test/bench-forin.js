@@ -0,0 +1,64 @@
+'use strict';
+
+//
+// benchmark for for-in loops and Object.keys (), on objects
+// that share a few shapes.  the keys of each shape are listed
+// once, and then read from the list that is kept in the
+// shape, see js_shape_get_keys () and js_forin_new ().
+// build with 'make test/bench-forin.js' and time the
+// executable.
+//
+
+function make_objects (count) {
+
+    const objs = [];
+    for (let i = 0; i < count; i++) {
+        const obj = { id: i, name: 'item', size: i & 15 };
+        if (i & 1)
+            obj.extra = true;
+        objs.push(obj);
+    }
+    return objs;
+}
+
+function forin_loop (objs, rounds) {
+
+    let sum = 0;
+    for (let r = 0; r < rounds; r++) {
+        for (const obj of objs) {
+            for (const key in obj)
+                sum += key.length;
+        }
+    }
+    return sum;
+}
+
+function keys_values (objs, rounds) {
+
+    let sum = 0;
+    for (let r = 0; r < rounds; r++) {
+        for (const obj of objs) {
+            sum += Object.keys(obj).length;
+            sum += Object.values(obj).length;
+        }
+    }
+    return sum;
+}
+
+function forin_array (rounds) {
+
+    const arr = [];
+    for (let i = 0; i < 1000; i++)
+        arr.push(i);
+    let sum = 0;
+    for (let r = 0; r < rounds; r++) {
+        for (const index in arr)
+            sum += arr[index];
+    }
+    return sum;
+}
+
+const objs = make_objects(1000);
+console.log('checksum', forin_loop(objs, 2000),
+                        keys_values(objs, 2000),
+                        forin_array(2000));
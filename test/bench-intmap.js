@@ -0,0 +1,66 @@
+'use strict';
+
+//
+// benchmark for the int64-to-int64 map in intmap.c, which
+// holds the property keys of a shape, and the keys of a
+// Map or Set.  the keys are interned string pointers,
+// object pointers, and numbers.  build with
+// 'make test/bench-intmap.js' and time the executable.
+//
+
+function shape_lookups (count) {
+
+    // an object with many properties has a large shape,
+    // and each computed access looks up the interned key
+    const obj = {};
+    const keys = [];
+    for (let i = 0; i < 64; i++) {
+        keys.push('prop_' + i);
+        obj[keys[i]] = i;
+    }
+
+    let sum = 0;
+    for (let n = 0; n < count; n++)
+        sum += obj[keys[n & 63]];
+    return sum;
+}
+
+function map_pointer_keys (count) {
+
+    const objs = [];
+    for (let i = 0; i < 4096; i++)
+        objs.push({ i });
+
+    const map = new Map();
+    let sum = 0;
+    for (let n = 0; n < count; n++) {
+        const obj = objs[n & 4095];
+        if (map.has(obj))
+            sum += map.get(obj);
+        else
+            map.set(obj, n & 7);
+        if ((n & 8191) === 8191)
+            map.delete(objs[(n >> 13) & 4095]);
+    }
+    return sum;
+}
+
+function map_integer_keys (count) {
+
+    const map = new Map();
+    const set = new Set();
+    let sum = 0;
+    for (let n = 0; n < count; n++) {
+        const key = (n * 7) & 16383;
+        map.set(key, (map.get(key) || 0) + 1);
+        if (!set.has(key & 1023))
+            set.add(key & 1023);
+    }
+    for (let k = 0; k < 16384; k += 3)
+        sum += map.get(k) || 0;
+    return sum + set.size;
+}
+
+console.log('checksum', shape_lookups(20000000),
+                        map_pointer_keys(5000000),
+                        map_integer_keys(5000000));
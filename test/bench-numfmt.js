@@ -0,0 +1,49 @@
+'use strict';
+
+//
+// benchmark for converting numbers to strings, see
+// js_num_tostring () in num.c and js_num_shortest () in
+// numfmt.c.  fractions need the shortest digits that read
+// back as the same double, large and small magnitudes use
+// exponent notation, and small integers come from a table.
+// build with 'make test/bench-numfmt.js' and time the
+// executable.
+//
+
+function fractions (count) {
+
+    // pseudo-random doubles from a linear congruential
+    // generator, so every run converts the same values
+    let seed = 12345, len = 0;
+    for (let n = 0; n < count; n++) {
+        seed = (seed * 1103515245 + 12345) % 2147483648;
+        len += String(seed / 2147483648 * 1000).length;
+    }
+    return len;
+}
+
+function magnitudes (count) {
+
+    let len = 0, x = 1.5;
+    for (let n = 0; n < count; n++) {
+        len += ('' + x).length;
+        x = (n & 255) === 255 ? 1.5 : x * 7.25;
+        if ((n & 1) === 0)
+            len += ('' + 1 / x).length;
+    }
+    return len;
+}
+
+function integers (count) {
+
+    let len = 0;
+    for (let n = 0; n < count; n++) {
+        len += String(n & 1023).length;
+        len += String(n * 4099).length;
+    }
+    return len;
+}
+
+console.log('checksum', fractions(500000),
+                        magnitudes(500000),
+                        integers(1250000));
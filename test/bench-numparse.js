@@ -0,0 +1,57 @@
+'use strict';
+
+//
+// benchmark for converting strings to numbers, see
+// js_num_parse_decimal () in numparse.c.  the corpus holds
+// short and long decimals, exponents, integers, and hex
+// and binary literals, which are parsed with Number (),
+// unary plus, parseFloat () and parseInt ().
+// build with 'make test/bench-numparse.js' and time the
+// executable.
+//
+
+function make_corpus (count) {
+
+    // pseudo-random values from a linear congruential
+    // generator, so every run parses the same strings
+    const corpus = [];
+    let seed = 12345;
+    const next = () => (seed = (seed * 1103515245 + 12345)
+                                            % 2147483648);
+    for (let i = 0; i < count; i++) {
+        const r = next();
+        switch (i & 7) {
+            case 0: corpus.push(String(r)); break;
+            case 1: corpus.push(String(r / 2147483648)); break;
+            case 2: corpus.push((r / 1000).toFixed(3)); break;
+            case 3: corpus.push(r + 'e' + ((next() & 511) - 255));
+                    break;
+            case 4: corpus.push('-' + r + '.' + next() + next());
+                    break;
+            case 5: corpus.push('0x' + r.toString(16)); break;
+            case 6: corpus.push(' ' + (r & 65535) + ' '); break;
+            case 7: corpus.push('0.000' + next() + 'e-10'); break;
+        }
+    }
+    return corpus;
+}
+
+function parse_all (corpus, rounds) {
+
+    let sum = 0;
+    for (let round = 0; round < rounds; round++) {
+        for (let i = 0; i < corpus.length; i++) {
+            const s = corpus[i];
+            const a = Number(s), b = +s;
+            const c = parseFloat(s), d = parseInt(s);
+            if (a === b && a === a)
+                sum += (a !== 0 && a > -1e9 && a < 1e9) ? 1 : 2;
+            if (c === c && d === d)
+                sum += (c < d) ? 3 : 4;
+        }
+    }
+    return sum;
+}
+
+const corpus = make_corpus(100000);
+console.log('checksum', corpus.length, parse_all(corpus, 20));
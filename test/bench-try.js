@@ -0,0 +1,29 @@
+'use strict';
+
+//
+// benchmark for try blocks in a hot loop.  most
+// iterations enter and leave a try block without
+// throwing, and a small fraction throw and catch.
+// build with 'make test/bench-try.js' and time the
+// resulting executable.
+//
+
+function check (i) {
+    if ((i & 1023) === 0)
+        throw i;
+    return i & 7;
+}
+
+function run (count) {
+    let sum = 0, caught = 0;
+    for (let i = 0; i < count; i++) {
+        try {
+            sum += check(i);
+        } catch (e) {
+            caught++;
+        }
+    }
+    return sum + caught;
+}
+
+console.log('checksum', run(20000000));
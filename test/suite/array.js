@@ -72,6 +72,82 @@ console.log(...arr);
     for (let v of m)
         console.log('MAP VALUE<',v,'>');
 
+    // many keys, and a deleted key added again goes last
+    const m2 = new Map();
+    for (let i = 0; i < 1000; i++)
+        m2.set(i * 4096, i);
+    for (let i = 0; i < 1000; i += 2)
+        m2.delete(i * 4096);
+    m2.set(0, 'again');
+    let sum = 0;
+    for (let [k, v] of m2)
+        sum += (typeof v === 'number') ? v : 0;
+    let last;
+    for (let [k, v] of m2)
+        last = k + ':' + v;
+    console.log('MAP SIZE', m2.size, sum, last, m2.get(4096));
+
+    // entries added during iteration are visited, deleted
+    // entries are not, even if the map is resized or cleared
+    const m3 = new Map([ [ 'a', 1 ], [ 'b', 2 ], [ 'c', 3 ] ]);
+    let seen = '';
+    for (const [k, v] of m3) {
+        seen += k + v + ' ';
+        if (k === 'a') {
+            m3.delete('b');
+            for (let i = 0; i < 20; i++)
+                m3.set('x' + i, i);
+        }
+        if (k === 'x19') {
+            m3.clear();
+            m3.set('z', 26);
+        }
+    }
+    console.log('MAP ITER', seen, m3.size);
+
+    // deleting most entries during iteration compacts the map
+    const m5 = new Map();
+    for (let i = 0; i < 100; i++)
+        m5.set('k' + i, i);
+    let visited = 0, vsum = 0;
+    for (const [k, v] of m5) {
+        visited++;
+        vsum += v;
+        if (v === 10)
+            for (let i = 0; i < 95; i++)
+                m5.delete('k' + i);
+    }
+    console.log('MAP COMPACT', visited, vsum, m5.size, [ ...m5.keys() ].join());
+
+    const it = m3.entries();
+    const e1 = it.next(), e2 = it.next();
+    console.log('MAP NEXT', e1.value, e1.done, e2.value, e2.done,
+                it.next().done, e1.value !== it, String(it));
+    const keys = [], values = [], pairs = [];
+    const m4 = new Map([ [ 'p', 'q' ], [ 'r', 's' ] ]);
+    for (const k of m4.keys()) keys.push(k);
+    for (const v of m4.values()) values.push(v);
+    for (const [k, v] of m4) pairs.push([ k, v ]);
+    const arr = [ ...m4 ];
+    console.log('MAP ITERS', keys.join(), values.join(),
+                pairs.join(';'), arr.join(';'), arr[0] !== arr[1]);
+    m4.forEach(function (v, k, m) {
+        console.log('MAP FOREACH', k, v, m === m4, this.t);
+    }, { t: 'this' });
+
+    // array destructuring and spread see the current length
+    const a = [ 1, 2, 3 ];
+    let total = 0;
+    for (const x of a) {
+        total += x;
+        if (a.length < 6)
+            a.push(x * 10);
+    }
+    const src = [ 'P', 'skip', undefined, 4, 5 ];
+    let p, q, rest;
+    [ p, , q, ...rest ] = src;
+    console.log('ARRAY ITER', total, p, q, rest.join(), [ ...[ 1, , 3 ] ].join());
+
 })();
 
 
@@ -89,4 +165,72 @@ console.log(...arr);
     for (let v of s)
         console.log('SET VALUE<',v,'>');
 
+    s.forEach((v, k) => console.log('SET FOREACH', v, k));
+    console.log(s.add('x') === s, s.has('x'), s.delete('x'), s.has('x'), s.size);
+    console.log(Map.prototype.get.name, Map.prototype.set.length,
+                Set.prototype.add.name, Set.prototype.delete.length);
+    try {
+        Map.prototype.get.call(s, 123);
+    } catch (e) {
+        console.log('ERROR', e instanceof TypeError);
+    }
+
+})();
+
+// for-of over arrays, where the array or its iterator was
+// modified, and where the array grows or shrinks in the loop
+;(function () {
+
+    const out = [];
+    const a = [ 1, , 3 ];
+    for (const x of a) out.push(x);
+    Array.prototype[1] = 'proto';
+    for (const x of a) out.push(x);
+    delete Array.prototype[1];
+    const b = [ 'b1', 'b2' ];
+    b.extra = true;
+    for (const x of b) out.push(x);
+    b[Symbol.iterator] = function* () { yield 'own'; };
+    for (const x of b) out.push(x);
+    const saved_next = [][Symbol.iterator]().__proto__.next;
+    [][Symbol.iterator]().__proto__.next = function () {
+        return { done: true };
+    };
+    for (const x of [ 'hidden' ]) out.push(x);
+    [][Symbol.iterator]().__proto__.next = saved_next;
+    const c = [ 1, 2, 3, 4 ];
+    for (const x of c) {
+        out.push(x);
+        if (x === 2) c.length = 3;
+    }
+    const d = [ 'd' ];
+    Object.defineProperty(d, 1, { get () { return 'getter'; }, enumerable: true });
+    for (const x of d) out.push(x);
+    console.log('FOR OF', out.join());
+
+})();
+
+// spread and rest, with holes, array-like objects, and
+// elements or arguments which follow the spread
+;(function () {
+
+    function count () { return arguments.length; }
+    function last () { return arguments[arguments.length - 1]; }
+    function spread_arguments () { return [ 'x', ...arguments ]; }
+    const big = [];
+    for (let i = 0; i < 5000; i++) big.push(i);
+    const two = [ 1, 2 ];
+    const holes = [ 'h', , 'j' ];
+    console.log('SPREAD', [ ...two, 3, 4, 5, 6, 7, 8 ].join(), [ ...two, ...two, ...[] ].length,
+                [ ...holes ].join('/'), 1 in [ ...holes ], [ ...'ab', ...new Set([ 'c', 'd' ]) ].join());
+    console.log('SPREAD', count(...big), count(0, ...big, 1, 2, 3), last(...big, 'end'),
+                Math.max(...big), Math.min(9, ...two), spread_arguments(5, 6, 7).join());
+    const [ first, ...rest ] = big;
+    const [ , ...rest2 ] = holes;
+    const [ ...rest3 ] = 'xyz';
+    console.log('REST', first, rest.length, rest[4998], rest2.join('/'), rest2.length, rest3.join());
+    Array.prototype[1] = 'proto';
+    console.log('SPREAD', [ ...holes ].join('/'), count(...holes));
+    delete Array.prototype[1];
+
 })();
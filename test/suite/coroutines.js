@@ -201,3 +201,82 @@
 
 })();
 
+
+//
+// test generators which are compiled as a state machine,
+// rather than as a coroutine, see generator_scanner.js
+//
+
+;(function () {
+
+    let calls = 0;
+    function count () { return ++calls; }
+
+    function* gen (a, b = count(), ...rest) {
+        var total = a;
+        const k = 10;
+        outer: for (let i = 0; i < b; i++) {
+            const sq = i * i;
+            let j = 0;
+            while (j < 3) {
+                j++;
+                if (j === 2)
+                    continue outer;
+                const sent = yield [ i, j, sq + k ];
+                total += sent || 0;
+            }
+        }
+        let x;
+        x = yield rest.length;
+        if (x)
+            yield x + total;
+        return total;
+    }
+
+    const g = gen(1, undefined, 'r1', 'r2');
+    console.log('calls before next', calls);
+    console.log(g.next());
+    console.log(g.next(5), g.next(7));
+    console.log([ ...gen(100, 2) ]);
+
+    // return () and throw () without try blocks
+    const g2 = gen(1, 3);
+    console.log(g2.next(), g2.return('early'), g2.next());
+    const g3 = gen(1, 3);
+    g3.next();
+    try { g3.throw(new Error('thrown')); }
+    catch (e) { console.log('caught', e.message); }
+    console.log(g3.next());
+
+    // exception raised inside the generator
+    function* gen_throw (n) {
+        yield n;
+        null.foo;
+        yield n + 1;
+    }
+    const g4 = gen_throw(1);
+    console.log(g4.next());
+    try { g4.next(); } catch (e) { console.log('caught', e.name); }
+    console.log(g4.next());
+
+    // resuming a running generator
+    let g5;
+    function* gen_reenter () { yield g5.next(); }
+    g5 = gen_reenter();
+    try { g5.next(); } catch (e) { console.log('caught', e.name); }
+
+    // values kept across many yields, while gc runs
+    function* gen_objects (n) {
+        for (let i = 0; i < n; i++) {
+            const obj = { i, s: 'v' + i };
+            yield obj.i;
+            if (obj.s !== 'v' + i)
+                throw new Error('lost ' + i);
+        }
+    }
+    let sum = 0;
+    for (const v of gen_objects(100000))
+        sum += v;
+    console.log('sum', sum);
+
+})();
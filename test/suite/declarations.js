@@ -108,3 +108,96 @@ test (function () {
   y.call(1234, 55,66);
 
 }).call('THIS', 77,88);
+
+// ------------
+//
+// 'arguments' created on first reference
+//
+// ------------
+
+;(function () {
+
+  function count () { return arguments.length; }
+  function second (a) { return a > 0 ? arguments[1] : 'none'; }
+  function join3 (a, b, c) { return a + ',' + b.length + ',' + c; }
+  function pass_along () {
+      // created while other arguments are pushed for a call
+      return join3(arguments.length, arguments, arguments[0]);
+  }
+  function in_try () {
+      let result = 'none';
+      try { if (arguments.length > 1) throw arguments[1]; }
+      catch (e) { result = 'caught ' + e; }
+      return result + ' of ' + arguments.length;
+  }
+  function in_arrow () { return () => arguments[0]; }
+  function twice () { return arguments === arguments; }
+  function update () {
+      // several references in one statement, and in loops
+      arguments[0] = 'x'; arguments[1] += 1;
+      let s = '';
+      for (let i = 0; i < arguments.length; i++) s += arguments[i];
+      do { s += '|' + arguments.length; } while (!arguments);
+      return s;
+  }
+
+  console.log(count(), count(1, 2, 3), second(0, 5), second(1, 5));
+  console.log(pass_along('a', 'b'));
+  console.log(in_try(1), in_try(1, 2));
+  console.log(in_arrow('closure')(), twice());
+  console.log(update(1, 2, 3), update());
+  test(function () { return arguments.callee; });
+
+})()
+
+// ------------
+//
+// closure variables of one scope share a closure record
+//
+// ------------
+
+;(function () {
+
+  // sibling closures share the variables of a scope
+  function counter (start) {
+      let count = start, step = 1;
+      return [ () => (count += step), (n) => (step = n), () => count ];
+  }
+  const fns3 = counter(10);
+  fns3[0]();
+  fns3[1](5);
+  fns3[0]();
+  console.log(fns3[2](), fns3[0]());
+
+  // each iteration gets its own copy of the loop variables
+  const fns = [];
+  for (let i = 0, j = 10; i < 3; i++, j--)
+      fns.push(() => i + ':' + j);
+  for (const s of [ 'a', 'b' ])
+      fns.push(() => s);
+  for (const [ k, v ] of [ [ 'x', 1 ], [ 'y', 2 ] ])
+      fns.push(() => k + v);
+  let text = '';
+  for (const f of fns)
+      text += f() + ' ';
+  console.log(text);
+
+  // forwarded through a function which does not use them
+  function outer (a) {
+      var b = a + 1;
+      let c = () => a + b;
+      return function middle () { return () => c() + a; };
+  }
+  console.log(outer(1)()());
+
+  // parameters share a record, even with an initializer
+  function defaults (a, b = a + 1, ...c) { a = 5; return () => a + b + c.length; }
+  console.log(defaults(1)(), defaults(1, 1, 1)());
+
+  // reference before the declaration is still detected
+  test(() => { const f = () => late; f(); let late = 1; });
+  test(() => { function f () { return late; } f(); const late = 2; });
+  let early = 'early';
+  console.log((() => early)());
+
+})()
@@ -148,3 +148,66 @@
     f3();f3(undefined);f3({ x: 'a', y: 'b', z: 'c' });
 
 })();
+
+// ------------
+// test 8
+// ------------
+
+;(function () {
+
+    // destructuring from a literal, without allocation
+    let a = 1, b = 2;
+    [a, b] = [b, a];
+    const [c, , d, e] = [a, b, 7];
+    let u, v, w;
+    ({ u, v = 5, w: w } = { u: a + b, v: undefined, w: 'w', x: 0 });
+    console.log(a, b, c, d, e, u, v, w);
+
+    // object literals which never escape the function
+    const p = { x: 1, y: 2, 'z': 3 };
+    for (let i = 0; i < 3; i++) {
+        p.x += p.y;
+        p['z']++;
+    }
+    const q = { k: 1 };
+    try { q.k = 4; throw q.k; } catch (e) { q.k += e; }
+    const r = { m: 1 };
+    console.log(p.x, p.y, p.z, q.k, r, r.toString === Object.prototype.toString);
+
+})();
+
+// ------------
+// test 9
+// ------------
+
+;(function () {
+
+    // destructuring from a literal, with a modified iterator
+    let m, n, calls = 0;
+    [m, n] = [1, 2];
+    console.log(m, n);
+
+    const saved_next = [][Symbol.iterator]().__proto__.next;
+    [][Symbol.iterator]().__proto__.next = function () {
+        calls++;
+        return calls > 1 ? { done: true } : { value: 'patched' };
+    };
+    [m, n] = [1, 2];
+    [][Symbol.iterator]().__proto__.next = saved_next;
+    console.log(m, n, calls);
+
+    const saved_iter = Array.prototype[Symbol.iterator];
+    Array.prototype[Symbol.iterator] = function* () {
+        yield 10; yield 30;
+    };
+    [m, , n] = [1, 2, 3];
+    Array.prototype[Symbol.iterator] = saved_iter;
+    console.log(m, n);
+
+    // unused elements are still evaluated, in order
+    let order = '';
+    const step = (s) => (order += s);
+    [ , m ] = [ step('a'), 'b', 'c' ];
+    ({ n } = { m: step('d'), n: step('e') });
+    console.log(m, n, order);
+})();
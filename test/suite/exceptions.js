@@ -69,3 +69,45 @@
     })(null, {}, [], null)
 
 })()
+
+//
+// test try blocks in a loop, including break and
+// continue out of one or more nested try blocks
+//
+
+;(function () {
+
+    let n = 0;
+    for (let i = 0; i < 10; i++) {
+        try {
+            if (i === 2)
+                continue;
+            try {
+                if (i === 5)
+                    throw i;
+                if (i === 7)
+                    break;
+                n += i;
+            } catch (e) { n += 100; throw e; }
+        } catch (e) {
+            console.log('caught', e);
+        }
+    }
+    console.log('n', n);
+
+    outer: for (let i = 0; i < 3; i++) {
+        for (let j = 0; j < 3; j++) {
+            try {
+                if (j === 1)
+                    continue outer;
+                if (i === 2)
+                    break outer;
+            } catch (e) { }
+        }
+    }
+
+    // the handlers above must have been discarded
+    try { throw 'after loops'; }
+    catch (e) { console.log(e); }
+
+})()
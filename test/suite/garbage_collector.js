@@ -80,3 +80,284 @@ if (!global.gc)
     })(1);
 
 })();
+
+//
+// test reuse of coroutine stacks
+//
+
+;(function () {
+
+    // not a state machine generator, because of 'try'
+    function* g (n) {
+        try {
+            for (let i = 0; i < n; i++)
+                yield 'TestString_' + i;
+        } finally {}
+    }
+
+    let s = '';
+    for (let k = 0; k < 100; k++) {
+        for (const v of g(2))
+            s = v;
+        if (k === 50)
+            gc(true);
+    }
+    console.log(s + '!');
+
+    // node has no pool of coroutine stacks, so the checks
+    // below are only made when running compiled code
+    const native = typeof process === 'undefined';
+    let stats = gc.coroutines;
+    console.log(!native || stats !== undefined);
+
+    // all but the first generator reuse a stack
+    console.log(!native || (stats.stack_size === 256 * 1024
+                            && stats.max_free === 16
+                            && stats.free >= 1
+                            && stats.free <= stats.max_free
+                            && stats.reused >= 99
+                            && stats.active === 0
+                            && stats.max_stack_used > 0
+                            && stats.max_stack_used < stats.stack_size));
+
+    // the stack size is rounded up to 64 KB, at least 64 KB
+    const stack_size = gc.coroutine_stack_size;
+    const max_free = gc.coroutine_max_free;
+    gc.coroutine_stack_size = 100000;
+    console.log(!native || gc.coroutine_stack_size === 131072);
+    gc.coroutine_stack_size = 1;
+    console.log(!native || gc.coroutine_stack_size === 65536);
+
+    // at most 'max_free' finished stacks are kept for reuse,
+    // and stacks of the previous size are discarded
+    gc.coroutine_max_free = 2;
+    const gens = [];
+    for (let k = 0; k < 5; k++) {
+        gens.push(g(2));
+        gens[k].next();
+    }
+    console.log(!native || gc.coroutines.active === 5);
+    for (const it of gens)
+        while (!it.next().done);
+    stats = gc.coroutines;
+    console.log(!native || (stats.free === 2 && stats.active === 0
+                            && stats.max_free === 2
+                            && stats.stack_size === 65536));
+
+    gc.coroutine_stack_size = stack_size;
+    gc.coroutine_max_free = max_free;
+    console.log(!native || (gc.coroutines.free === 0
+                            && gc.coroutine_max_free === 16));
+})();
+
+//
+// test collection of strings interned only for lookups
+//
+
+;(function () {
+
+    const o = { Key_1: 1 };
+    let found = 0;
+    for (let i = 0; i < 2000; i++) {
+        if (o['Key_' + i] !== undefined)
+            found++;
+    }
+    gc(true); gc(true);
+
+    // look up the same keys again after the sweep, then
+    // make one of them a real property, and sweep again
+    for (let i = 0; i < 2000; i++) {
+        if (o['Key_' + i] !== undefined)
+            found++;
+    }
+    o['Key_' + 1500] = 2;
+    gc(true); gc(true);
+    console.log(found, o.Key_1 + o.Key_1500, Object.getOwnPropertyNames(o).join());
+})();
+
+//
+// test weak collections
+//
+
+;(function () {
+
+    const wm = new WeakMap();
+    const ws = new WeakSet();
+    const live = { name: 'live' };
+    wm.set(live, 'Live' + 'Value');
+    ws.add(live);
+
+    // the values are only reachable through their keys,
+    // and the first value is the key of the next entry
+    let first = { n: 0 };
+    let key = first;
+    for (let i = 1; i < 100; i++) {
+        const next = { n: i };
+        wm.set(key, next);
+        key = next;
+    }
+    wm.set(key, 'Last' + 'Value');
+
+    // keys which are dropped, each with a large value
+    let dropped = 0;
+    const registry = new FinalizationRegistry(held => {
+        dropped += held;
+    });
+    const ref = (function () {
+        for (let i = 0; i < 10; i++) {
+            const k = { i };
+            const big = [];
+            for (let j = 0; j < 1000; j++)
+                big.push({ j });
+            wm.set(k, big);
+            ws.add(k);
+            registry.register(k, 1);
+        }
+        return new WeakRef({ dropped: true });
+    })();
+    const token = {};
+    registry.register(live, 100, token);
+
+    // clear the stack of any leftover references
+    ;(function r (depth) {
+        const a = 1; const b = 2; const c = 3;
+        const d = 4; const e = 5; const f = 6;
+        if (depth < 4)
+            r(depth + 1);
+    })(1);
+    gc(true); gc(true);
+
+    let chain = 0;
+    for (key = first; typeof key === 'object'; key = wm.get(key))
+        chain++;
+    console.log(chain, key, wm.get(live), ws.has(live),
+                wm.has({}), ws.has(first), wm.get(1));
+    console.log(!gc.vcount || (ref.deref() === undefined
+                               && dropped === 10));
+
+    console.log(registry.unregister(token),
+                registry.unregister(token));
+
+    try {
+        wm.set(1, 1);
+    } catch (e) {
+        console.log(e instanceof TypeError);
+    }
+    try {
+        new WeakRef('string');
+    } catch (e) {
+        console.log(e instanceof TypeError);
+    }
+
+    // a symbol can be a weak key, unless it is registered
+    // by Symbol.for (), and the gc keeps such keys alive
+    const sym_map = new WeakMap();
+    const sym_set = new WeakSet();
+    const sym_ref = (function () {
+        const sym = Symbol('weak');
+        sym_map.set(sym, { value: 'Sym' + 'Value' });
+        sym_set.add(sym);
+        registry.register(sym, 1000);
+        return new WeakRef(sym);
+    })();
+    gc(true); gc(true);
+    const sym = sym_ref.deref();
+    console.log(typeof sym, sym_map.get(sym).value, sym_set.has(sym),
+                sym_map.has(Symbol('weak')), dropped < 1000);
+    for (const f of [ () => sym_map.set(Symbol.for('reg'), 1),
+                      () => sym_set.add(Symbol.for('reg')),
+                      () => new WeakRef(Symbol.for('reg')),
+                      () => registry.register(Symbol.for('reg'), 1) ]) {
+        try {
+            f();
+        } catch (e) {
+            console.log(e instanceof TypeError);
+        }
+    }
+    console.log(sym_map.get(Symbol.for('reg')),
+                sym_set.has(Symbol.for('reg')),
+                sym_map.delete(Symbol.for('reg')));
+})();
+
+//
+// test keys of the element store, created while gc runs
+//
+
+;(function () {
+
+    const threshold = gc.threshold;
+    gc.threshold = 100;
+
+    const big = {};
+    for (let i = 0; i < 5000; i++)
+        big[i * 3] = i;
+
+    let count = 0, bad = 0;
+    for (let round = 0; round < 4; round++) {
+        for (const k in big) {
+            if (big[k] * 3 !== +k)
+                bad++;
+            count++;
+        }
+        const keys = Object.keys(big);
+        const junk = [];
+        for (let i = 0; i < 1000; i++)
+            junk.push({ i });
+        for (let i = 0; i < keys.length; i++) {
+            if (keys[i] !== String(i * 3))
+                bad++;
+        }
+        for (const [ k, v ] of Object.entries(big)) {
+            if (k !== String(v * 3))
+                bad++;
+        }
+        for (let j = 0; j < 5; j++) {
+            const names = Object.getOwnPropertyNames(big);
+            for (let i = 0; i < 5000; i++)
+                junk.push('Junk' + i);
+            for (let i = 0; i < names.length; i++) {
+                if (names[i] !== String(i * 3))
+                    bad++;
+            }
+        }
+    }
+
+    gc.threshold = threshold;
+    console.log(count, bad);
+})();
+
+//
+// test join, when converting an element runs the gc
+//
+
+;(function () {
+
+    const elem = {
+        toString () {
+            const junk = [];
+            for (let i = 0; i < 1000; i++)
+                junk.push({ i }, 'Junk' + i);
+            gc(true); gc(true);
+            return 'x' + junk.length;
+        }
+    };
+    const arr = [];
+    for (let i = 0; i < 50; i++)
+        arr.push(elem, i);
+    const str = arr.join('-');
+    console.log(str.length, str.slice(0, 16), str.slice(-12));
+})();
+
+//
+// test closure variables, which are set without notifying
+// the gc, see js_gc_closures ()
+//
+
+;(function () {
+
+    let map = new Map([[ 'key', 'Closure' + 'Value' ]]);
+    const get_map = () => map;
+    for (let i = 0; i < 5; i++)
+        gc(true);
+    console.log(get_map().get('key'), map.size);
+})();
@@ -346,3 +346,24 @@ console.log('min ', Math.min(), Math.min(1, NaN), Math.min(10, 200, +Infinity, 5
         if (i >= 95) console.log(n1.toFixed(8));
         const n3 = n1 + n2; n1 = n2; n2 = n3;
     } } )()
+
+// number to string, shortest round-trip digits
+console.log(String(0.1 + 0.2), String(1 / 3), String(2 / 3), String(123.456));
+console.log(String(1e21), String(1e20), String(123e-20), String(1e-6), String(1e-7));
+console.log(String(2 ** 53), String(2 ** 63), String(2 ** 64), String(-1.5e300));
+console.log(String(5e-324), String(Number.MAX_VALUE), String(-Infinity));
+;(function () {
+    let x = 0.5, s = '';
+    for (let i = 0; i < 10; i++) { s += String(x) + ' '; x = x * 3.3 - 0.01; }
+    console.log(s);
+    console.log(String(7) === String(3 + 4), String(1023) + String(1024));
+} )()
+
+// string to number
+console.log(Number(' 12 '), Number('.5'), Number('5.'), Number('-.5e1'), Number('1e'), Number('0x1F'), Number('-0x10'));
+console.log(Number('0b101'), Number('0o17'), Number('Infinity'), Number('-Infinity'), Number('infinity'), Number(''));
+console.log(Number('0.30000000000000004'), Number('123456789012345678901234567890'), Number('2.2250738585072012e-308'));
+console.log(Number('4.9e-324'), Number('1e400'), Number('1e-400'), Number('9007199254740993'), Number('12px'));
+console.log(parseFloat('1e+5x'), parseFloat('-.25abc'), parseFloat('0x10'), parseFloat('Infinityx'), parseFloat('.'));
+console.log(parseInt('  -17.9'), parseInt('0x1F'), parseInt('1f', 16), parseInt('0x1f', 16), parseInt('zz', 36), parseInt('12', 37));
+console.log(parseInt('1010', 2), parseInt(5.7), parseInt('123456789012345678901234567890'), parseInt('-0'));
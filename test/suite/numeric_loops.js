@@ -56,3 +56,40 @@ wlabel: do {
         continue wlabel;
 } while (++wcount < 100);
 console.log(wsum);
+
+// property access inside a loop, where the checks on the
+// object are done once, and must be redone if a property
+// is deleted or redefined, or if an array loses fast-path
+function loop_guards () {
+    const obj = { a: 1, b: 2 };
+    const arr = [ 1, 2, 3, 4 ];
+    const getter1 = { get: () => 100 };
+    const getter2 = { get: () => 1000 };
+    let sum = 0;
+    for (let i = 0; i < 8; i++) {
+        sum += (obj.a || 0) + obj.b + arr[i & 3];
+        obj.b = i;
+        arr[i & 2] = i * 2;
+        if (i === 2)
+            delete obj.a;
+        if (i === 4)
+            Object.defineProperty(obj, 'a', getter1);
+        if (i === 5)
+            Object.defineProperty(arr, 1, getter2);
+        if (i === 7)
+            Object.freeze(obj);
+    }
+    console.log(sum, obj.a, obj.b, arr[0], arr[1], arr[2]);
+
+    const arr2 = [ 1, 2 ];
+    const getter3 = { get: () => 'getter' };
+    const out = [];
+    let k = 0;
+    while (k < 4) {
+        out.push(arr2[k & 1]);
+        if (k++ === 1)
+            Object.defineProperty(arr2, 0, getter3);
+    }
+    console.log(out);
+}
+loop_guards();
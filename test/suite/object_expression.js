@@ -35,3 +35,106 @@ console.log(o2.was_getter);
 // test that spread syntax also copies array elements
 const o3 = { ... [ 123, 456, 789 ] };
 console.log(o3);
+
+// test integer keys on objects which are not arrays,
+// these are kept in an element store, not in the shape
+const o4 = { a: 1, '2': 'two', 0: 'zero', b: 2 };
+o4[1] = 'one';
+o4['10'] = 'ten';
+o4[-0] = 'ZERO';
+o4[1.5] = 'not an index';
+console.log(o4, o4[0], o4['1'], o4[2], o4[3], o4[10]);
+console.log(1 in o4, '3' in o4, o4.hasOwnProperty(2));
+console.log(Object.getOwnPropertyNames(o4).join());
+
+// delete, descriptors, and sparse indexes
+delete o4[1];
+delete o4['2'];
+o4[4000000000] = 'big';
+o4[100] = 'hundred';
+Object.defineProperty(o4, 7, { value: 'seven', enumerable: false });
+console.log(o4, o4[1], o4[7], Object.getOwnPropertyDescriptor(o4, '7'));
+console.log(Object.getOwnPropertyNames(o4).join());
+
+// integer keys found on the prototype chain
+const o5 = { __proto__: o4, 50: 'own' };
+console.log(o5[0], o5[50], o5[100], 100 in o5, o5.hasOwnProperty(100));
+const o6 = Object.create([ 'from', 'array' ]);
+console.log(o6[1], 1 in o6);
+
+// spread and rest copy integer keys first, in order
+const o7 = { ...o4, 3: 'three' };
+console.log(o7);
+const { ['0']: o7_zero, ['100']: o7_hundred, ...o7_rest } = o7;
+console.log(o7_zero, o7_hundred, o7_rest);
+
+// integer keys on functions, and frozen objects
+function f1 () {}
+f1[0] = 'on function';
+console.log(f1[0], Object.getOwnPropertyNames(f1)[0]);
+const o8 = Object.freeze({ 0: 'frozen', x: 1 });
+try { o8[0] = 'changed'; } catch (e) { console.log(e.name); }
+try { o8[1] = 'added'; } catch (e) { console.log(e.name); }
+console.log(o8, Object.isFrozen(o8));
+
+// for-in over own and inherited keys, with shadowing,
+// non-enumerable properties, and integer keys
+function forin_keys (obj) {
+    const keys = [];
+    for (const key in obj)
+        keys.push(key);
+    return keys.join();
+}
+const o9 = { x: 1, y: 2, z: 3 };
+console.log(forin_keys(o9), forin_keys(o4), forin_keys(o5));
+const o10 = Object.create(o9, { y: { value: 'hidden', enumerable: false } });
+o10.w = 4;
+o10[3] = 'three';
+console.log(forin_keys(o10), forin_keys([ 'a', , 'c' ]), forin_keys('str'));
+console.log(forin_keys(null), forin_keys(undefined), forin_keys(42));
+const a1 = [ 1, 2, 3 ];
+a1.extra = 'yes';
+console.log(forin_keys(a1), forin_keys(Object.create(a1)));
+
+// deleting and adding keys during the loop
+const o11 = { a: 1, b: 2, c: 3, d: 4 };
+const seen = [];
+for (const key in o11) {
+    seen.push(key);
+    if (key === 'a') {
+        delete o11.c;
+        o11.e = 5;
+    }
+}
+console.log(seen.join(), forin_keys(o11));
+const a2 = [ 0, 1, 2, 3, 4 ];
+const seen2 = [];
+for (const key in a2) {
+    seen2.push(key);
+    if (key === '1')
+        a2.length = 3;
+}
+console.log(seen2.join());
+
+// Object.keys, values and entries, with getters that
+// delete properties, and on primitives
+const o12 = { a: 1, get b () { delete this.c; return 2; }, c: 3 };
+Object.defineProperty(o12, 'd', { value: 4, enumerable: false });
+console.log(Object.keys(o12).join(), Object.values(o12).join());
+o12.c = 3;
+console.log(Object.entries(o12).join('|'), Object.keys(o4).join());
+console.log(Object.keys('ab').join(), Object.values('ab').join(),
+            Object.entries([ 'x', , 'z' ]).join('|'), Object.keys(5).length);
+try { Object.keys(null); } catch (e) { console.log(e.name); }
+
+// integer keys up to 2^32 - 2 come first, in ascending order,
+// also those which are too large for the element store
+const o13 = { b: 1, '4294967294': 'max', 4294967295: 'not an index' };
+o13[4294967290] = 'large';
+o13['4294967289'] = 'elem';
+o13[3] = 'three';
+console.log(Object.keys(o13).join(), forin_keys(o13));
+console.log(Object.getOwnPropertyNames(o13).join());
+console.log(Object.entries(o13).join('|'));
+delete o13[4294967290];
+console.log(Object.keys(o13).join(), { ...o13 });
@@ -22,3 +22,10 @@ test (function () { 'use strict'; (123).plain = 4567; })
 test (function () { 'use strict'; (123).writable = 4567; })
 
 console.log('end of test');
+
+// 'arguments.callee' is the function in sloppy mode,
+// but throws an error in strict mode
+;(function callee_sloppy () {
+    console.log(arguments.callee === callee_sloppy, arguments.length); })(1, 2)
+;(function () { arguments = 'replaced'; console.log(arguments); })(1)
+test (function () { 'use strict'; return arguments.callee; })
@@ -155,3 +155,190 @@ for (let i = 0; i < arr.length; i++)
 console.log('---');
 
 })()
+
+//
+// test #4
+//
+
+;(function () {
+
+// repeated concatenation, which builds ropes
+let s = '';
+for (let i = 0; i < 20000; i++)
+    s += 'line ' + i + '\n';
+console.log(s.length, s.charCodeAt(s.length - 2), s.slice(-12));
+
+let p = '';
+for (let i = 0; i < 1000; i++)
+    p = i + ',' + p;
+console.log(p.length, p.substring(0, 24));
+
+const a = 'abcdefghijklmnopqrstuvwxyz' + 'ABCDEFGHIJKLMNOPQRSTUVWXYZ0123';
+const b = 'abcdefghijklmnopqrstuvwxyz' + 'ABCDEFGHIJKLMNOPQRSTUVWXYZ0123';
+console.log(a === b, a < b + '!', a[40], a.length);
+
+const obj = {};
+obj[a] = 'rope key';
+console.log(obj[b]);
+const map = new Map();
+map.set(a, 'map key');
+console.log(map.get(b));
+console.log(Number('00000000000000000000' + '0000000000000000' + '42'));
+console.log((' ' + a + ' ').trim() === b);
+
+})()
+
+//
+// test #5
+//
+
+;(function () {
+
+// string keys which differ only in the high byte of
+// each character, and keys from a literal, which are
+// hashed by the compiler, looked up via computed keys
+const obj = {};
+const map = new Map();
+const base = [ 0x4E00, 0x4F00, 0x5000, 0x5100 ];
+for (let i = 0; i < 4; i++) {
+    for (let j = 0; j < 4; j++) {
+        const key = String.fromCharCode(base[i] + 1, base[j] + 2);
+        obj[key] = i * 4 + j;
+        map.set(key + key, i * 4 + j);
+    }
+}
+let sum = 0;
+for (let i = 0; i < 4; i++) {
+    for (let j = 0; j < 4; j++) {
+        const key = String.fromCharCode(base[i] + 1, base[j] + 2);
+        sum += obj[key] * 100 + map.get(key + key);
+    }
+}
+console.log(sum, map.size);
+
+obj.literal_property_name = 1;
+const name = 'literal_' + 'property_' + 'name';
+console.log(obj[name], map.get('丁丂丁丂'));
+
+})()
+
+//
+// test #6
+//
+
+;(function () {
+
+const s = 'the quick brown fox jumps over the lazy dog, the end';
+console.log(s.indexOf('the'), s.indexOf('the', 1), s.indexOf('the', 100), s.indexOf(''), s.indexOf('', 100), s.indexOf('zzz'));
+console.log(s.lastIndexOf('the'), s.lastIndexOf('the', 40), s.lastIndexOf('the', 0), s.lastIndexOf('the', -5), s.lastIndexOf(''), s.lastIndexOf('t', NaN), s.lastIndexOf('t', 0.5));
+console.log(s.includes('lazy'), s.includes('lazy', 40), s.startsWith('the'), s.startsWith('quick', 4), s.startsWith('quick', 5));
+console.log(s.endsWith('end'), s.endsWith('dog', 43), s.endsWith('the', 3), s.endsWith(''), s.endsWith('x', undefined));
+console.log('a,b,,c'.split(','), 'a,b,,c'.split(',', 2), 'abc'.split(''), 'abc'.split('', 2), ''.split(','), ''.split(''), 'abc'.split(), 'a--b--c'.split('--'), 'abc'.split(undefined, 0));
+console.log('x'.split('x'), 'xx'.split('x').length, 'a1b1c'.split(1));
+console.log(s.replace('the', 'THE'), s.replaceAll('the', '[$&]'), 'abc'.replace('b', "$`$'$$"), 'aaa'.replaceAll('', '-'), 'abc'.replace('b', (m, p) => m + p));
+let long = '';
+for (let i = 0; i < 100; i++) long += 'abcdefghij';
+long += 'needle';
+console.log(long.indexOf('needle'), long.indexOf('jab'), long.indexOf('fghij', 995), long.lastIndexOf('abc'), long.includes('xyz'));
+
+// a regexp-like argument, with a truthy Symbol.match, is rejected by
+// includes, startsWith and endsWith, but indexOf converts it to a string
+const re_like = { [Symbol.match]: true, toString () { return 'a/'; } };
+for (const name of [ 'includes', 'startsWith', 'endsWith' ]) {
+    try { console.log(name, 'a/a/'[name](re_like)); }
+    catch (e) { console.log(name, e instanceof TypeError); }
+}
+re_like[Symbol.match] = false;
+console.log('a/a/'.startsWith(re_like), 'a/a/'.endsWith(re_like), 'a/a/'.indexOf(re_like));
+
+const u = '中文中文中文中文中文中文中文中文测试';
+console.log(u.indexOf('测试'), u.indexOf('文中文中文中文中文中文中文中文测'), 'aĀ' < 'aȀ', 'abcdefghijk' < 'abcdefghijl', 'abcdefghijkl' > 'abcdefghijk');
+
+})()
+
+//
+// test #7
+//
+
+;(function () {
+
+// substrings which share the buffer of the source string
+let src = '';
+for (let i = 0; i < 2000; i++) src += 'token_number_' + i + ' ';
+let count = 0, total = 0, keys = {};
+let pos = 0;
+while (pos < src.length) {
+    let end = src.indexOf(' ', pos);
+    const tok = src.slice(pos, end);
+    const tail = tok.substring(6);
+    total += tok.length + tail.length;
+    if (tok === 'token_number_1999') count++;
+    if (tail.startsWith('number_19')) count++;
+    keys[tok] = 1;
+    pos = end + 1;
+}
+const big = src.slice(100, 5000);
+const sub = big.slice(10, 500).slice(5, 100);
+console.log(count, total, sub.length, sub, sub === src.substring(115, 210), sub < src, (sub + '!').length);
+console.log(src.slice(0, 1), src.charAt(3), src[5], 'héllo'.slice(1, 2), '中文'.charAt(1), '   ' + sub.trim().slice(0, 20) + '   ', ('  ' + big + '  ').trim().length);
+console.log(big.split(' ').length, sub.split('_').length, big.substr(-20), sub.at(-1));
+const m = new Map(); m.set(src.slice(0, 30), 5); console.log(m.get('token_number_0 token_number_1 '), Number(src.slice(0, 40).replaceAll('token_number_', '').replaceAll(' ', '')));
+
+})()
+
+// console output of non-ascii text
+console.log('héllo', '☃', '😀', '日本', '\ud800!');
+
+// join, repeat, padStart, padEnd
+;(function() {
+
+const parts = [];
+for (let i = 0; i < 200; i++) parts.push('p' + i);
+const joined = parts.join('-');
+console.log(joined.length, joined.slice(0, 20), joined.slice(-10), [].join(), [ 'a' ].join('xyz'));
+console.log([ 1, null, 'b', undefined, 2.5, , true ].join(), [ 'a', , 'b' ].join(''), [ [ 1, 2 ], [ 3 ] ].join(';'));
+console.log(Array.prototype.join.call({ length: 3, 0: 'x', 2: 'z' }, '+'), Array.prototype.join.call('abc', '.'), [ 'a', 'b' ].join(undefined), [ 'a', 'b' ].join(0));
+const obj = { toString () { arr.length = 1; return 'T'; } };
+const arr = [ 'a', obj, 'c', 'd' ];
+console.log(arr.join('|'), arr.length);
+console.log('ab'.repeat(3), 'x'.repeat(0), ''.repeat(100), 'abc'.repeat(1), 'z'.repeat(2.9), 'q'.repeat('4'), 'é'.repeat(1000).length);
+try { 'a'.repeat(-1); } catch (e) { console.log(e instanceof RangeError); }
+try { 'a'.repeat(Infinity); } catch (e) { console.log(e instanceof RangeError); }
+try { 'a'.repeat(1e10); } catch (e) { console.log(e instanceof RangeError); }
+console.log('5'.padStart(3, '0'), 'abc'.padStart(10, '123'), 'abc'.padEnd(10, '12'), 'abc'.padStart(2), 'abc'.padEnd(6) + '|', 'abc'.padStart(8, ''), 'x'.padStart(4.7, 'ab'), 'x'.padEnd(NaN, 'y'));
+console.log('a,b,,c'.replaceAll(',', '; '), 'aaa'.replaceAll('a', '$&$&'), 'xyz'.replaceAll('', '_'));
+
+})()
+
+// for-of over strings, with lone surrogates, long strings,
+// slices and ropes, and with a replaced string iterator
+;(function() {
+
+const chars = [];
+for (const ch of 'a🐎b\ud800c\udc00')
+    chars.push(ch.length + ':' + ch.codePointAt(0).toString(16));
+console.log(chars.join());
+let long = '';
+for (let i = 0; i < 100; i++) long += 'xyé';
+let count = 0;
+for (const ch of long) if (ch === 'é') count++;
+for (const ch of long.slice(50, 200)) if (ch === 'x') count++;
+console.log(count, [ ...'' ].length, [ ...'🐎' ].length);
+const saved_next = ''[Symbol.iterator]().__proto__.next;
+''[Symbol.iterator]().__proto__.next = function () {
+    const r = saved_next.call(this);
+    if (!r.done) r.value = r.value + r.value;
+    return r;
+};
+const upper = [];
+for (const ch of 'abc') upper.push(ch);
+''[Symbol.iterator]().__proto__.next = saved_next;
+for (const ch of 'de') upper.push(ch);
+const saved_iter = String.prototype[Symbol.iterator];
+String.prototype[Symbol.iterator] = function* () { yield 'own'; };
+for (const ch of 'fg') upper.push(ch);
+String.prototype[Symbol.iterator] = saved_iter;
+for (const ch of 'h') upper.push(ch);
+console.log(upper.join());
+
+})()
@@ -89,3 +89,20 @@ console.log(gen_func().next());
     function f() { return 'OUTER_SCOPE'; }
     if (true) { function f() { return 'INNER_SCOPE'; }
         console.log(f()); } console.log(f()); })();
+
+// the 'arguments' and 'caller' properties of a non-strict
+// function are set while the function executes, and reset
+// on return, and when an exception unwinds the function
+function legacy_inner () {
+    console.log('inner', legacy_inner.arguments.length,
+                legacy_inner.arguments[0],
+                legacy_inner.caller === legacy_outer);
+    if (legacy_inner.arguments[0] === 'throw')
+        throw 'thrown';
+}
+function legacy_outer (x) { legacy_inner(x); }
+legacy_outer('first');
+console.log(legacy_inner.arguments, legacy_inner.caller);
+try { legacy_outer('throw'); } catch (e) { console.log(e); }
+console.log(legacy_inner.arguments, legacy_inner.caller,
+            legacy_outer.arguments, legacy_outer.caller);